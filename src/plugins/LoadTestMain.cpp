@@ -0,0 +1,332 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VshlApi.h"
+#include "bench/fakes/FakeBinder.h"
+#include "voiceagents/VoiceAgentEventNames.h"
+
+using namespace vshl::bench::fakes;
+
+/**
+ * End to end load test of the plugin. The verbs of VshlApi.cpp are driven by
+ * concurrent clients through an in-process FakeBinder, whose voiceagent and
+ * application framework apis answer after a configurable latency. Reports the
+ * throughput and the latency distribution of every operation.
+ */
+
+static const char* USAGE =
+    "Usage: vshl-loadtest [options]\n"
+    "  --clients=N           Concurrent clients (default 8)\n"
+    "  --iterations=N        Operations per client (default 1000)\n"
+    "  --agent-latency-ms=N  Latency of the voiceagent api (default 20)\n"
+    "  --app-latency-ms=N    Latency of the application framework apis (default 5)\n"
+    "  --workers=N           Threads completing the calls to other apis (default 4)\n"
+    "  --serialized          Run the verbs one at a time, like an api with noconcurrency\n"
+    "  --verbose             Print the plugin logs\n";
+
+static const char* VOICEAGENT_ID = "VA-001";
+static const char* VOICEAGENT_API = "alexa-voiceagent";
+
+static const char* VOICEAGENTS_CONFIG =
+    "{\"default\": \"VA-001\", \"agents\": [{"
+    "\"id\": \"VA-001\", \"active\": true, \"name\": \"Alexa\", \"api\": \"alexa-voiceagent\","
+    "\"wakewords\": [\"alexa\", \"computer\", \"echo\"], \"activewakeword\": \"alexa\","
+    "\"description\": \"Alexa voice assistant by Amazon.\", \"vendor\": \"Amazon.com Services Inc\"}]}";
+
+static const std::chrono::milliseconds REPLY_TIMEOUT(30000);
+
+struct Options {
+    int clients = 8;
+    int iterations = 1000;
+    int agentLatencyMs = 20;
+    int appLatencyMs = 5;
+    int workers = 4;
+    bool concurrent = true;
+    bool verbose = false;
+};
+
+// Operations a client runs, in turn.
+enum Operation {
+    START_LISTENING,
+    START_LISTENING_ASYNC,
+    ENUMERATE_VOICE_AGENTS,
+    GUI_METADATA_PUBLISH,
+    DIALOG_STATE_EVENT,
+    OPERATION_COUNT
+};
+
+static const char* OPERATION_NAMES[OPERATION_COUNT] = {
+    "startListening",
+    "startListening async",
+    "enumerateVoiceAgents",
+    "guiMetadata/publish",
+    "dialog state event",
+};
+
+// Latencies in microseconds and failures of the operations of a client.
+struct ClientResults {
+    std::vector<int64_t> latencies[OPERATION_COUNT];
+    uint64_t failures[OPERATION_COUNT] = {0};
+};
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        std::string arg = argv[argIdx];
+        size_t separator = arg.find('=');
+        std::string name = arg.substr(0, separator);
+        int value = separator != std::string::npos ? atoi(arg.c_str() + separator + 1) : 0;
+
+        if (name == "--clients" && value > 0) {
+            options.clients = value;
+        } else if (name == "--iterations" && value > 0) {
+            options.iterations = value;
+        } else if (name == "--agent-latency-ms" && value >= 0) {
+            options.agentLatencyMs = value;
+        } else if (name == "--app-latency-ms" && value >= 0) {
+            options.appLatencyMs = value;
+        } else if (name == "--workers" && value > 0) {
+            options.workers = value;
+        } else if (arg == "--serialized") {
+            options.concurrent = false;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Scripts the apis the plugin calls. They all succeed with an empty reply.
+static void setTargets(FakeBinder& binder, const Options& options) {
+    auto succeed = [](json_object* args, json_object** result, std::string& error) {
+        *result = json_object_new_object();
+        return 0;
+    };
+
+    binder.setTarget(VOICEAGENT_API, "startListening", succeed);
+    binder.setTarget(VOICEAGENT_API, "cancel", succeed);
+    binder.setTarget(VOICEAGENT_API, "subscribe", succeed);
+    binder.setTarget(VOICEAGENT_API, "startSubscriptionProcess", succeed);
+    binder.setTargetLatency(VOICEAGENT_API, std::chrono::milliseconds(options.agentLatencyMs));
+
+    binder.setTarget("afm-main", "once", succeed);
+    binder.setTargetLatency("afm-main", std::chrono::milliseconds(options.appLatencyMs));
+    binder.setTarget("homescreen", "tap_shortcut", succeed);
+    binder.setTargetLatency("homescreen", std::chrono::milliseconds(options.appLatencyMs));
+}
+
+// Calls a verb, the reference on @c queryJ is released.
+static bool callVerb(
+    FakeBinder& binder,
+    FakeBinder::Verb verb,
+    json_object* argsJ,
+    json_object* queryJ,
+    int clientId) {
+    FakeBinder::Reply reply;
+    bool replied = binder.callVerb(verb, argsJ, queryJ, clientId, reply, REPLY_TIMEOUT);
+    json_object_put(queryJ);
+    return replied && reply.isSuccess();
+}
+
+static bool subscribeClient(FakeBinder& binder, int clientId) {
+    json_object* eventsJ = json_object_new_array();
+    json_object_array_add(eventsJ, json_object_new_string(vshl::voiceagents::VSHL_EVENT_DIALOG_STATE_EVENT.c_str()));
+    json_object_array_add(eventsJ, json_object_new_string(vshl::voiceagents::VSHL_EVENT_START_LISTENING_EVENT.c_str()));
+    json_object* subscribeJ = json_object_new_object();
+    json_object_object_add(subscribeJ, "va_id", json_object_new_string(VOICEAGENT_ID));
+    json_object_object_add(subscribeJ, "events", eventsJ);
+    if (!callVerb(binder, subscribe, nullptr, subscribeJ, clientId)) {
+        return false;
+    }
+
+    json_object* actionsJ = json_tokener_parse("{\"actions\": [\"render_template\"]}");
+    return callVerb(binder, guiMetadataSubscribe, nullptr, actionsJ, clientId);
+}
+
+static bool runOperation(FakeBinder& binder, Operation operation, int clientId, int iteration) {
+    switch (operation) {
+        case START_LISTENING:
+            return callVerb(binder, startListening, nullptr, json_object_new_object(), clientId);
+        case START_LISTENING_ASYNC:
+            return callVerb(binder, startListening, nullptr, json_tokener_parse("{\"async\": true}"), clientId);
+        case ENUMERATE_VOICE_AGENTS:
+            return callVerb(binder, enumerateVoiceAgents, nullptr, json_object_new_object(), clientId);
+        case GUI_METADATA_PUBLISH:
+            return callVerb(
+                binder,
+                guiMetadataPublish,
+                nullptr,
+                json_tokener_parse("{\"action\": \"render_template\", \"payload\": {\"title\": \"Weather\"}}"),
+                clientId);
+        case DIALOG_STATE_EVENT: {
+            json_object* eventJ = json_object_new_object();
+            json_object_object_add(eventJ, "va_id", json_object_new_string(VOICEAGENT_ID));
+            json_object_object_add(eventJ, "state", json_object_new_string(iteration % 2 ? "THINKING" : "SPEAKING"));
+            int rc = binder.callAction(onDialogStateEvent, nullptr, eventJ);
+            json_object_put(eventJ);
+            return rc == 0;
+        }
+        default:
+            return false;
+    }
+}
+
+static void runClient(FakeBinder& binder, const Options& options, int clientId, ClientResults& results) {
+    for (int operationIdx = 0; operationIdx < OPERATION_COUNT; ++operationIdx) {
+        results.latencies[operationIdx].reserve(options.iterations / OPERATION_COUNT + 1);
+    }
+
+    for (int iteration = 0; iteration < options.iterations; ++iteration) {
+        // Clients start at different operations so that all of them run at once.
+        auto operation = static_cast<Operation>((iteration + clientId) % OPERATION_COUNT);
+        auto start = std::chrono::steady_clock::now();
+        bool succeeded = runOperation(binder, operation, clientId, iteration);
+        auto latency = std::chrono::steady_clock::now() - start;
+
+        results.latencies[operation].push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        if (!succeeded) {
+            ++results.failures[operation];
+        }
+    }
+}
+
+static int64_t getPercentile(const std::vector<int64_t>& sortedLatencies, double percentile) {
+    if (sortedLatencies.empty()) {
+        return 0;
+    }
+
+    size_t rank = static_cast<size_t>(percentile / 100.0 * (sortedLatencies.size() - 1) + 0.5);
+    return sortedLatencies[rank];
+}
+
+static void printResults(
+    FakeBinder& binder,
+    const Options& options,
+    const std::vector<ClientResults>& clientResults,
+    std::chrono::steady_clock::duration elapsed) {
+    double elapsedSeconds = std::chrono::duration<double>(elapsed).count();
+    uint64_t totalOperations = 0;
+
+    printf(
+        "%-22s %8s %8s %10s %10s %10s %10s\n", "operation", "count", "failed", "p50 us", "p90 us", "p99 us", "max us");
+    for (int operationIdx = 0; operationIdx < OPERATION_COUNT; ++operationIdx) {
+        std::vector<int64_t> latencies;
+        uint64_t failures = 0;
+        for (auto& results : clientResults) {
+            auto& operationLatencies = results.latencies[operationIdx];
+            latencies.insert(latencies.end(), operationLatencies.begin(), operationLatencies.end());
+            failures += results.failures[operationIdx];
+        }
+        std::sort(latencies.begin(), latencies.end());
+        totalOperations += latencies.size();
+
+        printf(
+            "%-22s %8zu %8llu %10lld %10lld %10lld %10lld\n",
+            OPERATION_NAMES[operationIdx],
+            latencies.size(),
+            static_cast<unsigned long long>(failures),
+            static_cast<long long>(getPercentile(latencies, 50)),
+            static_cast<long long>(getPercentile(latencies, 90)),
+            static_cast<long long>(getPercentile(latencies, 99)),
+            static_cast<long long>(latencies.empty() ? 0 : latencies.back()));
+    }
+
+    printf(
+        "\n%llu operations by %d clients in %.3f s: %.0f operations/s (%s verbs)\n",
+        static_cast<unsigned long long>(totalOperations),
+        options.clients,
+        elapsedSeconds,
+        totalOperations / elapsedSeconds,
+        options.concurrent ? "concurrent" : "serialized");
+
+    std::string dialogStateEvent =
+        std::string("vshl/") + vshl::voiceagents::VSHL_EVENT_DIALOG_STATE_EVENT + "#" + VOICEAGENT_ID;
+    printf(
+        "%s: %llu pushes, %llu deliveries\n",
+        dialogStateEvent.c_str(),
+        static_cast<unsigned long long>(binder.getPushCount(dialogStateEvent)),
+        static_cast<unsigned long long>(binder.getDeliveryCount(dialogStateEvent)));
+    printf(
+        "vshl/render_template: %llu pushes, %llu deliveries\n",
+        static_cast<unsigned long long>(binder.getPushCount("vshl/render_template")),
+        static_cast<unsigned long long>(binder.getDeliveryCount("vshl/render_template")));
+    printf(
+        "%s/startListening: %llu calls, afm-main/once: %llu calls\n",
+        VOICEAGENT_API,
+        static_cast<unsigned long long>(binder.getCallCount(VOICEAGENT_API, "startListening")),
+        static_cast<unsigned long long>(binder.getCallCount("afm-main", "once")));
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fputs(USAGE, stderr);
+        return 1;
+    }
+
+    // The plugin keeps its api until the process exits, so the binder is never destroyed.
+    FakeBinder& binder = *FakeBinder::create("vshl", options.workers).release();
+    binder.setLogging(options.verbose);
+    binder.setSerialized(!options.concurrent);
+    setTargets(binder, options);
+
+    CtlPluginT plugin;
+    memset(&plugin, 0, sizeof(plugin));
+    plugin.api = binder.getApi();
+    if (CtlPluginOnload(&plugin, nullptr) != 0) {
+        fputs("Failed to load the plugin\n", stderr);
+        return 1;
+    }
+
+    json_object* configJ = json_tokener_parse(VOICEAGENTS_CONFIG);
+    int rc = binder.callAction(loadVoiceAgentsConfig, configJ, nullptr);
+    json_object_put(configJ);
+    if (rc != 0) {
+        fputs("Failed to load the voiceagents configuration\n", stderr);
+        return 1;
+    }
+
+    for (int clientId = 0; clientId < options.clients; ++clientId) {
+        if (!subscribeClient(binder, clientId)) {
+            fprintf(stderr, "Failed to subscribe client %d\n", clientId);
+            return 1;
+        }
+    }
+
+    std::vector<ClientResults> clientResults(options.clients);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int clientId = 0; clientId < options.clients; ++clientId) {
+        clients.emplace_back(
+            runClient, std::ref(binder), std::cref(options), clientId, std::ref(clientResults[clientId]));
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    printResults(binder, options, clientResults, elapsed);
+    return 0;
+}
@@ -15,6 +15,9 @@
 #include "VshlApi.h"
 
 #include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "afb/AFBApiImpl.h"
 #include "afb/AFBRequestImpl.h"
@@ -23,13 +26,17 @@
 #include "capabilities/CapabilityMessagingService.h"
 #include "core/VRRequestProcessor.h"
 #include "utilities/events/EventRouter.h"
+#include "utilities/files/FileWatcher.h"
+#include "utilities/json/JsonHandle.h"
+#include "utilities/json/JsonHelpers.h"
 #include "utilities/logging/Logger.h"
+#include "utilities/stats/VerbStatsRegistry.h"
 #include "voiceagents/VoiceAgentEventNames.h"
 #include "voiceagents/VoiceAgentsDataManager.h"
-
-#include "json.hpp"
+#include "voiceagents/include/VoiceAgentsConfig.h"
 
 using namespace std;
+using namespace vshl::utilities::json;
 
 CTLP_CAPI_REGISTER("vshl-api");
 
@@ -45,8 +52,15 @@ static std::string VA_JSON_ATTR_WWS = "wakewords";
 static std::string VA_JSON_ATTR_ACTIVE_WW = "activewakeword";
 static std::string VA_JSON_ATTR_DESCRIPTION = "description";
 static std::string VA_JSON_ATTR_VENDOR = "vendor";
+static std::string VA_JSON_ATTR_WATCH = "watch";
 
 static std::string STARTLISTENING_JSON_ATTR_REQUEST = "request_id";
+static std::string STARTLISTENING_JSON_ATTR_ASYNC = "async";
+static std::string STARTLISTENING_JSON_ATTR_WAKEWORD = "wakeword";
+static std::string STARTLISTENING_JSON_ATTR_STATE = "state";
+static std::string STARTLISTENING_JSON_ATTR_ERROR = "error";
+static std::string STARTLISTENING_STATE_STARTED = "STARTED";
+static std::string STARTLISTENING_STATE_FAILED = "FAILED";
 
 static std::string EVENTS_JSON_ATTR_VA_ID = "va_id";
 static std::string EVENTS_JSON_ATTR_EVENTS = "events";
@@ -55,8 +69,27 @@ static std::string CAPABILITIES_JSON_ATTR_ACTION = "action";
 static std::string CAPABILITIES_JSON_ATTR_ACTIONS = "actions";
 static std::string CAPABILITIES_JSON_ATTR_PAYLOAD = "payload";
 
+static std::string CAPABILITIES_JSON_ATTR_CAPABILITY = "capability";
+
+static std::string BATCH_JSON_ATTR_OPERATIONS = "operations";
+static std::string BATCH_JSON_ATTR_OP = "op";
+static std::string BATCH_JSON_ATTR_RESULTS = "results";
+static std::string BATCH_JSON_ATTR_STATUS = "status";
+static std::string BATCH_JSON_ATTR_ERROR = "error";
+static std::string BATCH_JSON_ATTR_SUBSCRIBED = "subscribed";
+static std::string BATCH_OP_PUBLISH = "publish";
+static std::string BATCH_OP_SUBSCRIBE = "subscribe";
+static std::string BATCH_STATUS_SUCCESS = "success";
+static std::string BATCH_STATUS_FAILED = "failed";
+
+// Privileges of the capabilities whose name doesn't map to the default
+// "urn:AGL:permission:vshl:<capability>:public" privilege.
+static std::unordered_map<std::string, std::string> CAPABILITY_PRIVILEGES = {
+    {"guimetadata", "urn:AGL:permission:vshl:guiMetadata:public"},
+};
+
 static std::shared_ptr<vshl::utilities::logging::Logger> sLogger;
-static std::shared_ptr<vshl::common::interfaces::IAFBApi> sAfbApi;
+static std::shared_ptr<vshl::afb::AFBApiImpl> sAfbApi;
 static std::shared_ptr<vshl::appmanagement::AppController> sAppController;
 static std::unique_ptr<vshl::capabilities::CapabilitiesFactory> sCapabilitiesFactory;
 static std::unique_ptr<vshl::capabilities::CapabilityMessagingService> sCapabilityMessagingService;
@@ -64,8 +97,75 @@ static std::unique_ptr<vshl::core::VRRequestProcessor> sVRRequestProcessor;
 static std::unique_ptr<vshl::voiceagents::VoiceAgentsDataManager> sVoiceAgentsDataManager;
 static std::unique_ptr<vshl::utilities::events::EventRouter> sEventRouter;
 
-using json = nlohmann::json;
+// Voiceagents configuration file given to loadVoiceAgentsConfig, if any, and its watcher.
+static std::string sVoiceAgentsConfigPath;
+static std::unique_ptr<vshl::utilities::files::FileWatcher> sVoiceAgentsConfigWatcher;
+
+// Per verb call statistics. Created statically so that it is available before onload.
+static std::unique_ptr<vshl::utilities::stats::VerbStatsRegistry> sVerbStatsRegistry =
+    vshl::utilities::stats::VerbStatsRegistry::create();
+
+// Cached enumerateVoiceAgents response and the voiceagents data generation it was built from.
+// Verbs run concurrently, so both are guarded by sEnumerateVoiceAgentsMutex.
+static std::mutex sEnumerateVoiceAgentsMutex;
+static json_object* sEnumerateVoiceAgentsResponse = nullptr;
+static uint64_t sEnumerateVoiceAgentsGeneration = 0;
+
+// Privileges required to use a capability, indexed by capability id.
+static std::vector<std::string> sCapabilityPrivileges;
+
+// Capability ids by name, for the verbs that get the capability from the request.
+static std::unordered_map<std::string, int> sCapabilityIds;
+
+// Ids of the capabilities that have dedicated verbs, resolved once at onload
+// so that those verbs never look their capability up.
+static int sGuiMetadataCapabilityId = -1;
+static int sPhoneControlCapabilityId = -1;
+static int sNavigationCapabilityId = -1;
+
 using Level = vshl::utilities::logging::Logger::Level;
+using VerbTimer = vshl::utilities::stats::VerbTimer;
+
+static std::string STATS_JSON_ATTR_EXPIRED_CALLS = "expired_calls";
+static std::string STATS_JSON_ATTR_SKIPPED_EVENT_PUSHES = "skipped_event_pushes";
+static std::string STATS_JSON_ATTR_CALLS = "calls";
+
+static std::string DEADLINES_JSON_ATTR_DEFAULT_MS = "default_ms";
+static std::string DEADLINES_JSON_ATTR_APIS = "apis";
+static std::string DEADLINES_JSON_ATTR_SLOW_CALL_MS = "slow_call_ms";
+
+static std::string BREAKERS_JSON_ATTR_FAILURE_THRESHOLD = "failure_threshold";
+static std::string BREAKERS_JSON_ATTR_OPEN_MS = "open_ms";
+static std::string BREAKERS_JSON_ATTR_PROBES = "probes";
+
+static std::string HEALTH_JSON_ATTR_APIS = "apis";
+static std::string HEALTH_JSON_ATTR_VOICEAGENTS = "voiceagents";
+static std::string HEALTH_JSON_ATTR_SUBSCRIPTION = "subscription";
+
+static std::string COALESCING_JSON_ATTR_EVENTS = "events";
+static std::string COALESCING_JSON_ATTR_NAME = "name";
+static std::string COALESCING_JSON_ATTR_WINDOW_MS = "window_ms";
+static std::string COALESCING_JSON_ATTR_CRITICAL = "critical";
+
+/**
+ * Defines a CTLP_CAPI verb whose calls are recorded in the verb statistics.
+ * The body following the macro is the implementation of the verb, a non zero
+ * return value counts as a failed call. A body that replies a failure itself
+ * marks the call failed through @c timer, one that replies from a completion
+ * moves @c timer there so that the call is recorded when it is replied.
+ */
+#define VSHL_CAPI(verb)                                                                                   \
+    static int verb##Impl(CtlSourceT* source, json_object* argsJ, json_object* eventJ, VerbTimer& timer); \
+    CTLP_CAPI(verb, source, argsJ, eventJ) {                                                              \
+        static auto verbStats = sVerbStatsRegistry->getVerbStats(#verb);                                  \
+        VerbTimer timer(verbStats);                                                                       \
+        int rc = verb##Impl(source, argsJ, eventJ, timer);                                                \
+        if (rc != 0) {                                                                                    \
+            timer.setFailed(true);                                                                        \
+        }                                                                                                 \
+        return rc;                                                                                        \
+    }                                                                                                     \
+    static int verb##Impl(CtlSourceT* source, json_object* argsJ, json_object* eventJ, VerbTimer& timer)
 
 CTLP_ONLOAD(plugin, ret) {
     if (plugin->api == nullptr) {
@@ -122,206 +222,471 @@ CTLP_ONLOAD(plugin, ret) {
         return -1;
     }
 
+    // Register all capabilities once, so that verbs can resolve them by id.
+    sCapabilityPrivileges.clear();
+    sCapabilityIds.clear();
+    for (auto capability : sCapabilitiesFactory->getAllCapabilities()) {
+        int capabilityId = sCapabilityMessagingService->registerCapability(capability);
+        if (capabilityId == -1) {
+            sLogger->log(Level::ERROR, TAG, "Failed to register capability " + capability->getName());
+            return -1;
+        }
+
+        auto privilegeIt = CAPABILITY_PRIVILEGES.find(capability->getName());
+        sCapabilityPrivileges.resize(capabilityId + 1);
+        sCapabilityPrivileges[capabilityId] = privilegeIt != CAPABILITY_PRIVILEGES.end()
+                                                  ? privilegeIt->second
+                                                  : "urn:AGL:permission:vshl:" + capability->getName() + ":public";
+        sCapabilityIds[capability->getName()] = capabilityId;
+    }
+
+    // Registering an already registered capability returns its id.
+    sGuiMetadataCapabilityId = sCapabilityMessagingService->registerCapability(sCapabilitiesFactory->getGuiMetadata());
+    sPhoneControlCapabilityId =
+        sCapabilityMessagingService->registerCapability(sCapabilitiesFactory->getPhoneControl());
+    sNavigationCapabilityId = sCapabilityMessagingService->registerCapability(sCapabilitiesFactory->getNavigation());
+
     return 0;
 }
 
-CTLP_CAPI(onAuthStateEvent, source, argsJ, eventJ) {
+VSHL_CAPI(onAuthStateEvent) {
     if (sEventRouter == nullptr) {
         return -1;
     }
 
-    string eventName = vshl::voiceagents::VSHL_EVENT_AUTH_STATE_EVENT;
-    json eventJson = json::parse(json_object_to_json_string(eventJ));
-    if (eventJson.find(EVENTS_JSON_ATTR_VA_ID) == eventJson.end()) {
+    const string& eventName = vshl::voiceagents::VSHL_EVENT_AUTH_STATE_EVENT;
+    std::string voiceAgentId;
+    if (!getString(eventJ, EVENTS_JSON_ATTR_VA_ID, voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "onAuthStateEvent: No voiceagent id found.");
         return -1;
     }
-    std::string voiceAgentId(eventJson[EVENTS_JSON_ATTR_VA_ID].get<string>());
 
-    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, json_object_to_json_string(eventJ));
+    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, eventJ);
 
     return 0;
 }
 
-CTLP_CAPI(onConnectionStateEvent, source, argsJ, eventJ) {
+VSHL_CAPI(onConnectionStateEvent) {
     if (sEventRouter == nullptr) {
         return -1;
     }
 
-    string eventName = vshl::voiceagents::VSHL_EVENT_CONNECTION_STATE_EVENT;
-    json eventJson = json::parse(json_object_to_json_string(eventJ));
-    if (eventJson.find(EVENTS_JSON_ATTR_VA_ID) == eventJson.end()) {
+    const string& eventName = vshl::voiceagents::VSHL_EVENT_CONNECTION_STATE_EVENT;
+    std::string voiceAgentId;
+    if (!getString(eventJ, EVENTS_JSON_ATTR_VA_ID, voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "onConnectionStateEvent: No voiceagent id found.");
         return -1;
     }
-    std::string voiceAgentId(eventJson[EVENTS_JSON_ATTR_VA_ID].get<string>());
 
-    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, json_object_to_json_string(eventJ));
+    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, eventJ);
 
     return 0;
 }
 
-CTLP_CAPI(onDialogStateEvent, source, argsJ, eventJ) {
+VSHL_CAPI(onDialogStateEvent) {
     if (sEventRouter == nullptr) {
         return -1;
     }
 
-    string eventName = vshl::voiceagents::VSHL_EVENT_DIALOG_STATE_EVENT;
-    json eventJson = json::parse(json_object_to_json_string(eventJ));
-    if (eventJson.find(EVENTS_JSON_ATTR_VA_ID) == eventJson.end()) {
+    const string& eventName = vshl::voiceagents::VSHL_EVENT_DIALOG_STATE_EVENT;
+    std::string voiceAgentId;
+    if (!getString(eventJ, EVENTS_JSON_ATTR_VA_ID, voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "onDialogStateEvent: No voiceagent id found.");
         return -1;
     }
-    std::string voiceAgentId(eventJson[EVENTS_JSON_ATTR_VA_ID].get<string>());
 
-    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, json_object_to_json_string(eventJ));
+    sEventRouter->handleIncomingEvent(eventName, voiceAgentId, eventJ);
 
     return 0;
 }
 
-CTLP_CAPI(loadVoiceAgentsConfig, source, argsJ, eventJ) {
-    if (sVoiceAgentsDataManager == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: Voice service not initialized.");
+VSHL_CAPI(loadCallDeadlines) {
+    if (sAfbApi == nullptr) {
         return -1;
     }
 
     if (argsJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: No arguments supplied.");
+        sLogger->log(Level::WARNING, TAG, "loadCallDeadlines: No arguments supplied.");
+        return -1;
+    }
+
+    int64_t deadlineMs = 0;
+    if (getInt64(argsJ, DEADLINES_JSON_ATTR_DEFAULT_MS, deadlineMs) && deadlineMs >= 0) {
+        sAfbApi->setDefaultDeadline(std::chrono::milliseconds(deadlineMs));
+    }
+
+    int64_t slowCallMs = 0;
+    if (getInt64(argsJ, DEADLINES_JSON_ATTR_SLOW_CALL_MS, slowCallMs) && slowCallMs >= 0) {
+        sAfbApi->setSlowCallThreshold(std::chrono::milliseconds(slowCallMs));
+    }
+
+    json_object* apisJ = getMember(argsJ, DEADLINES_JSON_ATTR_APIS, json_type_object);
+    if (apisJ != nullptr) {
+        struct json_object_iterator apiIt = json_object_iter_begin(apisJ);
+        struct json_object_iterator apiEnd = json_object_iter_end(apisJ);
+        for (; !json_object_iter_equal(&apiIt, &apiEnd); json_object_iter_next(&apiIt)) {
+            std::string api = json_object_iter_peek_name(&apiIt);
+            json_object* apiDeadlineJ = json_object_iter_peek_value(&apiIt);
+            if (!json_object_is_type(apiDeadlineJ, json_type_int) || json_object_get_int64(apiDeadlineJ) < 0) {
+                sLogger->log(Level::WARNING, TAG, "loadCallDeadlines: Invalid deadline for api " + api);
+                continue;
+            }
+            sAfbApi->setDefaultDeadline(api, std::chrono::milliseconds(json_object_get_int64(apiDeadlineJ)));
+        }
+    }
+
+    return 0;
+}
+
+VSHL_CAPI(loadCircuitBreakers) {
+    if (sAfbApi == nullptr) {
         return -1;
     }
 
-    json agentsConfigJson = json::parse(json_object_to_json_string(argsJ));
-    if (agentsConfigJson.find(VA_JSON_ATTR_AGENTS) == agentsConfigJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "loadVoiceAgentsConfig: No agents object found in agents json");
+    int64_t failureThreshold = 0;
+    int64_t openMs = 0;
+    if (!getInt64(argsJ, BREAKERS_JSON_ATTR_FAILURE_THRESHOLD, failureThreshold) || failureThreshold < 0 ||
+        !getInt64(argsJ, BREAKERS_JSON_ATTR_OPEN_MS, openMs) || openMs <= 0) {
+        sLogger->log(Level::WARNING, TAG, "loadCircuitBreakers: Invalid failure threshold or open duration.");
         return -1;
     }
+    sAfbApi->setBreakerPolicy({static_cast<uint32_t>(failureThreshold), std::chrono::milliseconds(openMs)});
+
+    json_object* probesJ = getMember(argsJ, BREAKERS_JSON_ATTR_PROBES, json_type_object);
+    if (probesJ != nullptr) {
+        struct json_object_iterator probeIt = json_object_iter_begin(probesJ);
+        struct json_object_iterator probeEnd = json_object_iter_end(probesJ);
+        for (; !json_object_iter_equal(&probeIt, &probeEnd); json_object_iter_next(&probeIt)) {
+            std::string api = json_object_iter_peek_name(&probeIt);
+            json_object* probeVerbJ = json_object_iter_peek_value(&probeIt);
+            if (!json_object_is_type(probeVerbJ, json_type_string)) {
+                sLogger->log(Level::WARNING, TAG, "loadCircuitBreakers: Invalid probe verb for api " + api);
+                continue;
+            }
+            sAfbApi->setBreakerProbe(api, json_object_get_string(probeVerbJ));
+        }
+    }
 
-    json agentsJson = agentsConfigJson[VA_JSON_ATTR_AGENTS];
-    for (auto agentIt = agentsJson.begin(); agentIt != agentsJson.end(); ++agentIt) {
-        json agentJson = *agentIt;
+    return 0;
+}
 
-        if (agentJson.find(VA_JSON_ATTR_ID) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_ACTIVE) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_NAME) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_API) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_WWS) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_ACTIVE_WW) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_DESCRIPTION) == agentJson.end() ||
-            agentJson.find(VA_JSON_ATTR_VENDOR) == agentJson.end()) {
-            std::stringstream error;
-            error << "loadVoiceAgentsConfig: One or more missing params in agent "
-                     "config "
-                  << agentJson.dump();
-            sLogger->log(Level::WARNING, TAG, error.str().c_str());
+VSHL_CAPI(loadEventCoalescing) {
+    if (sVoiceAgentsDataManager == nullptr) {
+        sLogger->log(Level::WARNING, TAG, "loadEventCoalescing: Voice service not initialized.");
+        return -1;
+    }
+
+    json_object* eventsJ = getMember(argsJ, COALESCING_JSON_ATTR_EVENTS, json_type_array);
+    if (eventsJ == nullptr) {
+        sLogger->log(Level::WARNING, TAG, "loadEventCoalescing: No events array supplied.");
+        return -1;
+    }
+
+    size_t eventsCount = json_object_array_length(eventsJ);
+    for (size_t eventIdx = 0; eventIdx < eventsCount; ++eventIdx) {
+        json_object* eventPolicyJ = json_object_array_get_idx(eventsJ, eventIdx);
+
+        std::string eventName;
+        int64_t windowMs = 0;
+        vshl::utilities::events::CoalescingPolicy policy;
+        if (!getString(eventPolicyJ, COALESCING_JSON_ATTR_NAME, eventName) ||
+            !getInt64(eventPolicyJ, COALESCING_JSON_ATTR_WINDOW_MS, windowMs) || windowMs <= 0) {
+            sLogger->log(Level::WARNING, TAG, "loadEventCoalescing: Invalid policy at index " + to_string(eventIdx));
             continue;
         }
+        getStringSet(eventPolicyJ, COALESCING_JSON_ATTR_CRITICAL, policy.criticalStates);
+        policy.window = std::chrono::milliseconds(windowMs);
 
-        std::string id(agentJson[VA_JSON_ATTR_ID].get<string>());
-        std::string name(agentJson[VA_JSON_ATTR_NAME].get<string>());
-        std::string api(agentJson[VA_JSON_ATTR_API].get<string>());
-        std::string description(agentJson[VA_JSON_ATTR_DESCRIPTION].get<string>());
-        std::string vendor(agentJson[VA_JSON_ATTR_VENDOR].get<string>());
-        std::string activeWakeword(agentJson[VA_JSON_ATTR_ACTIVE_WW].get<string>());
-        bool isActive(agentJson[VA_JSON_ATTR_ACTIVE].get<bool>());
-
-        shared_ptr<unordered_set<string>> wakewords = std::make_shared<unordered_set<string>>();
-        json wakewordsJson = agentJson[VA_JSON_ATTR_WWS];
-        for (auto wwIt = wakewordsJson.begin(); wwIt != wakewordsJson.end(); ++wwIt) {
-            wakewords->insert(wwIt->get<string>());
+        if (!sVoiceAgentsDataManager->setEventCoalescingPolicy(eventName, policy)) {
+            sLogger->log(Level::WARNING, TAG, "loadEventCoalescing: Failed to set policy of event " + eventName);
         }
+    }
+
+    return 0;
+}
 
+// Reloads the voiceagents from the configuration @c configJ, only applying what changed.
+static bool applyVoiceAgentsConfig(json_object* configJ) {
+    vshl::voiceagents::VoiceAgentsConfig config;
+    if (!vshl::voiceagents::parseVoiceAgentsConfig(configJ, config, sLogger)) {
+        return false;
+    }
+
+    return sVoiceAgentsDataManager->reloadVoiceAgents(config);
+}
+
+// Reloads the voiceagents from the configuration file at @c path.
+static bool reloadVoiceAgentsConfigFile(const std::string& path) {
+    json_object* configJ = json_object_from_file(path.c_str());
+    if (configJ == nullptr) {
+        sLogger->log(Level::ERROR, TAG, "Failed to read voiceagents configuration file " + path);
+        return false;
+    }
+
+    bool reloaded = applyVoiceAgentsConfig(configJ);
+    json_object_put(configJ);
+    return reloaded;
+}
+
+VSHL_CAPI(loadVoiceAgentsConfig) {
+    if (sVoiceAgentsDataManager == nullptr) {
+        sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: Voice service not initialized.");
+        return -1;
+    }
+
+    if (argsJ == nullptr) {
+        sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: No arguments supplied.");
+        return -1;
+    }
+
+    vshl::voiceagents::VoiceAgentsConfig config;
+    if (!vshl::voiceagents::parseVoiceAgentsConfig(argsJ, config, sLogger)) {
+        sLogger->log(Level::ERROR, TAG, "loadVoiceAgentsConfig: Invalid agents json");
+        return -1;
+    }
+
+    for (auto& agent : config.agents) {
+        auto wakewords = std::make_shared<unordered_set<string>>(agent.wakewords.begin(), agent.wakewords.end());
         sVoiceAgentsDataManager->addNewVoiceAgent(
-            id, name, description, api, vendor, activeWakeword, isActive, wakewords);
+            agent.id,
+            agent.name,
+            agent.description,
+            agent.api,
+            agent.vendor,
+            agent.activeWakeword,
+            agent.isActive,
+            wakewords);
     }
 
     // Set the default agent.
-    if (agentsConfigJson.find(VA_JSON_ATTR_DEFAULT) == agentsConfigJson.end()) {
+    if (config.defaultVoiceAgentId.empty()) {
         sLogger->log(Level::ERROR, TAG, "loadVoiceAgentsConfig: No default agent found in agents json");
         return -1;
     }
-    std::string defaultAgentId(agentsConfigJson[VA_JSON_ATTR_DEFAULT].get<string>());
-    sVoiceAgentsDataManager->setDefaultVoiceAgent(defaultAgentId);
+    sVoiceAgentsDataManager->setDefaultVoiceAgent(config.defaultVoiceAgentId);
+
+    // The watched configuration file, if any, supersedes the voiceagents above.
+    std::string watchPath;
+    if (getString(argsJ, VA_JSON_ATTR_WATCH, watchPath) && !watchPath.empty()) {
+        sVoiceAgentsConfigPath = watchPath;
+        if (!reloadVoiceAgentsConfigFile(watchPath)) {
+            sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: Failed to apply " + watchPath);
+        }
+    }
+
+    // Start the subscription process of the voiceagents now rather than in the
+    // first request. The ones that are not up yet are retried by the requests.
+    sVoiceAgentsDataManager->startNewSubscriptionProcess();
 
+    // Reload the voiceagents each time the watched configuration file changes.
+    // The watcher calls back on its own thread, the reload runs on the binder.
+    if (!watchPath.empty()) {
+        sVoiceAgentsConfigWatcher = vshl::utilities::files::FileWatcher::create(watchPath, [watchPath]() {
+            sAfbApi->queueJob([watchPath]() { reloadVoiceAgentsConfigFile(watchPath); });
+        });
+        if (!sVoiceAgentsConfigWatcher) {
+            sLogger->log(Level::WARNING, TAG, "loadVoiceAgentsConfig: Failed to watch " + watchPath);
+        }
+    }
+
+    return 0;
+}
+
+VSHL_CAPI(reloadVoiceAgentsConfig) {
+    if (sVoiceAgentsDataManager == nullptr) {
+        return -1;
+    }
+
+    // The configuration is either in the request or in the configured file.
+    bool reloaded = false;
+    if (eventJ != nullptr && getMember(eventJ, VA_JSON_ATTR_AGENTS, json_type_array) != nullptr) {
+        reloaded = applyVoiceAgentsConfig(eventJ);
+    } else if (!sVoiceAgentsConfigPath.empty()) {
+        reloaded = reloadVoiceAgentsConfigFile(sVoiceAgentsConfigPath);
+    } else {
+        sLogger->log(Level::WARNING, TAG, "reloadVoiceAgentsConfig: No agents supplied and no file configured.");
+        return -1;
+    }
+    if (!reloaded) {
+        sLogger->log(Level::ERROR, TAG, "reloadVoiceAgentsConfig: Failed to reload voiceagents");
+        return -1;
+    }
+
+    AFB_ReqSuccess(source->request, NULL, NULL);
     return 0;
 }
 
-CTLP_CAPI(startListening, source, argsJ, eventJ) {
+VSHL_CAPI(startListening) {
     if (sVoiceAgentsDataManager == nullptr) {
         return -1;
     }
 
-    // Start the new subscription process. It will be ignored if already done.
+    // Retry the subscription process of the voiceagents for which it failed.
     sVoiceAgentsDataManager->startNewSubscriptionProcess();
 
     if (sVRRequestProcessor == nullptr) {
         return -1;
     }
 
-    int result = 0;
-    string requestId = sVRRequestProcessor->startListening();
+    // A detected wakeword routes the request to the voiceagent that owns it,
+    // otherwise it goes to the default voiceagent.
+    shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent;
+    std::string wakeword;
+    if (getString(eventJ, STARTLISTENING_JSON_ATTR_WAKEWORD, wakeword)) {
+        voiceAgent = sVoiceAgentsDataManager->findVoiceAgentByWakeword(wakeword);
+        if (voiceAgent == nullptr || !voiceAgent->isActive()) {
+            timer.setFailed(true);
+            AFB_ReqFail(source->request, NULL, ("No active voiceagent for wakeword: " + wakeword).c_str());
+            return 0;
+        }
+    }
+
+    // In async mode the reply only carries the request id, the outcome of the
+    // voiceagent call is published later as a voice_startlistening_event.
+    // Otherwise the reply waits for the voiceagent, so that a failure to start
+    // listening is reported to the caller. The request and the timing of the
+    // call are kept alive until then, but the binder thread is not held.
+    bool async = false;
+    getBool(eventJ, STARTLISTENING_JSON_ATTR_ASYNC, async);
+
+    afb_req_t request = nullptr;
+    shared_ptr<VerbTimer> completionTimer;
+    vshl::core::VRRequestProcessor::StartListeningCallback onCompleted;
+    if (async) {
+        onCompleted = [](const string& requestId, const string& voiceAgentId, bool started, const string& error) {
+            // The payload is only built if someone listens for the outcome.
+            if (sEventRouter == nullptr ||
+                !sVoiceAgentsDataManager->hasVshlEventSubscribers(
+                    vshl::voiceagents::VSHL_EVENT_START_LISTENING_EVENT, voiceAgentId)) {
+                return;
+            }
+
+            json_object* payload = json_object_new_object();
+            addString(payload, STARTLISTENING_JSON_ATTR_REQUEST, requestId);
+            addString(payload, EVENTS_JSON_ATTR_VA_ID, voiceAgentId);
+            addString(
+                payload,
+                STARTLISTENING_JSON_ATTR_STATE,
+                started ? STARTLISTENING_STATE_STARTED : STARTLISTENING_STATE_FAILED);
+            if (!started) {
+                addString(payload, STARTLISTENING_JSON_ATTR_ERROR, error);
+            }
 
-    if (!requestId.empty()) {
-        json responseJson;
-        responseJson[STARTLISTENING_JSON_ATTR_REQUEST] = requestId;
-        AFB_ReqSuccess(source->request, json_tokener_parse(responseJson.dump().c_str()), NULL);
+            sEventRouter->handleIncomingEvent(
+                vshl::voiceagents::VSHL_EVENT_START_LISTENING_EVENT, voiceAgentId, payload);
+            json_object_put(payload);
+        };
     } else {
+        request = afb_req_addref(source->request);
+        completionTimer = std::make_shared<VerbTimer>(std::move(timer));
+        onCompleted = [request, completionTimer](
+                          const string& requestId, const string& voiceAgentId, bool started, const string& error) {
+            {
+                // The call is recorded once the voiceagent replied.
+                VerbTimer replyTimer(std::move(*completionTimer));
+                replyTimer.setFailed(!started);
+            }
+
+            if (started) {
+                json_object* responseJson = json_object_new_object();
+                addString(responseJson, STARTLISTENING_JSON_ATTR_REQUEST, requestId);
+                AFB_ReqSuccess(request, responseJson, NULL);
+            } else {
+                AFB_ReqFail(request, NULL, ("Failed to startListening: " + error).c_str());
+            }
+            afb_req_unref(request);
+        };
+    }
+
+    string requestId = voiceAgent ? sVRRequestProcessor->startListeningAsync(voiceAgent, onCompleted)
+                                  : sVRRequestProcessor->startListeningAsync(onCompleted);
+    if (requestId.empty()) {
+        // The completion is not called when the request could not be issued.
+        if (request != nullptr) {
+            afb_req_unref(request);
+        }
+        (completionTimer ? *completionTimer : timer).setFailed(true);
         AFB_ReqFail(source->request, NULL, "Failed to startListening...");
+    } else if (async) {
+        json_object* responseJson = json_object_new_object();
+        addString(responseJson, STARTLISTENING_JSON_ATTR_REQUEST, requestId);
+        AFB_ReqSuccess(source->request, responseJson, NULL);
     }
 
     return 0;
 }
 
-CTLP_CAPI(cancelListening, source, argsJ, eventJ) {
+VSHL_CAPI(cancelListening) {
     return 0;
 }
 
-CTLP_CAPI(enumerateVoiceAgents, source, argsJ, eventJ) {
-    if (sVoiceAgentsDataManager == nullptr) {
-        return -1;
-    }
-    
-    auto agents = sVoiceAgentsDataManager->getAllVoiceAgents();
-    std::string defaultAgentId(sVoiceAgentsDataManager->getDefaultVoiceAgent());
-
-    json responseJson;
-    json agentsJson = json::array();
-
-    for (auto agent : agents) {
-        json agentJson;
-        agentJson[VA_JSON_ATTR_ID] = agent->getId();
-        agentJson[VA_JSON_ATTR_NAME] = agent->getName();
-        agentJson[VA_JSON_ATTR_DESCRIPTION] = agent->getDescription();
-        agentJson[VA_JSON_ATTR_API] = agent->getApi();
-        agentJson[VA_JSON_ATTR_VENDOR] = agent->getVendor();
-        agentJson[VA_JSON_ATTR_ACTIVE] = agent->isActive();
-        agentJson[VA_JSON_ATTR_ACTIVE_WW] = agent->getActiveWakeword();
+// Builds the enumerateVoiceAgents response from a snapshot of the voiceagents data.
+static json_object* buildEnumerateVoiceAgentsResponse(const vshl::voiceagents::VoiceAgentsSnapshot& snapshot) {
+    json_object* responseJson = json_object_new_object();
+    json_object* agentsJson = json_object_new_array();
+
+    for (auto& element : snapshot.voiceAgents) {
+        auto& agent = element.second;
+        json_object* agentJson = json_object_new_object();
+        addString(agentJson, VA_JSON_ATTR_ID, agent->getId());
+        addString(agentJson, VA_JSON_ATTR_NAME, agent->getName());
+        addString(agentJson, VA_JSON_ATTR_DESCRIPTION, agent->getDescription());
+        addString(agentJson, VA_JSON_ATTR_API, agent->getApi());
+        addString(agentJson, VA_JSON_ATTR_VENDOR, agent->getVendor());
+        addBool(agentJson, VA_JSON_ATTR_ACTIVE, agent->isActive());
+        addString(agentJson, VA_JSON_ATTR_ACTIVE_WW, agent->getActiveWakeword());
 
         auto wakewords = agent->getWakeWords();
         if (wakewords != nullptr) {
-            json wakewordsJson;
+            json_object* wakewordsJson = json_object_new_array();
             for (auto wakeword : *wakewords) {
-                wakewordsJson.push_back(wakeword);
+                json_object_array_add(wakewordsJson, json_object_new_string(wakeword.c_str()));
             }
-            agentJson[VA_JSON_ATTR_WWS] = wakewordsJson;
+            json_object_object_add(agentJson, VA_JSON_ATTR_WWS.c_str(), wakewordsJson);
         }
 
-        agentsJson.push_back(agentJson);
+        json_object_array_add(agentsJson, agentJson);
     }
 
-    responseJson[VA_JSON_ATTR_AGENTS] = agentsJson;
-    responseJson[VA_JSON_ATTR_DEFAULT] = defaultAgentId;
+    json_object_object_add(responseJson, VA_JSON_ATTR_AGENTS.c_str(), agentsJson);
+    addString(responseJson, VA_JSON_ATTR_DEFAULT, snapshot.defaultVoiceAgentId);
 
-    AFB_ReqSuccess(source->request, json_tokener_parse(responseJson.dump().c_str()), NULL);
+    return responseJson;
+}
+
+VSHL_CAPI(enumerateVoiceAgents) {
+    if (sVoiceAgentsDataManager == nullptr) {
+        return -1;
+    }
+
+    // Rebuild the response only if the voiceagents data changed since it was cached.
+    auto snapshot = sVoiceAgentsDataManager->getSnapshot();
+    json_object* responseJson = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sEnumerateVoiceAgentsMutex);
+        if (sEnumerateVoiceAgentsResponse == nullptr || sEnumerateVoiceAgentsGeneration != snapshot->generation) {
+            if (sEnumerateVoiceAgentsResponse != nullptr) {
+                json_object_put(sEnumerateVoiceAgentsResponse);
+            }
+            sEnumerateVoiceAgentsResponse = buildEnumerateVoiceAgentsResponse(*snapshot);
+            sEnumerateVoiceAgentsGeneration = snapshot->generation;
+        }
+
+        // The cached response is used by concurrent verbs, the reply gets a copy, see IAFBApi.h.
+        responseJson = JsonHandle::copy(sEnumerateVoiceAgentsResponse).release();
+    }
+
+    AFB_ReqSuccess(source->request, responseJson, NULL);
 
     return 0;
 }
 
-CTLP_CAPI(subscribe, source, argsJ, eventJ) {
+VSHL_CAPI(subscribe) {
     if (sVoiceAgentsDataManager == nullptr) {
         return -1;
     }
 
-    // Start the new subscription process. It will be ignored if already done.
+    // Retry the subscription process of the voiceagents for which it failed.
     sVoiceAgentsDataManager->startNewSubscriptionProcess();
 
     if (eventJ == nullptr) {
@@ -329,18 +694,17 @@ CTLP_CAPI(subscribe, source, argsJ, eventJ) {
         return -1;
     }
 
-    json subscribeJson = json::parse(json_object_to_json_string(eventJ));
-    if (subscribeJson.find(EVENTS_JSON_ATTR_VA_ID) == subscribeJson.end()) {
+    std::string voiceAgentId;
+    if (!getString(eventJ, EVENTS_JSON_ATTR_VA_ID, voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "subscribe: No voiceagent id found in subscribe json");
         return -1;
     }
-    std::string voiceAgentId(subscribeJson[EVENTS_JSON_ATTR_VA_ID].get<string>());
 
-    if (subscribeJson.find(EVENTS_JSON_ATTR_EVENTS) == subscribeJson.end()) {
+    list<string> events;
+    if (!getStringList(eventJ, EVENTS_JSON_ATTR_EVENTS, events)) {
         sLogger->log(Level::ERROR, TAG, "subscribe: No events array found in subscribe json");
         return -1;
     }
-    list<string> events(subscribeJson[EVENTS_JSON_ATTR_EVENTS].get<list<string>>());
 
     // Subscribe this client for the listed events.
     auto request = vshl::afb::AFBRequestImpl::create(source->request);
@@ -356,7 +720,7 @@ CTLP_CAPI(subscribe, source, argsJ, eventJ) {
     return 0;
 }
 
-CTLP_CAPI(setDefaultVoiceAgent, source, argsJ, eventJ) {
+VSHL_CAPI(setDefaultVoiceAgent) {
     if (sVoiceAgentsDataManager == nullptr) {
         return -1;
     }
@@ -366,13 +730,12 @@ CTLP_CAPI(setDefaultVoiceAgent, source, argsJ, eventJ) {
         return -1;
     }
 
-    json jsonRequest = json::parse(json_object_to_json_string(eventJ));
-    if (jsonRequest.find(VA_JSON_ATTR_ID) == jsonRequest.end()) {
+    std::string voiceAgentId;
+    if (!getString(eventJ, VA_JSON_ATTR_ID, voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "setDefaultVoiceAgent: voice agent id not found in request json");
         return -1;
     }
 
-    std::string voiceAgentId(jsonRequest[VA_JSON_ATTR_ID].get<string>());
     if (!sVoiceAgentsDataManager->setDefaultVoiceAgent(voiceAgentId)) {
         sLogger->log(Level::ERROR, TAG, "setDefaultVoiceAgent: Failed to set default agent");
         return -1;
@@ -382,236 +745,333 @@ CTLP_CAPI(setDefaultVoiceAgent, source, argsJ, eventJ) {
     return 0;
 }
 
-CTLP_CAPI(guiMetadataSubscribe, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
+// Returns the payload of a publish request, or nullptr if it has none. The payload
+// is either a string, the legacy encoding, or a structured object or array that
+// subscribers receive as is instead of a JSON document escaped into a string.
+static json_object* getPublishPayload(json_object* eventJ) {
+    json_object* payloadJ = getMember(eventJ, CAPABILITIES_JSON_ATTR_PAYLOAD);
+    if (payloadJ == nullptr) {
+        return nullptr;
+    }
+
+    switch (json_object_get_type(payloadJ)) {
+        case json_type_string:
+        case json_type_object:
+        case json_type_array:
+            return payloadJ;
+        default:
+            return nullptr;
+    }
+}
+
+// Resolves the capability a generic capability verb or batch operation is about,
+// from the request, and checks the privilege of the capability.
+// Returns the capability id, or -1 with @c error set.
+static int resolveCapability(afb_req_t afbReq, json_object* eventJ, std::string& error) {
+    std::string capabilityName;
+    if (!getString(eventJ, CAPABILITIES_JSON_ATTR_CAPABILITY, capabilityName)) {
+        error = "No capability found in request json";
+        return -1;
+    }
+
+    auto capabilityIt = sCapabilityIds.find(capabilityName);
+    if (capabilityIt == sCapabilityIds.end()) {
+        error = "Unknown capability: " + capabilityName;
+        return -1;
+    }
+
+    int capabilityId = capabilityIt->second;
+    if (!afb_req_has_permission(afbReq, sCapabilityPrivileges[capabilityId].c_str())) {
+        error = "Permission denied for capability: " + capabilityName;
         return -1;
     }
 
-    shared_ptr<vshl::common::interfaces::ICapability> guMetadataCapability = sCapabilitiesFactory->getGuiMetadata();
-    if (!guMetadataCapability) {
-        sLogger->log(
-            Level::WARNING,
-            TAG,
-            "guimetadataSubscribe: Failed to "
-            "fetch guimetadata capability "
-            "object.");
+    return capabilityId;
+}
+
+// Subscribes the client of a request to the capability events listed in @c eventJ.
+static int subscribeToCapability(CtlSourceT* source, const std::string& verb, int capabilityId, json_object* eventJ) {
+    if (sCapabilityMessagingService == nullptr || capabilityId == -1) {
         return -1;
     }
 
     if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "guimetadataSubscribe: No arguments supplied.");
+        sLogger->log(Level::WARNING, TAG, verb + ": No arguments supplied.");
         return -1;
     }
 
-    json subscribeJson = json::parse(json_object_to_json_string(eventJ));
-    if (subscribeJson.find(CAPABILITIES_JSON_ATTR_ACTIONS) == subscribeJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "guimetadataSubscribe: No events array found in subscribe json");
+    list<string> events;
+    if (!getStringList(eventJ, CAPABILITIES_JSON_ATTR_ACTIONS, events)) {
+        sLogger->log(Level::ERROR, TAG, verb + ": No events array found in subscribe json");
         return -1;
     }
-    list<string> events(subscribeJson[CAPABILITIES_JSON_ATTR_ACTIONS].get<list<string>>());
 
-    // SUbscribe this client for the guimetadata events.
+    // Subscribe this client for the capability events.
     auto request = vshl::afb::AFBRequestImpl::create(source->request);
     for (auto event : events) {
-        if (!sCapabilityMessagingService->subscribe(*request, guMetadataCapability, event)) {
-            sLogger->log(Level::ERROR, TAG, "guimetadataSubscribe: Failed to subscribe to event: " + event);
+        if (!sCapabilityMessagingService->subscribe(*request, capabilityId, event)) {
+            sLogger->log(Level::ERROR, TAG, verb + ": Failed to subscribe to event: " + event);
             return -1;
         }
     }
 
     AFB_ReqSuccess(
-        source->request, json_object_new_string("Subscription to guimetadata events successfully completed."), NULL);
+        source->request, json_object_new_string("Subscription to capability events successfully completed."), NULL);
     return 0;
 }
 
-CTLP_CAPI(guiMetadataPublish, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
-        return -1;
-    }
-
-    shared_ptr<vshl::common::interfaces::ICapability> guMetadataCapability = sCapabilitiesFactory->getGuiMetadata();
-    if (!guMetadataCapability) {
-        sLogger->log(
-            Level::WARNING,
-            TAG,
-            "guimetadataPublish: Failed to fetch "
-            "guimetadata capability object.");
+// Publishes the capability message in @c eventJ to the subscribers of the capability.
+static int publishToCapability(CtlSourceT* source, const std::string& verb, int capabilityId, json_object* eventJ) {
+    if (sCapabilityMessagingService == nullptr || capabilityId == -1) {
         return -1;
     }
 
     if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "guimetadataPublish: No arguments supplied.");
+        sLogger->log(Level::WARNING, TAG, verb + ": No arguments supplied.");
         return -1;
     }
 
-    json publishJson = json::parse(json_object_to_json_string(eventJ));
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_ACTION) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "guimetadataPublish: No action found in publish json");
+    std::string action;
+    if (!getString(eventJ, CAPABILITIES_JSON_ATTR_ACTION, action)) {
+        sLogger->log(Level::ERROR, TAG, verb + ": No action found in publish json");
         return -1;
     }
-    std::string action(publishJson[CAPABILITIES_JSON_ATTR_ACTION].get<string>());
 
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_PAYLOAD) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "guimetadataPublish: No payload found in publish json");
+    // The payload is the object the binder already parsed, it is not
+    // serialized again. The subscribers get a copy of it, see IAFBApi.h.
+    json_object* payloadJ = getPublishPayload(eventJ);
+    if (payloadJ == nullptr) {
+        sLogger->log(Level::ERROR, TAG, verb + ": No payload found in publish json");
         return -1;
     }
-    std::string payload(publishJson[CAPABILITIES_JSON_ATTR_PAYLOAD].get<string>());
 
-    if (!sCapabilityMessagingService->publish(guMetadataCapability, action, payload)) {
-        sLogger->log(Level::ERROR, TAG, "guimetadataPublish: Failed to publish message: " + action);
+    if (!sCapabilityMessagingService->publish(capabilityId, action, payloadJ)) {
+        sLogger->log(Level::ERROR, TAG, verb + ": Failed to publish message: " + action);
         return -1;
     }
 
-    AFB_ReqSuccess(source->request, json_object_new_string("Successfully published guimetadata messages."), NULL);
+    AFB_ReqSuccess(source->request, json_object_new_string("Successfully published capability messages."), NULL);
     return 0;
 }
 
-CTLP_CAPI(phonecontrolSubscribe, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
+VSHL_CAPI(capabilitySubscribe) {
+    if (sCapabilityMessagingService == nullptr) {
         return -1;
     }
 
-    shared_ptr<vshl::common::interfaces::ICapability> phoneControlCapability = sCapabilitiesFactory->getPhoneControl();
-    if (!phoneControlCapability) {
-        sLogger->log(Level::WARNING, TAG, "phoneControlSubscribe: Failed to fetch phone control capability object.");
+    std::string error;
+    int capabilityId = resolveCapability(source->request, eventJ, error);
+    if (capabilityId == -1) {
+        sLogger->log(Level::ERROR, TAG, "capabilitySubscribe: " + error);
         return -1;
     }
 
-    if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "phoneControlSubscribe: No arguments supplied.");
+    return subscribeToCapability(source, "capabilitySubscribe", capabilityId, eventJ);
+}
+
+VSHL_CAPI(capabilityPublish) {
+    if (sCapabilityMessagingService == nullptr) {
         return -1;
     }
 
-    json subscribeJson = json::parse(json_object_to_json_string(eventJ));
-    if (subscribeJson.find(CAPABILITIES_JSON_ATTR_ACTIONS) == subscribeJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "phoneControlSubscribe: No events array found in subscribe json");
+    std::string error;
+    int capabilityId = resolveCapability(source->request, eventJ, error);
+    if (capabilityId == -1) {
+        sLogger->log(Level::ERROR, TAG, "capabilityPublish: " + error);
         return -1;
     }
-    list<string> events(subscribeJson[CAPABILITIES_JSON_ATTR_ACTIONS].get<list<string>>());
 
-    // SUbscribe this client for the phone call control events.
-    auto request = vshl::afb::AFBRequestImpl::create(source->request);
-    for (auto event : events) {
-        if (!sCapabilityMessagingService->subscribe(*request, phoneControlCapability, event)) {
-            sLogger->log(Level::ERROR, TAG, "phoneControlSubscribe: Failed to subscribe to event: " + event);
-            return -1;
-        }
-    }
+    return publishToCapability(source, "capabilityPublish", capabilityId, eventJ);
+}
 
-    AFB_ReqSuccess(
-        source->request, json_object_new_string("Subscription to phone control events successfully completed."), NULL);
-    return 0;
+VSHL_CAPI(guiMetadataSubscribe) {
+    return subscribeToCapability(source, "guiMetadataSubscribe", sGuiMetadataCapabilityId, eventJ);
 }
 
-CTLP_CAPI(phonecontrolPublish, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
-        return -1;
-    }
+VSHL_CAPI(guiMetadataPublish) {
+    return publishToCapability(source, "guiMetadataPublish", sGuiMetadataCapabilityId, eventJ);
+}
 
-    shared_ptr<vshl::common::interfaces::ICapability> phoneControlCapability = sCapabilitiesFactory->getPhoneControl();
-    if (!phoneControlCapability) {
-        sLogger->log(Level::WARNING, TAG, "phoneControlPublish: Failed to fetch navigation capability object.");
-        return -1;
-    }
+VSHL_CAPI(phonecontrolSubscribe) {
+    return subscribeToCapability(source, "phonecontrolSubscribe", sPhoneControlCapabilityId, eventJ);
+}
 
-    if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "phoneControlPublish: No arguments supplied.");
-        return -1;
-    }
+VSHL_CAPI(phonecontrolPublish) {
+    return publishToCapability(source, "phonecontrolPublish", sPhoneControlCapabilityId, eventJ);
+}
 
-    json publishJson = json::parse(json_object_to_json_string(eventJ));
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_ACTION) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "phoneControlPublish: No action found in publish json");
-        return -1;
-    }
-    std::string action(publishJson[CAPABILITIES_JSON_ATTR_ACTION].get<string>());
+VSHL_CAPI(navigationSubscribe) {
+    return subscribeToCapability(source, "navigationSubscribe", sNavigationCapabilityId, eventJ);
+}
 
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_PAYLOAD) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "phoneControlPublish: No payload found in publish json");
-        return -1;
-    }
-    std::string payload(publishJson[CAPABILITIES_JSON_ATTR_PAYLOAD].get<string>());
+VSHL_CAPI(navigationPublish) {
+    return publishToCapability(source, "navigationPublish", sNavigationCapabilityId, eventJ);
+}
 
-    if (!sCapabilityMessagingService->publish(phoneControlCapability, action, payload)) {
-        sLogger->log(Level::ERROR, TAG, "phoneControlPublish: Failed to publish message: " + action);
-        return -1;
-    }
+// Runs a single batch operation. Returns an empty string on success, an error message otherwise.
+// The actions a subscribe operation subscribed to are added to @c subscribed, even when it fails,
+// so that the reply tells which subscriptions are in place.
+static std::string runBatchOperation(
+    afb_req_t afbReq,
+    vshl::common::interfaces::IAFBRequest& request,
+    json_object* operationJ,
+    list<string>& subscribed) {
+    std::string error;
+    int capabilityId = resolveCapability(afbReq, operationJ, error);
+    if (capabilityId == -1) {
+        return error;
+    }
+
+    std::string op;
+    if (!getString(operationJ, BATCH_JSON_ATTR_OP, op)) {
+        return "No op found in operation json";
+    }
+
+    if (op == BATCH_OP_SUBSCRIBE) {
+        list<string> events;
+        if (!getStringList(operationJ, CAPABILITIES_JSON_ATTR_ACTIONS, events)) {
+            return "No events array found in operation json";
+        }
 
-    AFB_ReqSuccess(source->request, json_object_new_string("Successfully published phone control messages."), NULL);
-    return 0;
-}
+        for (auto event : events) {
+            if (!sCapabilityMessagingService->subscribe(request, capabilityId, event)) {
+                return "Failed to subscribe to event: " + event;
+            }
+            subscribed.push_back(event);
+        }
+    } else if (op == BATCH_OP_PUBLISH) {
+        std::string action;
+        if (!getString(operationJ, CAPABILITIES_JSON_ATTR_ACTION, action)) {
+            return "No action found in operation json";
+        }
 
-CTLP_CAPI(navigationSubscribe, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
-        return -1;
+        json_object* payloadJ = getPublishPayload(operationJ);
+        if (payloadJ == nullptr) {
+            return "No payload found in operation json";
+        }
+
+        if (!sCapabilityMessagingService->publish(capabilityId, action, payloadJ)) {
+            return "Failed to publish message: " + action;
+        }
+    } else {
+        return "Unknown op: " + op;
     }
 
-    shared_ptr<vshl::common::interfaces::ICapability> navigationCapability = sCapabilitiesFactory->getNavigation();
-    if (!navigationCapability) {
-        sLogger->log(Level::WARNING, TAG, "navigationSubscribe: Failed to fetch navigation capability object.");
+    return "";
+}
+
+VSHL_CAPI(batch) {
+    if (sCapabilityMessagingService == nullptr) {
         return -1;
     }
 
     if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "navigationSubscribe: No arguments supplied.");
+        sLogger->log(Level::WARNING, TAG, "batch: No arguments supplied.");
         return -1;
     }
 
-    json subscribeJson = json::parse(json_object_to_json_string(eventJ));
-    if (subscribeJson.find(CAPABILITIES_JSON_ATTR_ACTIONS) == subscribeJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "navigationSubscribe: No events array found in subscribe json");
+    json_object* operationsJ = getMember(eventJ, BATCH_JSON_ATTR_OPERATIONS);
+    if (operationsJ == nullptr || !json_object_is_type(operationsJ, json_type_array)) {
+        sLogger->log(Level::ERROR, TAG, "batch: No operations array found in batch json");
         return -1;
     }
-    list<string> events(subscribeJson[CAPABILITIES_JSON_ATTR_ACTIONS].get<list<string>>());
 
-    // SUbscribe this client for the navigation events.
+    // Run every operation, a failing operation doesn't stop the following ones.
     auto request = vshl::afb::AFBRequestImpl::create(source->request);
-    for (auto event : events) {
-        if (!sCapabilityMessagingService->subscribe(*request, navigationCapability, event)) {
-            sLogger->log(Level::ERROR, TAG, "navigationSubscribe: Failed to subscribe to event: " + event);
-            return -1;
+    json_object* resultsJ = json_object_new_array();
+    size_t operationsCount = json_object_array_length(operationsJ);
+    for (size_t operationIdx = 0; operationIdx < operationsCount; ++operationIdx) {
+        list<string> subscribed;
+        std::string error = runBatchOperation(
+            source->request, *request, json_object_array_get_idx(operationsJ, operationIdx), subscribed);
+
+        json_object* resultJ = json_object_new_object();
+        if (error.empty()) {
+            addString(resultJ, BATCH_JSON_ATTR_STATUS, BATCH_STATUS_SUCCESS);
+        } else {
+            sLogger->log(Level::ERROR, TAG, "batch: " + error);
+            addString(resultJ, BATCH_JSON_ATTR_STATUS, BATCH_STATUS_FAILED);
+            addString(resultJ, BATCH_JSON_ATTR_ERROR, error);
+
+            // A subscribe failing part way keeps the subscriptions made before, report them.
+            if (!subscribed.empty()) {
+                json_object* subscribedJ = json_object_new_array();
+                for (auto& event : subscribed) {
+                    json_object_array_add(subscribedJ, json_object_new_string_len(event.c_str(), event.size()));
+                }
+                json_object_object_add(resultJ, BATCH_JSON_ATTR_SUBSCRIBED.c_str(), subscribedJ);
+            }
         }
+        json_object_array_add(resultsJ, resultJ);
     }
 
-    AFB_ReqSuccess(
-        source->request, json_object_new_string("Subscription to navigation events successfully completed."), NULL);
+    json_object* responseJ = json_object_new_object();
+    json_object_object_add(responseJ, BATCH_JSON_ATTR_RESULTS.c_str(), resultsJ);
+    AFB_ReqSuccess(source->request, responseJ, NULL);
     return 0;
 }
 
-CTLP_CAPI(navigationPublish, source, argsJ, eventJ) {
-    if (sCapabilitiesFactory == nullptr || sCapabilityMessagingService == nullptr) {
-        return -1;
-    }
+// Builds the reply of the stats and resetStats verbs.
+static json_object* statsToJson() {
+    json_object* statsJ = sVerbStatsRegistry->toJson();
+    if (sAfbApi != nullptr) {
+        json_object_object_add(
+            statsJ, STATS_JSON_ATTR_EXPIRED_CALLS.c_str(), json_object_new_int64(sAfbApi->getExpiredCallCount()));
+        json_object_object_add(
+            statsJ,
+            STATS_JSON_ATTR_SKIPPED_EVENT_PUSHES.c_str(),
+            json_object_new_int64(sAfbApi->getSkippedEventPushCount()));
+        json_object_object_add(statsJ, STATS_JSON_ATTR_CALLS.c_str(), sAfbApi->callStatsToJson());
+    }
+    return statsJ;
+}
 
-    shared_ptr<vshl::common::interfaces::ICapability> navigationCapability = sCapabilitiesFactory->getNavigation();
-    if (!navigationCapability) {
-        sLogger->log(Level::WARNING, TAG, "navigationPublish: Failed to fetch navigation capability object.");
+CTLP_CAPI(stats, source, argsJ, eventJ) {
+    if (sVerbStatsRegistry == nullptr) {
         return -1;
     }
 
-    if (eventJ == nullptr) {
-        sLogger->log(Level::WARNING, TAG, "navigationPublish: No arguments supplied.");
-        return -1;
-    }
+    AFB_ReqSuccess(source->request, statsToJson(), NULL);
+    return 0;
+}
 
-    json publishJson = json::parse(json_object_to_json_string(eventJ));
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_ACTION) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "navigationPublish: No action found in publish json");
+// Replies the statistics like the stats verb, then clears them. The verb is
+// privileged, since clearing the statistics affects every client reading them.
+CTLP_CAPI(resetStats, source, argsJ, eventJ) {
+    if (sVerbStatsRegistry == nullptr) {
         return -1;
     }
-    std::string action(publishJson[CAPABILITIES_JSON_ATTR_ACTION].get<string>());
 
-    if (publishJson.find(CAPABILITIES_JSON_ATTR_PAYLOAD) == publishJson.end()) {
-        sLogger->log(Level::ERROR, TAG, "navigationPublish: No payload found in publish json");
-        return -1;
+    AFB_ReqSuccess(source->request, statsToJson(), NULL);
+
+    sVerbStatsRegistry->reset();
+    if (sAfbApi != nullptr) {
+        sAfbApi->resetCallStats();
     }
-    std::string payload(publishJson[CAPABILITIES_JSON_ATTR_PAYLOAD].get<string>());
+    return 0;
+}
 
-    if (!sCapabilityMessagingService->publish(navigationCapability, action, payload)) {
-        sLogger->log(Level::ERROR, TAG, "navigationPublish: Failed to publish message: " + action);
+CTLP_CAPI(health, source, argsJ, eventJ) {
+    if (sAfbApi == nullptr) {
         return -1;
     }
 
-    AFB_ReqSuccess(source->request, json_object_new_string("Successfully published navigation messages."), NULL);
+    json_object* healthJ = json_object_new_object();
+    json_object_object_add(healthJ, HEALTH_JSON_ATTR_APIS.c_str(), sAfbApi->breakersToJson());
+
+    if (sVoiceAgentsDataManager != nullptr) {
+        json_object* voiceAgentsJ = json_object_new_object();
+        for (auto& element : sVoiceAgentsDataManager->getSnapshot()->voiceAgents) {
+            json_object* voiceAgentJ = json_object_new_object();
+            addString(
+                voiceAgentJ,
+                HEALTH_JSON_ATTR_SUBSCRIPTION,
+                vshl::voiceagents::VoiceAgentsDataManager::getSubscriptionStateName(
+                    sVoiceAgentsDataManager->getSubscriptionState(element.first)));
+            json_object_object_add(voiceAgentsJ, element.first.c_str(), voiceAgentJ);
+        }
+        json_object_object_add(healthJ, HEALTH_JSON_ATTR_VOICEAGENTS.c_str(), voiceAgentsJ);
+    }
+    AFB_ReqSuccess(source->request, healthJ, NULL);
     return 0;
 }
@@ -26,18 +26,28 @@ CTLP_INIT(plugin, ret);
 int onAuthStateEvent(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int onConnectionStateEvent(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int onDialogStateEvent(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int loadCallDeadlines(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int loadCircuitBreakers(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int loadEventCoalescing(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int loadVoiceAgentsConfig(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int reloadVoiceAgentsConfig(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int startListening(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int cancelListening(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int enumerateVoiceAgents(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int subscribe(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int setDefaultVoiceAgent(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int capabilitySubscribe(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int capabilityPublish(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int guiMetadataSubscribe(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int guiMetadataPublish(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int phonecontrolSubscribe(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int phonecontrolPublish(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int navigationSubscribe(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 int navigationPublish(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int batch(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int stats(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int resetStats(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+int health(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
 
 #ifdef __cplusplus
 }
@@ -15,20 +15,15 @@
 
 #include "afb/AFBApiImpl.h"
 
+#include <condition_variable>
+#include <unordered_set>
+#include <vector>
+
 #include "afb/include/AFBEventImpl.h"
 #include "utilities/logging/Logger.h"
 
 extern "C" {
 #define AFB_BINDING_VERSION 3
-#define FREEIF(x) \
-    if (!x) {     \
-        free(x);  \
-    }
-#define BREAKIF(x)      \
-    if (x) {            \
-        result = false; \
-        break;          \
-    }
 
 #include "afb-definitions.h"
 }
@@ -40,35 +35,162 @@ static std::string TAG = "vshl::afb::AFBApiImpl";
  */
 using Level = vshl::common::interfaces::ILogger::Level;
 using namespace vshl::common::interfaces;
+using namespace vshl::utilities::health;
+using namespace vshl::utilities::json;
 using namespace vshl::utilities::logging;
+using namespace vshl::utilities::stats;
+using namespace vshl::utilities::timer;
+
+// Errors of calls that did not reach the called API, as opposed to errors replied by its verbs.
+static std::unordered_set<std::string> UNAVAILABLE_ERRORS = {"timeout", "disconnected", "unknown-api", "not-available"};
+
+// Error of calls failed fast, because their API is known to be down.
+static std::string ERROR_UNAVAILABLE = "unavailable";
+
+// Verbs whose identical calls in flight are shared. Only idempotent verbs may
+// be, a shared call has the side effects of one call.
+static std::unordered_set<std::string> SHAREABLE_VERBS = {"subscribe", "startSubscriptionProcess"};
+
+// Calls at least this slow are kept in the slow call log, unless configured otherwise.
+static std::chrono::milliseconds DEFAULT_SLOW_CALL_THRESHOLD = std::chrono::milliseconds(500);
+
+// Number of slow calls kept.
+static size_t SLOW_CALL_LOG_CAPACITY = 32;
+
+static std::string JSON_ATTR_SLOW_CALLS = "slow_calls";
 
 namespace vshl {
 namespace afb {
 
+// Reports whether a call to @c api reached it to the breaker of the API, if any.
+static void reportOutcome(
+    std::shared_ptr<ILogger> logger,
+    const std::string& api,
+    std::shared_ptr<CircuitBreaker> breaker,
+    const char* error) {
+    if (!breaker) {
+        return;
+    }
+
+    if (!error || UNAVAILABLE_ERRORS.find(error) == UNAVAILABLE_ERRORS.end()) {
+        breaker->onSuccess();
+        return;
+    }
+
+    bool wasOpen = breaker->getState() == CircuitBreaker::State::OPEN;
+    breaker->onFailure();
+    if (!wasOpen && breaker->getState() == CircuitBreaker::State::OPEN) {
+        logger->log(Level::WARNING, TAG, "Circuit opened, failing calls to " + api + " fast.");
+    }
+}
+
+// Returns the time elapsed since @c sentAt.
+static std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point sentAt) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sentAt);
+}
+
+// Records the latency and outcome of a call that replied or expired after @c duration.
+static void recordCall(
+    std::shared_ptr<VerbStats> stats,
+    std::shared_ptr<SlowCallLog> slowCalls,
+    const std::string& api,
+    const std::string& verb,
+    std::chrono::microseconds duration,
+    const char* error,
+    const char* info) {
+    stats->record(duration.count(), error != nullptr);
+
+    if (slowCalls->isSlow(duration.count())) {
+        slowCalls->record(
+            {api, verb, static_cast<uint64_t>(duration.count()), error ? error : "", info ? info : "",
+             std::chrono::system_clock::now()});
+    }
+}
+
+// Trampoline from the binder's job queue to a queued job.
+static void runQueuedJob(int signum, void* arg) {
+    auto job = static_cast<std::function<void()>*>(arg);
+    // A non zero signal means the job was interrupted, it is not run again.
+    if (signum == 0) {
+        (*job)();
+    }
+    delete job;
+}
+
+// Runs @c job on the binder's job queue, or right away if it can't be queued.
+static void queueBinderJob(AFB_ApiT api, std::shared_ptr<ILogger> logger, std::function<void()> job) {
+    auto queuedJob = new std::function<void()>(std::move(job));
+    if (afb_api_queue_job(api, runQueuedJob, queuedJob, nullptr, 0) < 0) {
+        logger->log(Level::WARNING, TAG, "Failed to queue job, running it right away.");
+        (*queuedJob)();
+        delete queuedJob;
+    }
+}
+
+// Trampoline from the binder's C callback to the completion of a probe.
+static void onProbeReply(
+    void* closure,
+    struct json_object* object,
+    const char* error,
+    const char* info,
+    AFB_ApiT api) {
+    auto done = static_cast<std::function<void(bool)>*>(closure);
+    // Any reply of the probed verb, even an error, shows the API is back.
+    (*done)(!error || UNAVAILABLE_ERRORS.find(error) == UNAVAILABLE_ERRORS.end());
+    delete done;
+}
+
 std::unique_ptr<AFBApiImpl> AFBApiImpl::create(AFB_ApiT api) {
     return std::unique_ptr<AFBApiImpl>(new AFBApiImpl(api));
 }
 
-AFBApiImpl::AFBApiImpl(AFB_ApiT api) : mApi(api), mLogger(Logger::create(api)) {
+AFBApiImpl::AFBApiImpl(AFB_ApiT api) :
+        mApi(api),
+        mLogger(Logger::create(api)),
+        mDefaultDeadline(std::chrono::milliseconds::zero()),
+        mExpiredCalls(0),
+        mInFlightCalls(std::make_shared<InFlightCalls>()),
+        mSharedCalls(0),
+        mBreakerPolicy({0, std::chrono::milliseconds::zero()}),
+        mCallStats(VerbStatsRegistry::create()),
+        mSlowCalls(SlowCallLog::create(SLOW_CALL_LOG_CAPACITY, DEFAULT_SLOW_CALL_THRESHOLD)),
+        mSkippedEventPushes(std::make_shared<std::atomic<uint64_t>>(0)),
+        mDeadlineTimer(DeadlineTimer::create()) {
 }
 
 AFBApiImpl::~AFBApiImpl() {
 }
 
 std::shared_ptr<IAFBApi::IAFBEvent> AFBApiImpl::createEvent(const std::string& eventName) {
-    return AFBEventImpl::create(mLogger, mApi, eventName);
+    return AFBEventImpl::create(mLogger, mApi, eventName, mSkippedEventPushes);
+}
+
+void AFBApiImpl::queueJob(std::function<void()> job) {
+    queueBinderJob(mApi, mLogger, std::move(job));
 }
 
 int AFBApiImpl::callSync(
     const std::string& api,
     const std::string& verb,
-    struct json_object* request,
-    struct json_object** result,
+    JsonHandle request,
+    JsonHandle& result,
     std::string& error,
     std::string& info) {
+    auto breaker = getBreaker(api);
+    if (breaker && !breaker->allowCall()) {
+        error = ERROR_UNAVAILABLE;
+        return -1;
+    }
+
+    auto sentAt = std::chrono::steady_clock::now();
+    auto stats = mCallStats->getVerbStats(api + "/" + verb);
+    struct json_object* resultObject = NULL;
     char* errorStr = NULL;
     char* infoStr = NULL;
-    int rc = AFB_ApiSync(mApi, api.c_str(), verb.c_str(), request, result, &errorStr, &infoStr);
+    int rc = AFB_ApiSync(mApi, api.c_str(), verb.c_str(), request.release(), &resultObject, &errorStr, &infoStr);
+    result.reset(resultObject);
+    recordCall(stats, mSlowCalls, api, verb, elapsedSince(sentAt), errorStr, infoStr);
+    reportOutcome(mLogger, api, breaker, errorStr);
 
     if (errorStr) {
         error = errorStr;
@@ -83,5 +205,339 @@ int AFBApiImpl::callSync(
     return rc;
 }
 
+/*
+ * State shared by an asynchronous call, its deadline and the binder's reply.
+ * Whichever of the reply and the deadline comes first completes the call.
+ */
+struct PendingCall {
+    PendingCall(const std::string& api, const std::string& verb, IAFBApi::CallCompletion completion) :
+            api(api),
+            verb(verb),
+            completion(completion),
+            completed(false),
+            timerId(0) {
+    }
+
+    // Claims the right to complete the call. Returns false if already completed.
+    bool claim() {
+        return !completed.exchange(true);
+    }
+
+    std::string api;
+    std::string verb;
+    IAFBApi::CallCompletion completion;
+    std::atomic<bool> completed;
+    DeadlineTimer::TimerId timerId;
+    std::weak_ptr<DeadlineTimer> deadlineTimer;
+    std::shared_ptr<CircuitBreaker> breaker;
+    std::shared_ptr<VerbStats> stats;
+    std::shared_ptr<SlowCallLog> slowCalls;
+};
+
+/*
+ * A call sent to the binder, shared by the identical calls made while it is
+ * in flight. Each of them keeps its own completion and deadline. A call that
+ * can't be shared has no key and isn't tracked with the calls in flight.
+ */
+struct InFlightCall {
+    InFlightCall(
+        const std::string& key,
+        std::weak_ptr<InFlightCalls> inFlightCalls,
+        std::shared_ptr<ILogger> logger,
+        std::shared_ptr<CircuitBreaker> breaker,
+        std::shared_ptr<VerbStats> stats,
+        std::shared_ptr<SlowCallLog> slowCalls) :
+            key(key),
+            inFlightCalls(inFlightCalls),
+            logger(logger),
+            breaker(breaker),
+            stats(stats),
+            slowCalls(slowCalls),
+            sentAt(std::chrono::steady_clock::now()) {
+    }
+
+    // Whether some of the calls sharing this one still wait for its reply.
+    bool isAwaited() const {
+        for (auto& waiter : waiters) {
+            if (!waiter->completed) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string key;
+    std::weak_ptr<InFlightCalls> inFlightCalls;
+    std::shared_ptr<ILogger> logger;
+    std::shared_ptr<CircuitBreaker> breaker;
+    std::shared_ptr<VerbStats> stats;
+    std::shared_ptr<SlowCallLog> slowCalls;
+    std::chrono::steady_clock::time_point sentAt;
+    // Guarded by the mutex of inFlightCalls.
+    std::vector<std::shared_ptr<PendingCall>> waiters;
+};
+
+// The calls in flight, by api, verb and request.
+struct InFlightCalls {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<InFlightCall>> calls;
+};
+
+// Returns the key under which identical calls are shared.
+static std::string getCallKey(const std::string& api, const std::string& verb, json_object* request) {
+    std::string key = api + "/" + verb + "/";
+    if (request) {
+        key += json_object_to_json_string_ext(request, JSON_C_TO_STRING_PLAIN);
+    }
+    return key;
+}
+
+// Trampoline from the binder's C callback to the completions of the calls sharing it.
+static void onAsyncCallReply(
+    void* closure,
+    struct json_object* object,
+    const char* error,
+    const char* info,
+    AFB_ApiT api) {
+    auto inFlightCall = static_cast<std::shared_ptr<InFlightCall>*>(closure);
+
+    // Calls made from now on are sent anew.
+    std::vector<std::shared_ptr<PendingCall>> waiters;
+    auto inFlightCalls = (*inFlightCall)->inFlightCalls.lock();
+    if (inFlightCalls) {
+        std::lock_guard<std::mutex> lock(inFlightCalls->mutex);
+        auto callIt = inFlightCalls->calls.find((*inFlightCall)->key);
+        if (callIt != inFlightCalls->calls.end() && callIt->second == *inFlightCall) {
+            inFlightCalls->calls.erase(callIt);
+        }
+        waiters.swap((*inFlightCall)->waiters);
+    } else {
+        waiters.swap((*inFlightCall)->waiters);
+    }
+
+    // Calls that expired meanwhile were already recorded and completed.
+    std::vector<std::shared_ptr<PendingCall>> awaited;
+    for (auto& pendingCall : waiters) {
+        if (pendingCall->claim()) {
+            awaited.push_back(pendingCall);
+        }
+    }
+
+    if (!waiters.empty()) {
+        auto& api = waiters.front()->api;
+        if (!awaited.empty()) {
+            recordCall(
+                (*inFlightCall)->stats,
+                (*inFlightCall)->slowCalls,
+                api,
+                waiters.front()->verb,
+                elapsedSince((*inFlightCall)->sentAt),
+                error,
+                info);
+        }
+        reportOutcome((*inFlightCall)->logger, api, (*inFlightCall)->breaker, error);
+    }
+
+    int rc = error ? -1 : 0;
+    for (auto& pendingCall : awaited) {
+        auto deadlineTimer = pendingCall->deadlineTimer.lock();
+        if (deadlineTimer) {
+            deadlineTimer->cancel(pendingCall->timerId);
+        }
+        pendingCall->completion(rc, object, error ? error : "", info ? info : "");
+    }
+    delete inFlightCall;
+}
+
+void AFBApiImpl::callAsync(
+    const std::string& api,
+    const std::string& verb,
+    JsonHandle request,
+    std::chrono::milliseconds deadline,
+    CallCompletion completion) {
+    auto breaker = getBreaker(api);
+    if (breaker && !breaker->allowCall()) {
+        // Completed from the binder's queue, like a reply, never from within callAsync.
+        if (completion) {
+            queueBinderJob(mApi, mLogger, [completion]() { completion(-1, nullptr, ERROR_UNAVAILABLE, ""); });
+        }
+        return;
+    }
+
+    auto stats = mCallStats->getVerbStats(api + "/" + verb);
+    auto pendingCall = std::make_shared<PendingCall>(api, verb, completion);
+    pendingCall->breaker = breaker;
+    pendingCall->stats = stats;
+    pendingCall->slowCalls = mSlowCalls;
+
+    deadline = getDeadline(api, deadline);
+    if (deadline > std::chrono::milliseconds::zero()) {
+        // The deadline only holds a weak reference, so that a call completed
+        // by its reply is released right away.
+        std::weak_ptr<PendingCall> weakPendingCall = pendingCall;
+        AFB_ApiT afbApi = mApi;
+        auto logger = mLogger;
+        auto expiredCalls = &mExpiredCalls;
+        pendingCall->deadlineTimer = mDeadlineTimer;
+        auto expire = [weakPendingCall, logger, expiredCalls, deadline]() {
+            auto pendingCall = weakPendingCall.lock();
+            if (!pendingCall || !pendingCall->claim()) {
+                return;
+            }
+
+            ++(*expiredCalls);
+            logger->log(Level::WARNING, TAG, "Call deadline expired: " + pendingCall->api + "/" + pendingCall->verb);
+            // Recorded as lasting the deadline, a reply arriving later isn't recorded.
+            recordCall(
+                pendingCall->stats,
+                pendingCall->slowCalls,
+                pendingCall->api,
+                pendingCall->verb,
+                deadline,
+                "timeout",
+                nullptr);
+            reportOutcome(logger, pendingCall->api, pendingCall->breaker, "timeout");
+            pendingCall->completion(-1, nullptr, "timeout", "");
+        };
+        pendingCall->timerId = mDeadlineTimer->schedule(deadline, [afbApi, logger, expire]() {
+            // The completion runs on a binder thread, not on the timer's.
+            queueBinderJob(afbApi, logger, expire);
+        });
+    }
+
+    // An identical call to an idempotent verb still awaited is shared rather than sent again.
+    std::shared_ptr<InFlightCall> inFlightCall;
+    if (SHAREABLE_VERBS.find(verb) == SHAREABLE_VERBS.end()) {
+        // Not tracked with the calls in flight, nothing can join it.
+        inFlightCall =
+            std::make_shared<InFlightCall>("", std::weak_ptr<InFlightCalls>(), mLogger, breaker, stats, mSlowCalls);
+        inFlightCall->waiters.push_back(pendingCall);
+    } else {
+        std::string key = getCallKey(api, verb, request.get());
+        std::lock_guard<std::mutex> lock(mInFlightCalls->mutex);
+        auto callIt = mInFlightCalls->calls.find(key);
+        if (callIt != mInFlightCalls->calls.end() && callIt->second->isAwaited()) {
+            callIt->second->waiters.push_back(pendingCall);
+            ++mSharedCalls;
+            return;
+        }
+
+        inFlightCall = std::make_shared<InFlightCall>(key, mInFlightCalls, mLogger, breaker, stats, mSlowCalls);
+        inFlightCall->waiters.push_back(pendingCall);
+        mInFlightCalls->calls[key] = inFlightCall;
+    }
+
+    AFB_ApiCall(
+        mApi,
+        api.c_str(),
+        verb.c_str(),
+        request.release(),
+        onAsyncCallReply,
+        new std::shared_ptr<InFlightCall>(inFlightCall));
+}
+
+void AFBApiImpl::setDefaultDeadline(std::chrono::milliseconds deadline) {
+    std::lock_guard<std::mutex> lock(mDeadlinesMutex);
+    mDefaultDeadline = deadline;
+}
+
+void AFBApiImpl::setDefaultDeadline(const std::string& api, std::chrono::milliseconds deadline) {
+    std::lock_guard<std::mutex> lock(mDeadlinesMutex);
+    mApiDeadlines[api] = deadline;
+}
+
+void AFBApiImpl::setBreakerPolicy(const BreakerPolicy& policy) {
+    std::lock_guard<std::mutex> lock(mBreakersMutex);
+    mBreakerPolicy = policy;
+    mBreakers.clear();
+}
+
+void AFBApiImpl::setBreakerProbe(const std::string& api, const std::string& verb) {
+    std::lock_guard<std::mutex> lock(mBreakersMutex);
+    mProbeVerbs[api] = verb;
+    mBreakers.erase(api);
+}
+
+json_object* AFBApiImpl::breakersToJson() {
+    std::lock_guard<std::mutex> lock(mBreakersMutex);
+    json_object* breakersJ = json_object_new_object();
+    for (auto& breaker : mBreakers) {
+        json_object_object_add(breakersJ, breaker.first.c_str(), breaker.second->toJson());
+    }
+    return breakersJ;
+}
+
+void AFBApiImpl::setSlowCallThreshold(std::chrono::milliseconds threshold) {
+    mSlowCalls->setThreshold(threshold);
+}
+
+json_object* AFBApiImpl::callStatsToJson() {
+    json_object* callStatsJ = mCallStats->toJson();
+    json_object_object_add(callStatsJ, JSON_ATTR_SLOW_CALLS.c_str(), mSlowCalls->toJson());
+    return callStatsJ;
+}
+
+void AFBApiImpl::resetCallStats() {
+    mCallStats->reset();
+    mSlowCalls->reset();
+}
+
+uint64_t AFBApiImpl::getExpiredCallCount() const {
+    return mExpiredCalls;
+}
+
+uint64_t AFBApiImpl::getSharedCallCount() const {
+    return mSharedCalls;
+}
+
+uint64_t AFBApiImpl::getSkippedEventPushCount() const {
+    return *mSkippedEventPushes;
+}
+
+std::shared_ptr<CircuitBreaker> AFBApiImpl::getBreaker(const std::string& api) {
+    std::lock_guard<std::mutex> lock(mBreakersMutex);
+    if (mBreakerPolicy.failureThreshold == 0) {
+        return nullptr;
+    }
+
+    auto breakerIt = mBreakers.find(api);
+    if (breakerIt != mBreakers.end()) {
+        return breakerIt->second;
+    }
+
+    CircuitBreaker::Probe probe;
+    auto probeVerbIt = mProbeVerbs.find(api);
+    if (probeVerbIt != mProbeVerbs.end()) {
+        AFB_ApiT afbApi = mApi;
+        auto logger = mLogger;
+        std::string verb = probeVerbIt->second;
+        // The breaker probes from the timer's thread, the call is made from a binder thread.
+        probe = [afbApi, logger, api, verb](std::function<void(bool)> done) {
+            queueBinderJob(afbApi, logger, [afbApi, api, verb, done]() {
+                AFB_ApiCall(
+                    afbApi, api.c_str(), verb.c_str(), nullptr, onProbeReply, new std::function<void(bool)>(done));
+            });
+        };
+    }
+
+    auto breaker = CircuitBreaker::create(mDeadlineTimer, mBreakerPolicy, probe);
+    mBreakers.emplace(api, breaker);
+    return breaker;
+}
+
+std::chrono::milliseconds AFBApiImpl::getDeadline(const std::string& api, std::chrono::milliseconds deadline) {
+    if (deadline > std::chrono::milliseconds::zero()) {
+        return deadline;
+    }
+
+    std::lock_guard<std::mutex> lock(mDeadlinesMutex);
+    auto apiDeadlineIt = mApiDeadlines.find(api);
+    if (apiDeadlineIt != mApiDeadlines.end()) {
+        return apiDeadlineIt->second;
+    }
+
+    return mDefaultDeadline;
+}
+
 }  // namespace afb
 }  // namespace vshl
@@ -15,7 +15,13 @@
 #ifndef VSHL_AFB_AFBAPIIMPL_H_
 #define VSHL_AFB_AFBAPIIMPL_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 extern "C" {
 #include "ctl-plugin.h"
@@ -23,12 +29,18 @@ extern "C" {
 
 #include "interfaces/afb/IAFBApi.h"
 #include "interfaces/utilities/logging/ILogger.h"
+#include "utilities/health/CircuitBreaker.h"
+#include "utilities/stats/SlowCallLog.h"
+#include "utilities/stats/VerbStatsRegistry.h"
+#include "utilities/timer/DeadlineTimer.h"
 
 using namespace std;
 
 namespace vshl {
 namespace afb {
 
+struct InFlightCalls;
+
 class AFBApiImpl : public vshl::common::interfaces::IAFBApi {
 public:
     static std::unique_ptr<AFBApiImpl> create(AFB_ApiT api);
@@ -40,19 +52,122 @@ public:
     int callSync(
         const std::string& api,
         const std::string& verb,
-        struct json_object* request,
-        struct json_object** result,
+        vshl::utilities::json::JsonHandle request,
+        vshl::utilities::json::JsonHandle& result,
         std::string& error,
         std::string& info) override;
 
+    // Identical calls to an idempotent verb, to the same api and verb with
+    // the same request, made while one is in flight share its reply instead
+    // of being sent again. Calls to other verbs are always sent.
+    void callAsync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        std::chrono::milliseconds deadline,
+        CallCompletion completion) override;
+
+    using IAFBApi::callAsync;
+
+    void queueJob(std::function<void()> job) override;
+
+    // Sets the deadline of calls to APIs without a default of their own.
+    // Zero, the initial value, means no deadline.
+    void setDefaultDeadline(std::chrono::milliseconds deadline);
+
+    // Sets the default deadline of calls to @c api.
+    void setDefaultDeadline(const std::string& api, std::chrono::milliseconds deadline);
+
+    // Sets when the circuit breakers of the called APIs open, and for how
+    // long. A zero failure threshold, the initial value, disables them.
+    void setBreakerPolicy(const vshl::utilities::health::BreakerPolicy& policy);
+
+    // Probes @c api with @c verb in the background while its breaker is open.
+    // Without a probe verb, the first call made once open is the probe.
+    void setBreakerProbe(const std::string& api, const std::string& verb);
+
+    // Returns the state of the breaker of each called API as a new json object.
+    json_object* breakersToJson();
+
+    // Calls at least this slow are kept in the slow call log.
+    void setSlowCallThreshold(std::chrono::milliseconds threshold);
+
+    /**
+     * Returns the latency of the calls made, per api and verb, and the most
+     * recent slow calls as a new json object:
+     * { "elapsed_ms": ..., "verbs": { "<api>/<verb>": { ... }, ... },
+     *   "slow_calls": [ ... ] }
+     */
+    json_object* callStatsToJson();
+
+    // Clears the call latencies and the slow call log.
+    void resetCallStats();
+
+    // Returns the number of calls abandoned on their deadline.
+    uint64_t getExpiredCallCount() const;
+
+    // Returns the number of asynchronous calls that shared an identical call in flight.
+    uint64_t getSharedCallCount() const;
+
+    // Returns the number of event pushes skipped because nobody subscribed.
+    uint64_t getSkippedEventPushCount() const;
+
 private:
     AFBApiImpl(AFB_ApiT api);
 
+    // Returns the circuit breaker of @c api, nullptr if breakers are disabled.
+    std::shared_ptr<vshl::utilities::health::CircuitBreaker> getBreaker(const std::string& api);
+
+    // Returns the deadline to use for a call to @c api.
+    std::chrono::milliseconds getDeadline(const std::string& api, std::chrono::milliseconds deadline);
+
     // AFB API Binding
     AFB_ApiT mApi;
 
     // Logger
     std::shared_ptr<vshl::common::interfaces::ILogger> mLogger;
+
+    // Guards the default deadlines.
+    std::mutex mDeadlinesMutex;
+
+    // Deadline of calls to APIs without a default of their own.
+    std::chrono::milliseconds mDefaultDeadline;
+
+    // Default deadlines per API.
+    std::unordered_map<std::string, std::chrono::milliseconds> mApiDeadlines;
+
+    // Number of calls abandoned on their deadline.
+    std::atomic<uint64_t> mExpiredCalls;
+
+    // Asynchronous calls in flight, shared with the identical calls made meanwhile.
+    std::shared_ptr<InFlightCalls> mInFlightCalls;
+
+    // Number of calls that shared an identical call in flight.
+    std::atomic<uint64_t> mSharedCalls;
+
+    // Guards the circuit breakers.
+    std::mutex mBreakersMutex;
+
+    // Policy of the circuit breakers.
+    vshl::utilities::health::BreakerPolicy mBreakerPolicy;
+
+    // Probe verb per API.
+    std::unordered_map<std::string, std::string> mProbeVerbs;
+
+    // Circuit breaker per called API, made on first call.
+    std::unordered_map<std::string, std::shared_ptr<vshl::utilities::health::CircuitBreaker>> mBreakers;
+
+    // Latency of the calls made, per api and verb.
+    std::unique_ptr<vshl::utilities::stats::VerbStatsRegistry> mCallStats;
+
+    // Most recent slow calls.
+    std::shared_ptr<vshl::utilities::stats::SlowCallLog> mSlowCalls;
+
+    // Number of event pushes skipped by the events made by this API.
+    std::shared_ptr<std::atomic<uint64_t>> mSkippedEventPushes;
+
+    // Expires the calls that have a deadline.
+    std::shared_ptr<vshl::utilities::timer::DeadlineTimer> mDeadlineTimer;
 };
 
 }  // namespace afb
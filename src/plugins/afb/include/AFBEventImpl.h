@@ -15,6 +15,8 @@
 #ifndef VSHL_AFB_EVENT_H_
 #define VSHL_AFB_EVENT_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -35,9 +37,13 @@ namespace afb {
  */
 class AFBEventImpl : public vshl::common::interfaces::IAFBApi::IAFBEvent {
 public:
+  // The AFB event is made right away, so that neither the first subscribe
+  // nor the first publish pays for it. @c skippedPushes is incremented for
+  // every push skipped because the event had no subscribers.
   static unique_ptr<AFBEventImpl>
   create(shared_ptr<vshl::common::interfaces::ILogger> logger, AFB_ApiT api,
-         const string &eventName);
+         const string &eventName,
+         shared_ptr<atomic<uint64_t>> skippedPushes = nullptr);
 
   // Destructor
   ~AFBEventImpl();
@@ -45,18 +51,19 @@ public:
   /// { @c IAFBEvent implementation
   string getName() const override;
   bool isValid() override;
-  int publishEvent(struct json_object *payload) override;
+  int publishEvent(vshl::utilities::json::JsonHandle payload) override;
+  bool hasSubscribers() override;
   bool subscribe(vshl::common::interfaces::IAFBRequest &request) override;
   bool unsubscribe(vshl::common::interfaces::IAFBRequest &request) override;
   /// @c IAFBEvent implementation }
 
 private:
   AFBEventImpl(shared_ptr<vshl::common::interfaces::ILogger> logger,
-               AFB_ApiT api, const string &eventName);
+               AFB_ApiT api, const string &eventName,
+               shared_ptr<atomic<uint64_t>> skippedPushes);
 
-  // Make the event. This is a lazy make that happens
-  // usually during the subscribe stage.
-  void makeEventIfNeccessary();
+  // Make the AFB event.
+  void makeEvent();
 
   // Binding API reference
   AFB_ApiT mAfbApi;
@@ -67,6 +74,17 @@ private:
   // Event Name
   string mEventName;
 
+  // Whether the event may have subscribers, in the lowest bit, and the number
+  // of successful subscribes, in the others. The flag is set by a subscribe
+  // and cleared when a push reaches nobody, unless a subscribe happened since
+  // the push started. Unsubscribing leaves it alone, the binder doesn't tell
+  // whether other subscribers remain, and neither does a client going away,
+  // so the next push finds out.
+  atomic<uint64_t> mSubscriberState;
+
+  // Number of pushes skipped for lack of subscribers, shared by all events.
+  shared_ptr<atomic<uint64_t>> mSkippedPushes;
+
   // Logger
   shared_ptr<vshl::common::interfaces::ILogger> mLogger;
 };
@@ -16,6 +16,12 @@
 
 static string TAG = "vshl::afb::Event";
 
+// Bit of the subscriber state telling whether the event may have subscribers.
+static const uint64_t HAS_SUBSCRIBERS = 1;
+
+// Increment of the subscriber state for each subscribe, above the flag.
+static const uint64_t SUBSCRIBE_COUNT_UNIT = 2;
+
 using Level = vshl::common::interfaces::ILogger::Level;
 using namespace vshl::common::interfaces;
 
@@ -25,21 +31,30 @@ namespace afb {
 unique_ptr<AFBEventImpl> AFBEventImpl::create(
     shared_ptr<vshl::common::interfaces::ILogger> logger,
     AFB_ApiT api,
-    const string& eventName) {
-    return unique_ptr<AFBEventImpl>(new AFBEventImpl(logger, api, eventName));
+    const string& eventName,
+    shared_ptr<atomic<uint64_t>> skippedPushes) {
+    auto event = unique_ptr<AFBEventImpl>(new AFBEventImpl(logger, api, eventName, skippedPushes));
+    event->makeEvent();
+    return event;
 }
 
 AFBEventImpl::AFBEventImpl(
     shared_ptr<vshl::common::interfaces::ILogger> logger,
     AFB_ApiT api,
-    const string& eventName) :
+    const string& eventName,
+    shared_ptr<atomic<uint64_t>> skippedPushes) :
         mLogger(logger),
         mAfbApi(api),
         mEventName(eventName),
-        mAfbEvent(nullptr) {
+        mAfbEvent(nullptr),
+        mSubscriberState(0),
+        mSkippedPushes(skippedPushes) {
 }
 
 AFBEventImpl::~AFBEventImpl() {
+    if (mAfbEvent) {
+        afb_event_unref(mAfbEvent);
+    }
 }
 
 string AFBEventImpl::getName() const {
@@ -47,14 +62,17 @@ string AFBEventImpl::getName() const {
 }
 
 bool AFBEventImpl::isValid() {
-    makeEventIfNeccessary();
     return afb_event_is_valid(mAfbEvent) == 1 ? true : false;
 }
 
 bool AFBEventImpl::subscribe(IAFBRequest& requestInterface) {
-    makeEventIfNeccessary();
     auto request = static_cast<AFB_ReqT>(requestInterface.getNativeRequest());
     if (isValid() && afb_req_subscribe(request, mAfbEvent) == 0) {
+        // Counting the subscribe keeps a push that started before it and
+        // reached nobody from clearing the flag.
+        uint64_t state = mSubscriberState.load();
+        while (!mSubscriberState.compare_exchange_weak(state, (state | HAS_SUBSCRIBERS) + SUBSCRIBE_COUNT_UNIT)) {
+        }
         return true;
     }
 
@@ -62,7 +80,6 @@ bool AFBEventImpl::subscribe(IAFBRequest& requestInterface) {
 }
 
 bool AFBEventImpl::unsubscribe(IAFBRequest& requestInterface) {
-    makeEventIfNeccessary();
     auto request = static_cast<AFB_ReqT>(requestInterface.getNativeRequest());
     if (isValid() && afb_req_unsubscribe(request, mAfbEvent) == 0) {
         return true;
@@ -71,18 +88,41 @@ bool AFBEventImpl::unsubscribe(IAFBRequest& requestInterface) {
     return false;
 }
 
-int AFBEventImpl::publishEvent(struct json_object* payload) {
-    makeEventIfNeccessary();
-    return afb_event_push(mAfbEvent, payload);
+bool AFBEventImpl::hasSubscribers() {
+    if (mSubscriberState.load() & HAS_SUBSCRIBERS) {
+        return true;
+    }
+
+    if (mSkippedPushes) {
+        ++(*mSkippedPushes);
+    }
+    return false;
 }
 
-void AFBEventImpl::makeEventIfNeccessary() {
-    if (mAfbEvent) {
-        return;
+int AFBEventImpl::publishEvent(vshl::utilities::json::JsonHandle payload) {
+    uint64_t state = mSubscriberState.load();
+    if (!(state & HAS_SUBSCRIBERS)) {
+        // Nobody listens, the payload is dropped without pushing the event.
+        if (mSkippedPushes) {
+            ++(*mSkippedPushes);
+        }
+        return 0;
+    }
+
+    int receivers = afb_event_push(mAfbEvent, payload.release());
+    if (receivers == 0) {
+        // Fails, leaving the flag set, if someone subscribed during the push.
+        mSubscriberState.compare_exchange_strong(state, state & ~HAS_SUBSCRIBERS);
     }
 
-    mLogger->log(Level::NOTICE, TAG, "Creating VSHL event: " + mEventName);
+    return receivers;
+}
+
+void AFBEventImpl::makeEvent() {
     mAfbEvent = afb_api_make_event(mAfbApi, mEventName.c_str());
+    if (afb_event_is_valid(mAfbEvent) != 1) {
+        mLogger->log(Level::ERROR, TAG, "Failed to create VSHL event: " + mEventName);
+    }
 }
 
 }  // namespace afb
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <malloc.h>
+
+#include <future>
+
+#include "afb/AFBApiImpl.h"
+#include "afb/AFBRequestImpl.h"
+#include "bench/fakes/FakeBinder.h"
+#include "utilities/json/JsonHandle.h"
+
+using namespace vshl::afb;
+using namespace vshl::common::interfaces;
+using namespace vshl::bench::fakes;
+using namespace vshl::utilities::json;
+
+namespace vshl {
+namespace test {
+
+// Calls made before measuring, so that lazily allocated state is in place.
+static const int WARMUP_CALL_COUNT = 1000;
+
+// Calls measured.
+static const int SOAK_CALL_COUNT = 10000;
+
+// Smallest chunk the allocator hands out, on 64 bit glibc. An allocation
+// leaked by every call grows the heap by at least this much per call.
+static const int64_t MIN_CHUNK_BYTES = 32;
+
+// Heap growth allowed per call, in bytes. Half of the smallest chunk, so that
+// one allocation leaked by most of the calls exceeds it, while the noise of
+// the allocator caches, which doesn't grow with the number of calls, doesn't.
+// Leaking a json_object_new_int, the smallest object json-c makes, on each of
+// SOAK_CALL_COUNT calls grows the heap by more than this bound allows.
+static const int64_t MAX_HEAP_GROWTH_PER_CALL = MIN_CHUNK_BYTES / 2;
+
+static std::string TARGET_API = "voiceagent";
+static std::string TARGET_VERB = "startListening";
+
+// Bytes of heap in use, over all the arenas.
+static int64_t getHeapInUse() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    return static_cast<int64_t>(mallinfo2().uordblks);
+#else
+    return static_cast<int64_t>(mallinfo().uordblks);
+#endif
+}
+
+// Request shaped like the ones sent to the voiceagents.
+static JsonHandle createRequest() {
+    return JsonHandle(json_tokener_parse(
+        "{\"request_id\":\"VA-001-42\",\"options\":{\"wakeword\":\"alexa\",\"levels\":[1,2,3]}}"));
+}
+
+// Replies a nested object, like the voiceagents do.
+static int replyNestedObject(json_object* args, json_object** result, std::string& error) {
+    *result = json_tokener_parse(
+        "{\"state\":\"LISTENING\",\"dialog\":{\"id\":\"42\",\"items\":[{\"text\":\"sunny\"},{\"text\":\"cloudy\"}]}}");
+    return 0;
+}
+
+/*
+ * Verifies that the objects crossing IAFBApi are released, by checking that
+ * neither the live JsonHandles nor the heap grow over many calls.
+ */
+class AFBApiImplSoakTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mBinder = FakeBinder::create("vshl", 1);
+        mBinder->setTarget(TARGET_API, TARGET_VERB, replyNestedObject);
+        mAfbApi = AFBApiImpl::create(mBinder->getApi());
+    }
+
+    void TearDown() override {
+        mAfbApi.reset();
+        mBinder.reset();
+    }
+
+    void callSyncRepeatedly(int count) {
+        for (int idx = 0; idx < count; ++idx) {
+            JsonHandle result;
+            std::string error, info;
+            ASSERT_EQ(mAfbApi->callSync(TARGET_API, TARGET_VERB, createRequest(), result, error, info), 0);
+            ASSERT_TRUE(result);
+        }
+    }
+
+    void callAsyncRepeatedly(int count) {
+        for (int idx = 0; idx < count; ++idx) {
+            std::promise<int> done;
+            mAfbApi->callAsync(
+                TARGET_API,
+                TARGET_VERB,
+                createRequest(),
+                [&done](int rc, json_object* result, const std::string& error, const std::string& info) {
+                    done.set_value(rc);
+                });
+            ASSERT_EQ(done.get_future().get(), 0);
+        }
+        // The result is released after the completion returned.
+        mBinder->waitUntilIdle();
+    }
+
+    void publishRepeatedly(std::shared_ptr<IAFBApi::IAFBEvent> event, int count) {
+        for (int idx = 0; idx < count; ++idx) {
+            event->publishEvent(createRequest());
+        }
+    }
+
+    std::unique_ptr<FakeBinder> mBinder;
+    std::unique_ptr<AFBApiImpl> mAfbApi;
+};
+
+TEST_F(AFBApiImplSoakTest, callSyncReleasesRequestAndResult) {
+    callSyncRepeatedly(WARMUP_CALL_COUNT);
+
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    int64_t heapInUse = getHeapInUse();
+    callSyncRepeatedly(SOAK_CALL_COUNT);
+
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles);
+    ASSERT_LT(getHeapInUse() - heapInUse, SOAK_CALL_COUNT * MAX_HEAP_GROWTH_PER_CALL);
+}
+
+TEST_F(AFBApiImplSoakTest, callAsyncReleasesRequestAndResult) {
+    callAsyncRepeatedly(WARMUP_CALL_COUNT);
+
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    int64_t heapInUse = getHeapInUse();
+    callAsyncRepeatedly(SOAK_CALL_COUNT);
+
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles);
+    ASSERT_LT(getHeapInUse() - heapInUse, SOAK_CALL_COUNT * MAX_HEAP_GROWTH_PER_CALL);
+}
+
+TEST_F(AFBApiImplSoakTest, publishEventReleasesPayload) {
+    // A subscriber, otherwise the pushes are skipped and never release a payload.
+    auto event = mAfbApi->createEvent("DialogStateEvent");
+    mBinder->withRequest(1, [&event](afb_req_t request) {
+        ASSERT_TRUE(event->subscribe(*AFBRequestImpl::create(request)));
+    });
+    publishRepeatedly(event, WARMUP_CALL_COUNT);
+
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    int64_t heapInUse = getHeapInUse();
+    publishRepeatedly(event, SOAK_CALL_COUNT);
+
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles);
+    ASSERT_LT(getHeapInUse() - heapInUse, SOAK_CALL_COUNT * MAX_HEAP_GROWTH_PER_CALL);
+    ASSERT_EQ(
+        mBinder->getDeliveryCount("vshl/DialogStateEvent"), static_cast<uint64_t>(WARMUP_CALL_COUNT + SOAK_CALL_COUNT));
+    ASSERT_EQ(mAfbApi->getSkippedEventPushCount(), 0u);
+}
+
+}  // namespace test
+}  // namespace vshl
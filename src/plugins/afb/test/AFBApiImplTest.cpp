@@ -0,0 +1,261 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "afb/AFBApiImpl.h"
+#include "bench/fakes/FakeBinder.h"
+#include "utilities/json/JsonHelpers.h"
+
+using namespace vshl::afb;
+using namespace vshl::bench::fakes;
+using namespace vshl::common::interfaces;
+using namespace vshl::utilities::json;
+
+namespace vshl {
+namespace test {
+
+static std::string TARGET_API = "voiceagent";
+static std::string TARGET_VERB = "subscribe";
+
+class AFBApiImplTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mBinder = FakeBinder::create("vshl", 2);
+        mBinder->setTarget(TARGET_API, TARGET_VERB, [](json_object* args, json_object** result, std::string& error) {
+            *result = json_object_new_object();
+            addString(*result, "status", "subscribed");
+            return 0;
+        });
+        // Long enough for the calls made meanwhile to find the first one in flight.
+        mBinder->setTargetLatency(TARGET_API, std::chrono::milliseconds(100));
+        mAfbApi = AFBApiImpl::create(mBinder->getApi());
+    }
+
+    void TearDown() override {
+        mAfbApi.reset();
+        mBinder.reset();
+    }
+
+    // Makes one call per request, empty for none, and waits for all of their completions.
+    std::vector<std::string> callAsync(const std::vector<std::string>& requests) {
+        std::mutex statusesMutex;
+        std::vector<std::string> statuses;
+        std::vector<std::promise<void>> done(requests.size());
+
+        for (size_t idx = 0; idx < requests.size(); ++idx) {
+            JsonHandle request(requests[idx].empty() ? nullptr : json_object_new_string(requests[idx].c_str()));
+            auto promise = &done[idx];
+            mAfbApi->callAsync(
+                TARGET_API,
+                TARGET_VERB,
+                std::move(request),
+                [&statusesMutex, &statuses, promise](
+                    int rc, json_object* result, const std::string& error, const std::string& info) {
+                    std::string status;
+                    getString(result, "status", status);
+                    {
+                        std::lock_guard<std::mutex> lock(statusesMutex);
+                        statuses.push_back(rc == 0 ? status : error);
+                    }
+                    promise->set_value();
+                });
+        }
+
+        for (auto& promise : done) {
+            promise.get_future().wait();
+        }
+        return statuses;
+    }
+
+    std::unique_ptr<FakeBinder> mBinder;
+    std::unique_ptr<AFBApiImpl> mAfbApi;
+};
+
+TEST_F(AFBApiImplTest, identicalCallsInFlightShareOneCall) {
+    auto statuses = callAsync({"", "", ""});
+
+    ASSERT_EQ(statuses, std::vector<std::string>({"subscribed", "subscribed", "subscribed"}));
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 1);
+    ASSERT_EQ(mAfbApi->getSharedCallCount(), 2);
+}
+
+TEST_F(AFBApiImplTest, callsToVerbsNotKnownIdempotentAreNotShared) {
+    mBinder->setTarget(TARGET_API, "startListening", [](json_object* args, json_object** result, std::string& error) {
+        *result = json_object_new_object();
+        addString(*result, "status", "listening");
+        return 0;
+    });
+
+    std::vector<std::promise<void>> done(3);
+    for (auto& promise : done) {
+        auto donePromise = &promise;
+        mAfbApi->callAsync(
+            TARGET_API,
+            "startListening",
+            JsonHandle(),
+            [donePromise](int rc, json_object* result, const std::string& error, const std::string& info) {
+                donePromise->set_value();
+            });
+    }
+    for (auto& promise : done) {
+        promise.get_future().wait();
+    }
+
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, "startListening"), 3);
+    ASSERT_EQ(mAfbApi->getSharedCallCount(), 0);
+}
+
+TEST_F(AFBApiImplTest, callsWithDifferentRequestsAreNotShared) {
+    auto statuses = callAsync({"VA-001", "VA-002", "VA-001"});
+
+    ASSERT_EQ(statuses.size(), 3);
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 2);
+    ASSERT_EQ(mAfbApi->getSharedCallCount(), 1);
+}
+
+TEST_F(AFBApiImplTest, callAfterReplyIsSentAgain) {
+    callAsync({""});
+    callAsync({""});
+
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 2);
+    ASSERT_EQ(mAfbApi->getSharedCallCount(), 0);
+}
+
+TEST_F(AFBApiImplTest, expiredCallsAreNotShared) {
+    mAfbApi->setDefaultDeadline(TARGET_API, std::chrono::milliseconds(10));
+    auto statuses = callAsync({""});
+    ASSERT_EQ(statuses, std::vector<std::string>({"timeout"}));
+
+    // The first call is still in flight, but nobody waits for it anymore.
+    mAfbApi->setDefaultDeadline(TARGET_API, std::chrono::milliseconds::zero());
+    statuses = callAsync({""});
+
+    ASSERT_EQ(statuses, std::vector<std::string>({"subscribed"}));
+    ASSERT_EQ(mAfbApi->getSharedCallCount(), 0);
+    mBinder->waitUntilIdle();
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 2);
+}
+
+TEST_F(AFBApiImplTest, expiredCallsAreRecordedAsFailuresLastingTheDeadline) {
+    mAfbApi->setDefaultDeadline(TARGET_API, std::chrono::milliseconds(10));
+    mAfbApi->setSlowCallThreshold(std::chrono::milliseconds(5));
+    ASSERT_EQ(callAsync({"first", "second"}), std::vector<std::string>({"timeout", "timeout"}));
+    // The late replies are not recorded.
+    mBinder->waitUntilIdle();
+
+    json_object* callStatsJ = mAfbApi->callStatsToJson();
+    json_object* verbStatsJ = getMember(getMember(callStatsJ, "verbs"), TARGET_API + "/" + TARGET_VERB);
+    int64_t calls = 0, failures = 0;
+    ASSERT_TRUE(getInt64(verbStatsJ, "calls", calls));
+    ASSERT_TRUE(getInt64(verbStatsJ, "failures", failures));
+    ASSERT_EQ(calls, 2);
+    ASSERT_EQ(failures, 2);
+
+    json_object* slowCallsJ = getMember(callStatsJ, "slow_calls", json_type_array);
+    ASSERT_EQ(json_object_array_length(slowCallsJ), 2);
+    for (size_t idx = 0; idx < 2; ++idx) {
+        int64_t durationUs = 0;
+        std::string slowCallError;
+        ASSERT_TRUE(getInt64(json_object_array_get_idx(slowCallsJ, idx), "duration_us", durationUs));
+        ASSERT_TRUE(getString(json_object_array_get_idx(slowCallsJ, idx), "error", slowCallError));
+        ASSERT_EQ(durationUs, 10000);
+        ASSERT_EQ(slowCallError, "timeout");
+    }
+    json_object_put(callStatsJ);
+}
+
+TEST_F(AFBApiImplTest, callsToUnavailableApiFailFast) {
+    mBinder->setTarget(TARGET_API, TARGET_VERB, [](json_object* args, json_object** result, std::string& error) {
+        error = "disconnected";
+        return -1;
+    });
+    mAfbApi->setBreakerPolicy({2, std::chrono::milliseconds(60000)});
+
+    ASSERT_EQ(callAsync({"VA-001", "VA-002"}), std::vector<std::string>({"disconnected", "disconnected"}));
+    ASSERT_EQ(callAsync({"VA-001"}), std::vector<std::string>({"unavailable"}));
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 2);
+
+    json_object* breakersJ = mAfbApi->breakersToJson();
+    std::string state;
+    getString(getMember(breakersJ, TARGET_API), "state", state);
+    ASSERT_EQ(state, "open");
+    json_object_put(breakersJ);
+}
+
+TEST_F(AFBApiImplTest, callsFailedFastCompleteOffTheCallingThread) {
+    mBinder->setTarget(TARGET_API, TARGET_VERB, [](json_object* args, json_object** result, std::string& error) {
+        error = "disconnected";
+        return -1;
+    });
+    mAfbApi->setBreakerPolicy({1, std::chrono::milliseconds(60000)});
+    ASSERT_EQ(callAsync({"VA-001"}), std::vector<std::string>({"disconnected"}));
+
+    std::promise<std::thread::id> completedOn;
+    mAfbApi->callAsync(
+        TARGET_API,
+        TARGET_VERB,
+        JsonHandle(),
+        [&completedOn](int rc, json_object* result, const std::string& error, const std::string& info) {
+            completedOn.set_value(std::this_thread::get_id());
+        });
+
+    ASSERT_NE(completedOn.get_future().get(), std::this_thread::get_id());
+}
+
+TEST_F(AFBApiImplTest, verbErrorsDoNotOpenBreaker) {
+    mBinder->setTarget(TARGET_API, TARGET_VERB, [](json_object* args, json_object** result, std::string& error) {
+        error = "invalid-request";
+        return -1;
+    });
+    mAfbApi->setBreakerPolicy({1, std::chrono::milliseconds(60000)});
+
+    ASSERT_EQ(callAsync({"VA-001"}), std::vector<std::string>({"invalid-request"}));
+    ASSERT_EQ(callAsync({"VA-001"}), std::vector<std::string>({"invalid-request"}));
+    ASSERT_EQ(mBinder->getCallCount(TARGET_API, TARGET_VERB), 2);
+}
+
+TEST_F(AFBApiImplTest, recordsLatencyOfCallsAndSlowCalls) {
+    mAfbApi->setSlowCallThreshold(std::chrono::milliseconds(50));
+    callAsync({"VA-001", "VA-002"});
+
+    mBinder->setTargetLatency(TARGET_API, std::chrono::milliseconds::zero());
+    callAsync({"VA-003"});
+
+    json_object* callStatsJ = mAfbApi->callStatsToJson();
+    json_object* verbStatsJ = getMember(getMember(callStatsJ, "verbs"), TARGET_API + "/" + TARGET_VERB);
+    int64_t calls = 0;
+    ASSERT_TRUE(getInt64(verbStatsJ, "calls", calls));
+    ASSERT_EQ(calls, 3);
+
+    json_object* slowCallsJ = getMember(callStatsJ, "slow_calls", json_type_array);
+    ASSERT_EQ(json_object_array_length(slowCallsJ), 2);
+    int64_t durationUs = 0;
+    ASSERT_TRUE(getInt64(json_object_array_get_idx(slowCallsJ, 0), "duration_us", durationUs));
+    ASSERT_GE(durationUs, 100000);
+    json_object_put(callStatsJ);
+
+    mAfbApi->resetCallStats();
+    callStatsJ = mAfbApi->callStatsToJson();
+    ASSERT_EQ(json_object_array_length(getMember(callStatsJ, "slow_calls")), 0);
+    json_object_put(callStatsJ);
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "afb/AFBRequestImpl.h"
+#include "afb/include/AFBEventImpl.h"
+#include "bench/fakes/FakeBinder.h"
+#include "utilities/json/JsonHandle.h"
+#include "utilities/logging/Logger.h"
+
+using namespace vshl::afb;
+using namespace vshl::bench::fakes;
+using namespace vshl::utilities::json;
+using namespace vshl::utilities::logging;
+
+namespace vshl {
+namespace test {
+
+static std::string EVENT_NAME = "DialogStateEvent";
+
+// Name the binder pushes the event under, prefixed with the api.
+static std::string PUSHED_EVENT_NAME = "vshl/" + EVENT_NAME;
+
+class AFBEventImplTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mBinder = FakeBinder::create("vshl", 1);
+        mSkippedPushes = std::make_shared<std::atomic<uint64_t>>(0);
+        mEvent = AFBEventImpl::create(Logger::create(mBinder->getApi()), mBinder->getApi(), EVENT_NAME, mSkippedPushes);
+    }
+
+    void TearDown() override {
+        mEvent.reset();
+        mBinder.reset();
+    }
+
+    bool subscribe(int clientId) {
+        bool subscribed = false;
+        mBinder->withRequest(clientId, [this, &subscribed](afb_req_t request) {
+            subscribed = mEvent->subscribe(*AFBRequestImpl::create(request));
+        });
+        return subscribed;
+    }
+
+    bool unsubscribe(int clientId) {
+        bool unsubscribed = false;
+        mBinder->withRequest(clientId, [this, &unsubscribed](afb_req_t request) {
+            unsubscribed = mEvent->unsubscribe(*AFBRequestImpl::create(request));
+        });
+        return unsubscribed;
+    }
+
+    int publish() {
+        return mEvent->publishEvent(JsonHandle(json_object_new_string("LISTENING")));
+    }
+
+    std::unique_ptr<FakeBinder> mBinder;
+    std::shared_ptr<std::atomic<uint64_t>> mSkippedPushes;
+    std::unique_ptr<AFBEventImpl> mEvent;
+};
+
+TEST_F(AFBEventImplTest, pushesAreSkippedUntilSomeoneSubscribes) {
+    ASSERT_TRUE(mEvent->isValid());
+    ASSERT_FALSE(mEvent->hasSubscribers());
+    ASSERT_EQ(publish(), 0);
+    ASSERT_EQ(mBinder->getPushCount(PUSHED_EVENT_NAME), 0);
+    ASSERT_EQ(*mSkippedPushes, 2);
+
+    ASSERT_TRUE(subscribe(1));
+    ASSERT_TRUE(mEvent->hasSubscribers());
+    ASSERT_EQ(publish(), 1);
+    ASSERT_EQ(mBinder->getPushCount(PUSHED_EVENT_NAME), 1);
+    ASSERT_EQ(mBinder->getDeliveryCount(PUSHED_EVENT_NAME), 1);
+    ASSERT_EQ(*mSkippedPushes, 2);
+}
+
+TEST_F(AFBEventImplTest, pushReachingNobodyClearsTheFlag) {
+    ASSERT_TRUE(subscribe(1));
+    ASSERT_TRUE(unsubscribe(1));
+
+    // Unsubscribing leaves the flag set, the next push finds out.
+    ASSERT_TRUE(mEvent->hasSubscribers());
+    ASSERT_EQ(publish(), 0);
+    ASSERT_EQ(mBinder->getPushCount(PUSHED_EVENT_NAME), 1);
+
+    ASSERT_FALSE(mEvent->hasSubscribers());
+    ASSERT_EQ(publish(), 0);
+    ASSERT_EQ(mBinder->getPushCount(PUSHED_EVENT_NAME), 1);
+    ASSERT_EQ(*mSkippedPushes, 2);
+}
+
+TEST_F(AFBEventImplTest, subscribeDuringPushReachingNobodyGetsTheNextPush) {
+    ASSERT_TRUE(subscribe(1));
+    ASSERT_TRUE(unsubscribe(1));
+
+    // The second client subscribes once the push counted no receivers, before it returns.
+    bool subscribed = false;
+    mBinder->setPushHook([this, &subscribed](const std::string& eventName, int receivers) {
+        if (!subscribed) {
+            subscribed = subscribe(2);
+        }
+    });
+    ASSERT_EQ(publish(), 0);
+    ASSERT_TRUE(subscribed);
+    mBinder->setPushHook(nullptr);
+
+    ASSERT_TRUE(mEvent->hasSubscribers());
+    ASSERT_EQ(publish(), 1);
+    ASSERT_EQ(mBinder->getDeliveryCount(PUSHED_EVENT_NAME), 1);
+    ASSERT_EQ(*mSkippedPushes, 0);
+}
+
+}  // namespace test
+}  // namespace vshl
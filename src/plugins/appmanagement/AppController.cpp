@@ -52,43 +52,73 @@ bool AppController::startApp(const string& name, const string& version) {
         return false;
     }
 
-    json_object* object = NULL;
-    std::string error, info;
-    int err = mAfbApi->callSync(START_APP_API, START_APP_VERB, json_object_new_string(appToStart.c_str()), &object, error, info);
-    if (object) {
-        free(object);
-    }
-    if (err) {
-        mLogger->log(Level::ERROR, TAG, "Failed to start app:" + appToStart);
-        return false;
-    }
-
+    callAppVerbAsync(START_APP_API, START_APP_VERB, appToStart, nullptr);
     mLogger->log(Level::INFO, TAG, "Starting app: " + appToStart);
     return true;
 }
 
 bool AppController::displayApp(const string& name, const string& version) {
-	string appToDisplay = name + "@" + version;
+    string appToDisplay = name + "@" + version;
     if (!mAfbApi) {
         mLogger->log(
             Level::ERROR, TAG, "Failed to display app: No AFB Api, app:" + name + ", version: " + version);
         return false;
     }
 
-    json_object* object = NULL;
-    std::string error, info;
-    int err = mAfbApi->callSync(DISPLAY_APP_API, DISPLAY_APP_VERB, json_object_new_string(appToDisplay.c_str()), &object, error, info);
-    if (object) {
-        free(object);
-    }
-    if (err) {
-        mLogger->log(Level::ERROR, TAG, "Failed to display app:" + appToDisplay);
+    callAppVerbAsync(DISPLAY_APP_API, DISPLAY_APP_VERB, appToDisplay, nullptr);
+    mLogger->log(Level::INFO, TAG, "Bringing app: " + appToDisplay + " to foreground.");
+    return true;
+}
+
+bool AppController::startAndDisplayApp(const string& name, const string& version) {
+    string app = name + "@" + version;
+    if (!mAfbApi) {
+        mLogger->log(
+            Level::ERROR, TAG, "Failed to start and display app: No AFB Api, app:" + name + ", version: " + version);
         return false;
     }
 
-    mLogger->log(Level::INFO, TAG, "Bringing app: " + appToDisplay + " to foreground.");
+    // The app is brought to the foreground only once it has been started.
+    auto afbApi = mAfbApi;
+    auto logger = mLogger;
+    callAppVerbAsync(START_APP_API, START_APP_VERB, app, [afbApi, logger, app]() {
+        logger->log(Level::INFO, TAG, "Bringing app: " + app + " to foreground.");
+        callAppVerbAsync(afbApi, logger, DISPLAY_APP_API, DISPLAY_APP_VERB, app, nullptr);
+    });
+    mLogger->log(Level::INFO, TAG, "Starting app: " + app);
     return true;
 }
 
+void AppController::callAppVerbAsync(
+    const string& api,
+    const string& verb,
+    const string& app,
+    function<void()> onSuccess) {
+    callAppVerbAsync(mAfbApi, mLogger, api, verb, app, onSuccess);
+}
+
+void AppController::callAppVerbAsync(
+    shared_ptr<vshl::common::interfaces::IAFBApi> afbApi,
+    shared_ptr<vshl::common::interfaces::ILogger> logger,
+    const string& api,
+    const string& verb,
+    const string& app,
+    function<void()> onSuccess) {
+    afbApi->callAsync(
+        api,
+        verb,
+        vshl::utilities::json::JsonHandle(json_object_new_string(app.c_str())),
+        [logger, api, verb, app, onSuccess](int rc, json_object* result, const string& error, const string& info) {
+            if (rc != 0) {
+                logger->log(Level::ERROR, TAG, "Failed to call " + api + "/" + verb + " for app:" + app + ", " + error);
+                return;
+            }
+
+            if (onSuccess) {
+                onSuccess();
+            }
+        });
+}
+
 }  // namespace appmanagement
 }  // namespace vshl
\ No newline at end of file
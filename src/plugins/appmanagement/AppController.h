@@ -16,6 +16,7 @@
 #ifndef VSHL_APPMANAGEMENT_APPCONTROLLER_H_
 #define VSHL_APPMANAGEMENT_APPCONTROLLER_H_
 
+#include <functional>
 #include <memory>
 
 #include "interfaces/afb/IAFBApi.h"
@@ -45,11 +46,25 @@ protected:
 
     bool displayApp(const string& name, const string& version) override;
 
+    bool startAndDisplayApp(const string& name, const string& version) override;
+
 private:
     AppController(
         shared_ptr<vshl::common::interfaces::ILogger> logger,
         shared_ptr<vshl::common::interfaces::IAFBApi> afbApi);
 
+    // Calls an app management verb for @c app without blocking on the reply.
+    // Failures are logged, @c onSuccess runs once the verb succeeded.
+    void callAppVerbAsync(const string& api, const string& verb, const string& app, function<void()> onSuccess);
+
+    static void callAppVerbAsync(
+        shared_ptr<vshl::common::interfaces::IAFBApi> afbApi,
+        shared_ptr<vshl::common::interfaces::ILogger> logger,
+        const string& api,
+        const string& verb,
+        const string& app,
+        function<void()> onSuccess);
+
     // Binding API reference
     shared_ptr<vshl::common::interfaces::IAFBApi> mAfbApi;
 
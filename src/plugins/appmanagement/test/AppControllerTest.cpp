@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "appmanagement/AppController.h"
+
+#include "test/common/ConsoleLogger.h"
+#include "test/mocks/AFBApiMock.h"
+
+using namespace vshl::appmanagement;
+using namespace vshl::common::interfaces;
+using namespace vshl::test::common;
+
+namespace vshl {
+namespace test {
+
+class AppControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mConsoleLogger = std::make_shared<ConsoleLogger>();
+        mAfbApi = std::make_shared<::testing::StrictMock<AFBApiMock>>();
+        mAppController = AppController::create(mConsoleLogger, mAfbApi);
+    }
+
+    std::shared_ptr<::testing::StrictMock<AFBApiMock>> mAfbApi;
+    std::shared_ptr<ConsoleLogger> mConsoleLogger;
+    std::shared_ptr<vshl::interfaces::appmanagement::IAppController> mAppController;
+};
+
+TEST_F(AppControllerTest, displaysAppOnceStarted) {
+    IAFBApi::CallCompletion startCompletion;
+    EXPECT_CALL(*mAfbApi, callAsync("afm-main", "once", ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::DoAll(
+            ::testing::WithArg<2>(::testing::Invoke(json_object_put)), ::testing::SaveArg<4>(&startCompletion)));
+
+    ASSERT_TRUE(mAppController->startAndDisplayApp("webapps-tbtnavi", "0.1"));
+    ASSERT_TRUE(startCompletion);
+
+    // Nothing is displayed before the start call completes.
+    json_object* displayRequest = nullptr;
+    EXPECT_CALL(*mAfbApi, callAsync("homescreen", "tap_shortcut", ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::SaveArg<2>(&displayRequest));
+    startCompletion(0, nullptr, "", "");
+
+    ASSERT_NE(displayRequest, nullptr);
+    ASSERT_STREQ(json_object_get_string(displayRequest), "webapps-tbtnavi@0.1");
+    json_object_put(displayRequest);
+}
+
+TEST_F(AppControllerTest, doesNotDisplayAppThatFailedToStart) {
+    IAFBApi::CallCompletion startCompletion;
+    EXPECT_CALL(*mAfbApi, callAsync("afm-main", "once", ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::DoAll(
+            ::testing::WithArg<2>(::testing::Invoke(json_object_put)), ::testing::SaveArg<4>(&startCompletion)));
+    EXPECT_CALL(*mAfbApi, callAsync("homescreen", "tap_shortcut", ::testing::_, ::testing::_, ::testing::_)).Times(0);
+
+    ASSERT_TRUE(mAppController->startAndDisplayApp("webapps-tbtnavi", "0.1"));
+    ASSERT_TRUE(startCompletion);
+    startCompletion(-1, nullptr, "not-found", "");
+}
+
+TEST_F(AppControllerTest, failsWithoutApi) {
+    std::shared_ptr<vshl::interfaces::appmanagement::IAppController> appController =
+        AppController::create(mConsoleLogger, nullptr);
+    ASSERT_FALSE(appController->startAndDisplayApp("webapps-tbtnavi", "0.1"));
+}
+
+}  // namespace test
+}  // namespace vshl
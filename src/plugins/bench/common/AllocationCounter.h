@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_BENCH_COMMON_ALLOCATIONCOUNTER_H_
+#define VSHL_BENCH_COMMON_ALLOCATIONCOUNTER_H_
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace vshl {
+namespace bench {
+namespace common {
+
+/**
+ * Heap allocation counting for benchmarks. Linking AllocationCounter.cpp
+ * interposes the allocator: malloc/calloc/realloc on glibc, which also covers
+ * operator new and json-c, and operator new elsewhere.
+ */
+
+// Number of heap allocations made by the process so far.
+uint64_t getAllocationCount();
+
+// Reports the allocations made since @c startCount as the "allocs/op" counter.
+void reportAllocations(benchmark::State& state, uint64_t startCount);
+
+}  // namespace common
+}  // namespace bench
+}  // namespace vshl
+
+#endif  // VSHL_BENCH_COMMON_ALLOCATIONCOUNTER_H_
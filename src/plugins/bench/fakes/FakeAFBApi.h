@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_BENCH_FAKES_FAKEAFBAPI_H_
+#define VSHL_BENCH_FAKES_FAKEAFBAPI_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <json-c/json.h>
+
+#include "interfaces/afb/IAFBApi.h"
+
+namespace vshl {
+namespace bench {
+namespace fakes {
+
+/*
+ * Minimal IAFBApi stand-ins for benchmarks. Unlike the gmock mocks they add
+ * no bookkeeping of their own, so measurements reflect the code under test.
+ */
+class FakeAFBRequest : public vshl::common::interfaces::IAFBRequest {
+public:
+    void* getNativeRequest() override {
+        return nullptr;
+    }
+};
+
+class FakeAFBEvent : public vshl::common::interfaces::IAFBApi::IAFBEvent {
+public:
+    FakeAFBEvent(const std::string& name) : mName(name), mSubscribers(0) {
+    }
+
+    std::string getName() const override {
+        return mName;
+    }
+
+    bool isValid() override {
+        return true;
+    }
+
+    // Drops the payload like afb_event_push does.
+    int publishEvent(vshl::utilities::json::JsonHandle payload) override {
+        return mSubscribers;
+    }
+
+    bool hasSubscribers() override {
+        return mSubscribers > 0;
+    }
+
+    bool subscribe(vshl::common::interfaces::IAFBRequest& request) override {
+        ++mSubscribers;
+        return true;
+    }
+
+    bool unsubscribe(vshl::common::interfaces::IAFBRequest& request) override {
+        --mSubscribers;
+        return true;
+    }
+
+private:
+    std::string mName;
+    std::atomic<int> mSubscribers;
+};
+
+class FakeAFBApi : public vshl::common::interfaces::IAFBApi {
+public:
+    std::shared_ptr<IAFBEvent> createEvent(const std::string& eventName) override {
+        return std::make_shared<FakeAFBEvent>(eventName);
+    }
+
+    // Replies immediately with an empty object.
+    int callSync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        vshl::utilities::json::JsonHandle& result,
+        std::string& error,
+        std::string& info) override {
+        result.reset();
+        return 0;
+    }
+
+    // Completes immediately, on the calling thread.
+    void callAsync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        std::chrono::milliseconds deadline,
+        CallCompletion completion) override {
+        completion(0, nullptr, "", "");
+    }
+
+    using IAFBApi::callAsync;
+
+    // Runs the job right away, on the calling thread.
+    void queueJob(std::function<void()> job) override {
+        job();
+    }
+};
+
+}  // namespace fakes
+}  // namespace bench
+}  // namespace vshl
+
+#endif  // VSHL_BENCH_FAKES_FAKEAFBAPI_H_
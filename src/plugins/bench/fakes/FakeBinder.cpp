@@ -0,0 +1,572 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "bench/fakes/FakeBinder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace vshl {
+namespace bench {
+namespace fakes {
+
+// Api handed to the plugin.
+struct FakeBinder::Api : afb_api_x3 {
+    FakeBinder* binder;
+};
+
+// Request handed to a verb, alive until the verb replied and released it.
+struct FakeBinder::Request : afb_req_x2 {
+    FakeBinder* binder;
+    int clientId;
+    std::atomic<int> refCount;
+
+    std::mutex replyMutex;
+    std::condition_variable replyCondition;
+    bool hasReply;
+    Reply reply;
+};
+
+// Event made by the plugin.
+struct FakeBinder::Event : afb_event_x2 {
+    FakeBinder* binder;
+    std::string name;
+    std::atomic<int> refCount;
+};
+
+FakeBinder::Reply::Reply() : object(nullptr) {
+}
+
+FakeBinder::Reply::~Reply() {
+    if (object) {
+        json_object_put(object);
+    }
+}
+
+bool FakeBinder::Reply::isSuccess() const {
+    return error.empty();
+}
+
+FakeBinder::TargetApi::TargetApi() : latency(std::chrono::microseconds::zero()) {
+}
+
+FakeBinder::EventCounts::EventCounts() : pushes(0), deliveries(0) {
+}
+
+std::unique_ptr<FakeBinder> FakeBinder::create(const std::string& apiName, size_t workerCount) {
+    return std::unique_ptr<FakeBinder>(new FakeBinder(apiName, workerCount));
+}
+
+FakeBinder::FakeBinder(const std::string& apiName, size_t workerCount) :
+        mApiName(apiName),
+        mApi(new Api()),
+        mSerialized(false),
+        mRunningJobs(0),
+        mStopped(false) {
+    mApi->itf = getApiInterface();
+    mApi->apiname = mApiName.c_str();
+    mApi->userdata = nullptr;
+    mApi->logmask = 0;
+    mApi->binder = this;
+
+    for (size_t workerIdx = 0; workerIdx < std::max<size_t>(workerCount, 1); ++workerIdx) {
+        mWorkers.emplace_back(&FakeBinder::runWorker, this);
+    }
+}
+
+FakeBinder::~FakeBinder() {
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        mStopped = true;
+        mJobs.clear();
+    }
+    mJobsCondition.notify_all();
+
+    for (auto& worker : mWorkers) {
+        worker.join();
+    }
+}
+
+afb_api_t FakeBinder::getApi() {
+    return mApi.get();
+}
+
+void FakeBinder::setLogging(bool enabled) {
+    mApi->logmask = enabled ? -1 : 0;
+}
+
+void FakeBinder::setTarget(const std::string& api, const std::string& verb, Target target) {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    mTargets[api].verbs[verb] = target;
+}
+
+void FakeBinder::setTargetLatency(const std::string& api, std::chrono::microseconds latency) {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    mTargets[api].latency = latency;
+}
+
+void FakeBinder::setPermissionGranted(const std::string& permission, bool granted) {
+    std::lock_guard<std::mutex> lock(mPermissionsMutex);
+    if (granted) {
+        mDeniedPermissions.erase(permission);
+    } else {
+        mDeniedPermissions.insert(permission);
+    }
+}
+
+void FakeBinder::setSerialized(bool serialized) {
+    mSerialized = serialized;
+}
+
+int FakeBinder::callAction(Verb action, json_object* argsJ, json_object* eventJ) {
+    CtlSourceT source;
+    memset(&source, 0, sizeof(source));
+    source.uid = mApiName.c_str();
+    source.api = getApi();
+
+    auto lock = lockPlugin();
+    return action(&source, argsJ, eventJ);
+}
+
+bool FakeBinder::callVerb(
+    Verb verb,
+    json_object* argsJ,
+    json_object* queryJ,
+    int clientId,
+    Reply& reply,
+    std::chrono::milliseconds timeout) {
+    auto request = createRequest(clientId);
+
+    CtlSourceT source;
+    memset(&source, 0, sizeof(source));
+    source.uid = mApiName.c_str();
+    source.api = getApi();
+    source.request = request;
+
+    {
+        auto lock = lockPlugin();
+        // Like the controller, a failed verb that didn't reply replies a failure.
+        if (verb(&source, argsJ, queryJ) != 0) {
+            std::lock_guard<std::mutex> replyLock(request->replyMutex);
+            if (!request->hasReply) {
+                request->hasReply = true;
+                request->reply.error = "failed";
+            }
+        }
+    }
+
+    bool replied = false;
+    {
+        std::unique_lock<std::mutex> replyLock(request->replyMutex);
+        replied = request->replyCondition.wait_for(replyLock, timeout, [request]() { return request->hasReply; });
+        if (replied) {
+            std::swap(reply.object, request->reply.object);
+            reply.error.swap(request->reply.error);
+            reply.info.swap(request->reply.info);
+        }
+    }
+
+    reqUnref(request);
+    return replied;
+}
+
+void FakeBinder::withRequest(int clientId, std::function<void(afb_req_t request)> job) {
+    auto request = createRequest(clientId);
+    job(request);
+    reqUnref(request);
+}
+
+void FakeBinder::setPushHook(std::function<void(const std::string& eventName, int receivers)> hook) {
+    std::lock_guard<std::mutex> lock(mEventsMutex);
+    mPushHook = hook;
+}
+
+FakeBinder::Request* FakeBinder::createRequest(int clientId) {
+    auto request = new Request();
+    request->itf = getRequestInterface();
+    request->api = getApi();
+    request->vcbdata = nullptr;
+    request->called_api = mApiName.c_str();
+    request->called_verb = nullptr;
+    request->binder = this;
+    request->clientId = clientId;
+    request->refCount = 1;
+    request->hasReply = false;
+    return request;
+}
+
+void FakeBinder::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mJobsMutex);
+    mIdleCondition.wait(lock, [this]() { return mJobs.empty() && mRunningJobs == 0; });
+}
+
+uint64_t FakeBinder::getPushCount(const std::string& eventName) const {
+    std::lock_guard<std::mutex> lock(mEventsMutex);
+    auto countsIt = mEventCounts.find(eventName);
+    return countsIt != mEventCounts.end() ? countsIt->second.pushes : 0;
+}
+
+uint64_t FakeBinder::getDeliveryCount(const std::string& eventName) const {
+    std::lock_guard<std::mutex> lock(mEventsMutex);
+    auto countsIt = mEventCounts.find(eventName);
+    return countsIt != mEventCounts.end() ? countsIt->second.deliveries : 0;
+}
+
+uint64_t FakeBinder::getCallCount(const std::string& api, const std::string& verb) const {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    auto targetIt = mTargets.find(api);
+    if (targetIt == mTargets.end()) {
+        return 0;
+    }
+
+    auto countIt = targetIt->second.callCounts.find(verb);
+    return countIt != targetIt->second.callCounts.end() ? countIt->second : 0;
+}
+
+FakeBinder::Target FakeBinder::getTarget(
+    const std::string& api,
+    const std::string& verb,
+    std::chrono::microseconds& latency) {
+    std::lock_guard<std::mutex> lock(mTargetsMutex);
+    auto targetIt = mTargets.find(api);
+    if (targetIt == mTargets.end()) {
+        latency = std::chrono::microseconds::zero();
+        return nullptr;
+    }
+
+    latency = targetIt->second.latency;
+    ++targetIt->second.callCounts[verb];
+    auto verbIt = targetIt->second.verbs.find(verb);
+    return verbIt != targetIt->second.verbs.end() ? verbIt->second : nullptr;
+}
+
+std::unique_lock<std::mutex> FakeBinder::lockPlugin() {
+    if (mSerialized) {
+        return std::unique_lock<std::mutex>(mPluginMutex);
+    }
+
+    return std::unique_lock<std::mutex>(mPluginMutex, std::defer_lock);
+}
+
+void FakeBinder::schedule(std::chrono::microseconds delay, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        mJobs.emplace(std::chrono::steady_clock::now() + delay, std::move(job));
+    }
+    mJobsCondition.notify_one();
+}
+
+void FakeBinder::runWorker() {
+    std::unique_lock<std::mutex> lock(mJobsMutex);
+    while (!mStopped) {
+        if (mJobs.empty()) {
+            mJobsCondition.wait(lock);
+            continue;
+        }
+
+        auto jobIt = mJobs.begin();
+        if (std::chrono::steady_clock::now() < jobIt->first) {
+            mJobsCondition.wait_until(lock, jobIt->first);
+            continue;
+        }
+
+        auto job = std::move(jobIt->second);
+        mJobs.erase(jobIt);
+        ++mRunningJobs;
+
+        lock.unlock();
+        job();
+        // Whatever the job holds is released before it counts as done.
+        job = nullptr;
+        lock.lock();
+
+        if (--mRunningJobs == 0 && mJobs.empty()) {
+            mIdleCondition.notify_all();
+        }
+    }
+}
+
+void FakeBinder::apiVerbose(
+    afb_api_t api,
+    int level,
+    const char* file,
+    int line,
+    const char* func,
+    const char* fmt,
+    va_list args) {
+    fprintf(stderr, "<%d> ", level);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+}
+
+int FakeBinder::apiQueueJob(afb_api_t api, void (*callback)(int, void*), void* argument, void* group, int timeout) {
+    auto binder = static_cast<Api*>(api)->binder;
+    binder->schedule(std::chrono::microseconds::zero(), [callback, argument]() { callback(0, argument); });
+    return 0;
+}
+
+afb_event_t FakeBinder::apiMakeEvent(afb_api_t api, const char* name) {
+    auto binder = static_cast<Api*>(api)->binder;
+    auto event = new Event();
+    event->itf = getEventInterface();
+    event->binder = binder;
+    event->name = binder->mApiName + "/" + name;
+    event->refCount = 1;
+
+    std::lock_guard<std::mutex> lock(binder->mEventsMutex);
+    binder->mSubscribers[event];
+    return event;
+}
+
+void FakeBinder::apiCall(
+    afb_api_t api,
+    const char* apiName,
+    const char* verb,
+    json_object* args,
+    void (*callback)(void* closure, json_object* object, const char* error, const char* info, afb_api_t api),
+    void* closure) {
+    auto binder = static_cast<Api*>(api)->binder;
+    std::chrono::microseconds latency;
+    auto target = binder->getTarget(apiName, verb, latency);
+
+    binder->schedule(latency, [binder, api, target, args, callback, closure]() {
+        json_object* result = nullptr;
+        std::string error;
+        if (!target) {
+            error = "unknown-api";
+        } else if (target(args, &result, error) != 0 && error.empty()) {
+            error = "failed";
+        }
+        json_object_put(args);
+
+        if (callback) {
+            auto lock = binder->lockPlugin();
+            callback(closure, result, error.empty() ? nullptr : error.c_str(), nullptr, api);
+        }
+
+        // The binder releases the reply once the callback returned.
+        if (result) {
+            json_object_put(result);
+        }
+    });
+}
+
+int FakeBinder::apiCallSync(
+    afb_api_t api,
+    const char* apiName,
+    const char* verb,
+    json_object* args,
+    json_object** object,
+    char** error,
+    char** info) {
+    auto binder = static_cast<Api*>(api)->binder;
+    std::chrono::microseconds latency;
+    auto target = binder->getTarget(apiName, verb, latency);
+    std::this_thread::sleep_for(latency);
+
+    json_object* result = nullptr;
+    std::string targetError;
+    int rc = 0;
+    if (!target) {
+        targetError = "unknown-api";
+        rc = -1;
+    } else if (target(args, &result, targetError) != 0) {
+        if (targetError.empty()) {
+            targetError = "failed";
+        }
+        rc = -1;
+    }
+    json_object_put(args);
+
+    if (object) {
+        *object = result;
+    } else if (result) {
+        json_object_put(result);
+    }
+    if (error) {
+        *error = targetError.empty() ? nullptr : strdup(targetError.c_str());
+    }
+    if (info) {
+        *info = nullptr;
+    }
+
+    return rc;
+}
+
+void FakeBinder::reqReply(afb_req_t req, json_object* object, const char* error, const char* info) {
+    auto request = static_cast<Request*>(req);
+    std::lock_guard<std::mutex> lock(request->replyMutex);
+    if (request->hasReply) {
+        // Like the binder, only the first reply counts.
+        if (object) {
+            json_object_put(object);
+        }
+        return;
+    }
+
+    request->hasReply = true;
+    request->reply.object = object;
+    request->reply.error = error ? error : "";
+    request->reply.info = info ? info : "";
+    request->replyCondition.notify_all();
+}
+
+void FakeBinder::reqVReply(afb_req_t req, json_object* object, const char* error, const char* fmt, va_list args) {
+    char info[256] = {0};
+    if (fmt) {
+        vsnprintf(info, sizeof(info), fmt, args);
+    }
+    reqReply(req, object, error, fmt ? info : nullptr);
+}
+
+void FakeBinder::reqSuccess(afb_req_t req, json_object* object, const char* info) {
+    reqReply(req, object, nullptr, info);
+}
+
+void FakeBinder::reqFail(afb_req_t req, const char* status, const char* info) {
+    reqReply(req, nullptr, status ? status : "failed", info);
+}
+
+afb_req_t FakeBinder::reqAddRef(afb_req_t req) {
+    ++static_cast<Request*>(req)->refCount;
+    return req;
+}
+
+void FakeBinder::reqUnref(afb_req_t req) {
+    auto request = static_cast<Request*>(req);
+    if (--request->refCount == 0) {
+        delete request;
+    }
+}
+
+int FakeBinder::reqHasPermission(afb_req_t req, const char* permission) {
+    auto binder = static_cast<Request*>(req)->binder;
+    std::lock_guard<std::mutex> lock(binder->mPermissionsMutex);
+    return binder->mDeniedPermissions.count(permission) == 0 ? 1 : 0;
+}
+
+int FakeBinder::reqSubscribe(afb_req_t req, afb_event_t event) {
+    auto request = static_cast<Request*>(req);
+    std::lock_guard<std::mutex> lock(request->binder->mEventsMutex);
+    request->binder->mSubscribers[static_cast<Event*>(event)].insert(request->clientId);
+    return 0;
+}
+
+int FakeBinder::reqUnsubscribe(afb_req_t req, afb_event_t event) {
+    auto request = static_cast<Request*>(req);
+    std::lock_guard<std::mutex> lock(request->binder->mEventsMutex);
+    request->binder->mSubscribers[static_cast<Event*>(event)].erase(request->clientId);
+    return 0;
+}
+
+int FakeBinder::eventPush(afb_event_t event, json_object* object) {
+    auto fakeEvent = static_cast<Event*>(event);
+    auto binder = fakeEvent->binder;
+    int receivers = 0;
+    std::function<void(const std::string& eventName, int receivers)> hook;
+    {
+        std::lock_guard<std::mutex> lock(binder->mEventsMutex);
+        receivers = static_cast<int>(binder->mSubscribers[fakeEvent].size());
+        auto& counts = binder->mEventCounts[fakeEvent->name];
+        ++counts.pushes;
+        counts.deliveries += receivers;
+        hook = binder->mPushHook;
+    }
+
+    if (hook) {
+        hook(fakeEvent->name, receivers);
+    }
+
+    if (object) {
+        json_object_put(object);
+    }
+    return receivers;
+}
+
+int FakeBinder::eventBroadcast(afb_event_t event, json_object* object) {
+    return eventPush(event, object);
+}
+
+void FakeBinder::eventUnref(afb_event_t event) {
+    auto fakeEvent = static_cast<Event*>(event);
+    if (--fakeEvent->refCount != 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fakeEvent->binder->mEventsMutex);
+        fakeEvent->binder->mSubscribers.erase(fakeEvent);
+    }
+    delete fakeEvent;
+}
+
+const char* FakeBinder::eventName(afb_event_t event) {
+    return static_cast<Event*>(event)->name.c_str();
+}
+
+afb_event_t FakeBinder::eventAddRef(afb_event_t event) {
+    ++static_cast<Event*>(event)->refCount;
+    return event;
+}
+
+const afb_api_x3_itf* FakeBinder::getApiInterface() {
+    static afb_api_x3_itf itf = []() {
+        afb_api_x3_itf apiItf;
+        memset(&apiItf, 0, sizeof(apiItf));
+        apiItf.vverbose = apiVerbose;
+        apiItf.queue_job = apiQueueJob;
+        apiItf.event_make = apiMakeEvent;
+        apiItf.call = apiCall;
+        apiItf.call_sync = apiCallSync;
+        return apiItf;
+    }();
+    return &itf;
+}
+
+const afb_req_x2_itf* FakeBinder::getRequestInterface() {
+    static afb_req_x2_itf itf = []() {
+        afb_req_x2_itf reqItf;
+        memset(&reqItf, 0, sizeof(reqItf));
+        reqItf.legacy_success = reqSuccess;
+        reqItf.legacy_fail = reqFail;
+        reqItf.addref = reqAddRef;
+        reqItf.unref = reqUnref;
+        reqItf.has_permission = reqHasPermission;
+        reqItf.subscribe_event_x2 = reqSubscribe;
+        reqItf.unsubscribe_event_x2 = reqUnsubscribe;
+        reqItf.reply = reqReply;
+        reqItf.vreply = reqVReply;
+        return reqItf;
+    }();
+    return &itf;
+}
+
+const afb_event_x2_itf* FakeBinder::getEventInterface() {
+    static afb_event_x2_itf itf = []() {
+        afb_event_x2_itf eventItf;
+        memset(&eventItf, 0, sizeof(eventItf));
+        eventItf.broadcast = eventBroadcast;
+        eventItf.push = eventPush;
+        eventItf.unref = eventUnref;
+        eventItf.name = eventName;
+        eventItf.addref = eventAddRef;
+        return eventItf;
+    }();
+    return &itf;
+}
+
+}  // namespace fakes
+}  // namespace bench
+}  // namespace vshl
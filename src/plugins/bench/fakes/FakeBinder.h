@@ -0,0 +1,265 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_BENCH_FAKES_FAKEBINDER_H_
+#define VSHL_BENCH_FAKES_FAKEBINDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include "ctl-plugin.h"
+}
+
+namespace vshl {
+namespace bench {
+namespace fakes {
+
+/*
+ * In-process stand-in for the AFB binder, so that the plugin can be driven end
+ * to end without afb-daemon. It implements the part of the binder v3 dynamic
+ * api the plugin uses: its own api, requests and their replies, events and
+ * their subscriptions, and the calls made to other apis, which are served by
+ * scripted targets after a configurable latency.
+ *
+ * Verbs and actions of the plugin are called directly, the way the controller
+ * calls them. Calls to other apis complete on a pool of worker threads.
+ */
+class FakeBinder {
+public:
+    // A verb or an action of the plugin.
+    using Verb = int (*)(CtlSourceT* source, json_object* argsJ, json_object* queryJ);
+
+    // Serves a call made to another api. The reference on @c args is borrowed,
+    // the one on @c result is transferred. A non zero return fails the call.
+    using Target = std::function<int(json_object* args, json_object** result, std::string& error)>;
+
+    // Reply of a verb. Holds a reference on the replied object.
+    struct Reply {
+        Reply();
+        ~Reply();
+
+        // Whether the verb succeeded.
+        bool isSuccess() const;
+
+        json_object* object;
+        std::string error;
+        std::string info;
+    };
+
+    // Create a FakeBinder serving the api @c apiName, whose calls to other
+    // apis complete on @c workerCount threads.
+    static std::unique_ptr<FakeBinder> create(const std::string& apiName, size_t workerCount);
+
+    // Destructor. Calls to other apis not completed yet are dropped.
+    ~FakeBinder();
+
+    // The api of the plugin.
+    afb_api_t getApi();
+
+    // Whether the plugin logs are printed on stderr. Off by default.
+    void setLogging(bool enabled);
+
+    // Serves the calls to @c api/@c verb. Calls to verbs without a target fail.
+    void setTarget(const std::string& api, const std::string& verb, Target target);
+
+    // Latency of the calls to @c api, before their target runs.
+    void setTargetLatency(const std::string& api, std::chrono::microseconds latency);
+
+    // Grants or denies @c permission to the clients. Every permission is granted by default.
+    void setPermissionGranted(const std::string& permission, bool granted);
+
+    // Runs the verbs, the actions and the completions of the calls made by the
+    // plugin one at a time, like the binder does for an api with noconcurrency.
+    void setSerialized(bool serialized);
+
+    // Runs an onload or event action, which has no request.
+    int callAction(Verb action, json_object* argsJ, json_object* eventJ);
+
+    // Calls a verb on behalf of the client @c clientId, with @c argsJ the args
+    // of the verb in the configuration and @c queryJ the request. Returns false
+    // if no reply came within @c timeout.
+    bool callVerb(
+        Verb verb,
+        json_object* argsJ,
+        json_object* queryJ,
+        int clientId,
+        Reply& reply,
+        std::chrono::milliseconds timeout);
+
+    // Runs @c job with a request of the client @c clientId, which the job
+    // may use to subscribe the client to events, without calling a verb.
+    void withRequest(int clientId, std::function<void(afb_req_t request)> job);
+
+    // Runs @c hook on every push, once the receivers were counted, so that
+    // tests can race the pushes. An empty hook removes it.
+    void setPushHook(std::function<void(const std::string& eventName, int receivers)> hook);
+
+    // Waits until the calls made to other apis completed.
+    void waitUntilIdle();
+
+    // Number of times @c eventName was pushed.
+    uint64_t getPushCount(const std::string& eventName) const;
+
+    // Number of clients the pushes of @c eventName reached.
+    uint64_t getDeliveryCount(const std::string& eventName) const;
+
+    // Number of calls made to @c api/@c verb.
+    uint64_t getCallCount(const std::string& api, const std::string& verb) const;
+
+private:
+    struct Api;
+    struct Request;
+    struct Event;
+
+    // A scripted api.
+    struct TargetApi {
+        TargetApi();
+
+        std::chrono::microseconds latency;
+        std::unordered_map<std::string, Target> verbs;
+        std::unordered_map<std::string, uint64_t> callCounts;
+    };
+
+    // Pushes and deliveries of an event.
+    struct EventCounts {
+        EventCounts();
+
+        uint64_t pushes;
+        uint64_t deliveries;
+    };
+
+    // Constructor
+    FakeBinder(const std::string& apiName, size_t workerCount);
+
+    // Returns the target of @c api/@c verb and the latency of @c api, and counts the call.
+    Target getTarget(const std::string& api, const std::string& verb, std::chrono::microseconds& latency);
+
+    // Makes a request of the client @c clientId, holding one reference.
+    Request* createRequest(int clientId);
+
+    // Returns a lock that serializes the plugin, which is not locked unless serialized.
+    std::unique_lock<std::mutex> lockPlugin();
+
+    // Runs @c job on a worker thread after @c delay.
+    void schedule(std::chrono::microseconds delay, std::function<void()> job);
+
+    // Worker thread loop.
+    void runWorker();
+
+    /// @name Api interface.
+    /// @{
+    static void apiVerbose(
+        afb_api_t api,
+        int level,
+        const char* file,
+        int line,
+        const char* func,
+        const char* fmt,
+        va_list args);
+    static int apiQueueJob(afb_api_t api, void (*callback)(int, void*), void* argument, void* group, int timeout);
+    static afb_event_t apiMakeEvent(afb_api_t api, const char* name);
+    static void apiCall(
+        afb_api_t api,
+        const char* apiName,
+        const char* verb,
+        json_object* args,
+        void (*callback)(void* closure, json_object* object, const char* error, const char* info, afb_api_t api),
+        void* closure);
+    static int apiCallSync(
+        afb_api_t api,
+        const char* apiName,
+        const char* verb,
+        json_object* args,
+        json_object** object,
+        char** error,
+        char** info);
+    /// @}
+
+    /// @name Request interface.
+    /// @{
+    static void reqReply(afb_req_t req, json_object* object, const char* error, const char* info);
+    static void reqVReply(afb_req_t req, json_object* object, const char* error, const char* fmt, va_list args);
+    static void reqSuccess(afb_req_t req, json_object* object, const char* info);
+    static void reqFail(afb_req_t req, const char* status, const char* info);
+    static afb_req_t reqAddRef(afb_req_t req);
+    static void reqUnref(afb_req_t req);
+    static int reqHasPermission(afb_req_t req, const char* permission);
+    static int reqSubscribe(afb_req_t req, afb_event_t event);
+    static int reqUnsubscribe(afb_req_t req, afb_event_t event);
+    /// @}
+
+    /// @name Event interface.
+    /// @{
+    static int eventPush(afb_event_t event, json_object* object);
+    static int eventBroadcast(afb_event_t event, json_object* object);
+    static void eventUnref(afb_event_t event);
+    static const char* eventName(afb_event_t event);
+    static afb_event_t eventAddRef(afb_event_t event);
+    /// @}
+
+    // Interfaces handed to the plugin.
+    static const afb_api_x3_itf* getApiInterface();
+    static const afb_req_x2_itf* getRequestInterface();
+    static const afb_event_x2_itf* getEventInterface();
+
+    // Name of the plugin api, and the api handed to the plugin.
+    std::string mApiName;
+    std::unique_ptr<Api> mApi;
+
+    // Whether the plugin is serialized, and the lock that does it.
+    std::atomic<bool> mSerialized;
+    std::mutex mPluginMutex;
+
+    // Scripted apis, by name.
+    mutable std::mutex mTargetsMutex;
+    std::unordered_map<std::string, TargetApi> mTargets;
+
+    // Permissions denied to the clients.
+    mutable std::mutex mPermissionsMutex;
+    std::unordered_set<std::string> mDeniedPermissions;
+
+    // Subscribers of the live events, and the counts of every event by name.
+    mutable std::mutex mEventsMutex;
+    std::unordered_map<Event*, std::unordered_set<int>> mSubscribers;
+    std::unordered_map<std::string, EventCounts> mEventCounts;
+    std::function<void(const std::string& eventName, int receivers)> mPushHook;
+
+    // Pending jobs by due time, the number of jobs running, and the workers running them.
+    std::mutex mJobsMutex;
+    std::condition_variable mJobsCondition;
+    std::condition_variable mIdleCondition;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> mJobs;
+    size_t mRunningJobs;
+    bool mStopped;
+    std::vector<std::thread> mWorkers;
+};
+
+}  // namespace fakes
+}  // namespace bench
+}  // namespace vshl
+
+#endif  // VSHL_BENCH_FAKES_FAKEBINDER_H_
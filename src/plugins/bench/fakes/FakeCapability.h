@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_BENCH_FAKES_FAKECAPABILITY_H_
+#define VSHL_BENCH_FAKES_FAKECAPABILITY_H_
+
+#include <list>
+#include <string>
+
+#include "interfaces/capabilities/ICapability.h"
+
+namespace vshl {
+namespace bench {
+namespace fakes {
+
+/*
+ * Capability with a fixed set of messages that does nothing when one of
+ * its messages is published.
+ */
+class FakeCapability : public vshl::common::interfaces::ICapability {
+public:
+    FakeCapability(
+        const std::string& name,
+        const std::list<std::string>& upstreamMessages,
+        const std::list<std::string>& downstreamMessages) :
+            mName(name),
+            mUpstreamMessages(upstreamMessages),
+            mDownstreamMessages(downstreamMessages) {
+    }
+
+    std::string getName() const override {
+        return mName;
+    }
+
+    std::list<std::string> getUpstreamMessages() const override {
+        return mUpstreamMessages;
+    }
+
+    std::list<std::string> getDownstreamMessages() const override {
+        return mDownstreamMessages;
+    }
+
+    void onMessagePublished(const std::string action) override {
+    }
+
+private:
+    std::string mName;
+    std::list<std::string> mUpstreamMessages;
+    std::list<std::string> mDownstreamMessages;
+};
+
+}  // namespace fakes
+}  // namespace bench
+}  // namespace vshl
+
+#endif  // VSHL_BENCH_FAKES_FAKECAPABILITY_H_
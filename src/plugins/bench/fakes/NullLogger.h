@@ -0,0 +1,35 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_BENCH_FAKES_NULLLOGGER_H_
+#define VSHL_BENCH_FAKES_NULLLOGGER_H_
+
+#include "interfaces/utilities/logging/ILogger.h"
+
+namespace vshl {
+namespace bench {
+namespace fakes {
+
+// Logger that drops every message.
+class NullLogger : public vshl::common::interfaces::ILogger {
+public:
+    void log(Level level, const std::string& tag, const std::string& message) override {
+    }
+};
+
+}  // namespace fakes
+}  // namespace bench
+}  // namespace vshl
+
+#endif  // VSHL_BENCH_FAKES_NULLLOGGER_H_
@@ -61,5 +61,9 @@ std::shared_ptr<common::interfaces::ICapability> CapabilitiesFactory::getNavigat
     return mNavigation;
 }
 
+std::list<std::shared_ptr<common::interfaces::ICapability>> CapabilitiesFactory::getAllCapabilities() {
+    return {getGuiMetadata(), getPhoneControl(), getNavigation()};
+}
+
 }  // namespace capabilities
 }  // namespace vshl
\ No newline at end of file
@@ -15,6 +15,7 @@
 #ifndef VSHL_CAPABILITIES_CAPABILITIESFACTORY_H_
 #define VSHL_CAPABILITIES_CAPABILITIESFACTORY_H_
 
+#include <list>
 #include <memory>
 
 #include "interfaces/appmanagement/IAppController.h"
@@ -44,6 +45,9 @@ public:
     // Navigation capability
     std::shared_ptr<common::interfaces::ICapability> getNavigation();
 
+    // All the capabilities supported by the high level voice service.
+    std::list<std::shared_ptr<common::interfaces::ICapability>> getAllCapabilities();
+
     // Destructor
     ~CapabilitiesFactory() = default;
 
@@ -43,7 +43,8 @@ unique_ptr<CapabilityMessagingService> CapabilityMessagingService::create(
 }
 
 CapabilityMessagingService::~CapabilityMessagingService() {
-    mMessageChannelsMap.clear();
+    mMessageChannels.clear();
+    mCapabilityNames.clear();
 }
 
 CapabilityMessagingService::CapabilityMessagingService(
@@ -53,19 +54,63 @@ CapabilityMessagingService::CapabilityMessagingService(
         mLogger(logger) {
 }
 
+int CapabilityMessagingService::registerCapability(shared_ptr<common::interfaces::ICapability> capability) {
+    if (!capability || capability->getName().empty()) {
+        mLogger->log(Level::ERROR, TAG, "Failed to register capability. Invalid input.");
+        return -1;
+    }
+
+    auto capabilityName = capability->getName();
+    int capabilityId = getCapabilityId(capabilityName);
+    if (capabilityId != -1) {
+        return capabilityId;
+    }
+
+    mLogger->log(Level::INFO, TAG, "Creating new message channel for capability: " + capabilityName);
+    auto messageChannel = vshl::capabilities::core::MessageChannel::create(mLogger, mAfbApi, capability);
+    if (!messageChannel) {
+        mLogger->log(Level::ERROR, TAG, "Failed to create message channel for capability: " + capabilityName);
+        return -1;
+    }
+
+    mCapabilityNames.push_back(capabilityName);
+    mMessageChannels.push_back(messageChannel);
+    return static_cast<int>(mMessageChannels.size() - 1);
+}
+
+int CapabilityMessagingService::getCapabilityId(const string& capabilityName) const {
+    for (size_t capabilityId = 0; capabilityId < mCapabilityNames.size(); ++capabilityId) {
+        if (mCapabilityNames[capabilityId] == capabilityName) {
+            return static_cast<int>(capabilityId);
+        }
+    }
+    return -1;
+}
+
 // Subscribe to capability specific messages.
 bool CapabilityMessagingService::subscribe(
     vshl::common::interfaces::IAFBRequest& request,
     shared_ptr<common::interfaces::ICapability> capability,
     const string action) {
-    auto capabilityName = capability->getName();
-
-    if (capabilityName.empty()) {
+    int capabilityId = registerCapability(capability);
+    if (capabilityId == -1) {
         mLogger->log(Level::ERROR, TAG, "Failed to subscribe to message. Invalid input.");
         return false;
     }
 
-    auto messageChannel = getMessageChannel(capability);
+    return subscribe(request, capabilityId, action);
+}
+
+bool CapabilityMessagingService::subscribe(
+    vshl::common::interfaces::IAFBRequest& request,
+    int capabilityId,
+    const string action) {
+    auto messageChannel = getMessageChannel(capabilityId);
+    if (!messageChannel) {
+        mLogger->log(Level::ERROR, TAG, "Failed to subscribe to message. Unknown capability id.");
+        return false;
+    }
+
     return messageChannel->subscribe(request, action);
 }
 
@@ -81,8 +126,8 @@ bool CapabilityMessagingService::publish(
         return false;
     }
 
-    auto messageChannelIt = mMessageChannelsMap.find(capabilityName);
-    if (messageChannelIt == mMessageChannelsMap.end()) {
+    int capabilityId = getCapabilityId(capabilityName);
+    if (capabilityId == -1) {
         mLogger->log(
             Level::ERROR,
             TAG,
@@ -90,27 +135,33 @@ bool CapabilityMessagingService::publish(
         return false;
     }
 
-    return messageChannelIt->second->publish(action, payload);
+    return publish(capabilityId, action, payload);
 }
 
-shared_ptr<vshl::capabilities::core::MessageChannel> CapabilityMessagingService::getMessageChannel(
-    shared_ptr<common::interfaces::ICapability> capability) {
-    auto capabilityName = capability->getName();
+bool CapabilityMessagingService::publish(int capabilityId, const string action, const string payload) {
+    json_object* payloadJ = json_object_new_string_len(payload.c_str(), payload.size());
+    bool result = publish(capabilityId, action, payloadJ);
+    json_object_put(payloadJ);
+    return result;
+}
 
-    if (capabilityName.empty()) {
-        mLogger->log(Level::ERROR, TAG, "Failed to create message channel. Invalid input.");
-        return nullptr;
+bool CapabilityMessagingService::publish(int capabilityId, const string& action, json_object* payload) {
+    auto messageChannel = getMessageChannel(capabilityId);
+    if (!messageChannel) {
+        mLogger->log(Level::ERROR, TAG, "Failed to publish message. Unknown capability id.");
+        return false;
     }
 
-    auto messageChannelIt = mMessageChannelsMap.find(capabilityName);
-    if (messageChannelIt == mMessageChannelsMap.end()) {
-        mLogger->log(Level::INFO, TAG, "Creating new message channel for capability: " + capabilityName);
-        auto messageChannel = vshl::capabilities::core::MessageChannel::create(mLogger, mAfbApi, capability);
-        mMessageChannelsMap.insert(make_pair(capabilityName, messageChannel));
-        return messageChannel;
+    return messageChannel->publish(action, payload);
+}
+
+shared_ptr<vshl::capabilities::core::MessageChannel> CapabilityMessagingService::getMessageChannel(
+    int capabilityId) const {
+    if (capabilityId < 0 || static_cast<size_t>(capabilityId) >= mMessageChannels.size()) {
+        return nullptr;
     }
 
-    return messageChannelIt->second;
+    return mMessageChannels[capabilityId];
 }
 
 }  // namespace capabilities
@@ -17,7 +17,7 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "capabilities/core/include/MessageChannel.h"
 #include "interfaces/afb/IAFBApi.h"
@@ -43,15 +43,43 @@ public:
   create(shared_ptr<vshl::common::interfaces::ILogger> logger,
          shared_ptr<vshl::common::interfaces::IAFBApi> afbApi);
 
+  /**
+   * Registers the capability and creates its message channel. Registering an
+   * already registered capability returns its existing id.
+   *
+   * @return Id of the capability, or -1 on failure.
+   */
+  int registerCapability(shared_ptr<common::interfaces::ICapability> capability);
+
+  /**
+   * Resolves a capability name to the id returned by @c registerCapability.
+   * The registered capabilities are few, so this is a plain scan.
+   *
+   * @return Id of the capability, or -1 if it isn't registered.
+   */
+  int getCapabilityId(const string &capabilityName) const;
+
   // Subscribe to capability specific messages.
   bool subscribe(vshl::common::interfaces::IAFBRequest &request,
                  shared_ptr<common::interfaces::ICapability> capability,
                  const string action);
 
+  // Subscribe to messages of a registered capability.
+  bool subscribe(vshl::common::interfaces::IAFBRequest &request,
+                 int capabilityId, const string action);
+
   // Publish capability messages.
   bool publish(shared_ptr<common::interfaces::ICapability> capability,
                const string action, const string payload);
 
+  // Publish messages of a registered capability.
+  bool publish(int capabilityId, const string action, const string payload);
+
+  // Publish messages of a registered capability. The payload is borrowed and
+  // forwarded to the subscribers as is, without being copied or serialized,
+  // so a structured object payload reaches them as an object.
+  bool publish(int capabilityId, const string &action, json_object *payload);
+
   // Destructor
   ~CapabilityMessagingService();
 
@@ -64,13 +92,16 @@ private:
   // Binding API reference
   shared_ptr<vshl::common::interfaces::IAFBApi> mAfbApi;
 
-  // Create a message channel for the capability.
+  // Returns the message channel of a registered capability, or nullptr.
   shared_ptr<vshl::capabilities::core::MessageChannel>
-  getMessageChannel(shared_ptr<common::interfaces::ICapability> capability);
+  getMessageChannel(int capabilityId) const;
+
+  // Names of the registered capabilities, indexed by capability id.
+  vector<string> mCapabilityNames;
 
-  // Map of capabilities to message channels.
-  unordered_map<string, shared_ptr<vshl::capabilities::core::MessageChannel>>
-      mMessageChannelsMap;
+  // Message channels of the registered capabilities, indexed by capability id.
+  vector<shared_ptr<vshl::capabilities::core::MessageChannel>>
+      mMessageChannels;
 
   // Logger
   shared_ptr<vshl::common::interfaces::ILogger> mLogger;
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <benchmark/benchmark.h>
+
+#include "capabilities/core/include/SubscriberForwarder.h"
+
+#include "bench/common/AllocationCounter.h"
+#include "bench/fakes/FakeAFBApi.h"
+#include "bench/fakes/FakeCapability.h"
+#include "bench/fakes/NullLogger.h"
+
+using namespace vshl::bench::common;
+using namespace vshl::bench::fakes;
+using namespace vshl::capabilities::core;
+
+namespace {
+
+// Card payload of roughly the requested size, large cards carry lists and lyrics.
+json_object* createPayload(int64_t size) {
+    std::string payload = "{\"title\":{\"mainTitle\":\"Weather\"},\"description\":\"";
+    payload.append(static_cast<size_t>(size), 'x');
+    payload.append("\"}");
+    return json_object_new_string_len(payload.c_str(), payload.size());
+}
+
+std::shared_ptr<SubscriberForwarder> createForwarder() {
+    auto capability = std::make_shared<FakeCapability>(
+        "guimetadata",
+        std::list<std::string>{"RenderTemplate", "RenderPlayerInfo", "ClearTemplate", "ClearPlayerInfo"},
+        std::list<std::string>{"ElementSelected"});
+    return SubscriberForwarder::create(std::make_shared<NullLogger>(), std::make_shared<FakeAFBApi>(), capability);
+}
+
+void BM_SubscriberForwarder_ForwardUpstream(benchmark::State& state) {
+    auto forwarder = createForwarder();
+    json_object* payload = createPayload(state.range(0));
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(forwarder->forwardMessage("RenderPlayerInfo", payload));
+    }
+    reportAllocations(state, allocations);
+
+    json_object_put(payload);
+}
+BENCHMARK(BM_SubscriberForwarder_ForwardUpstream)->Arg(256)->Arg(64 << 10);
+
+void BM_SubscriberForwarder_ForwardDownstream(benchmark::State& state) {
+    auto forwarder = createForwarder();
+    json_object* payload = createPayload(state.range(0));
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(forwarder->forwardMessage("ElementSelected", payload));
+    }
+    reportAllocations(state, allocations);
+
+    json_object_put(payload);
+}
+BENCHMARK(BM_SubscriberForwarder_ForwardDownstream)->Arg(256)->Arg(64 << 10);
+
+void BM_SubscriberForwarder_ForwardUnknown(benchmark::State& state) {
+    auto forwarder = createForwarder();
+    json_object* payload = createPayload(state.range(0));
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(forwarder->forwardMessage("Unknown", payload));
+    }
+    reportAllocations(state, allocations);
+
+    json_object_put(payload);
+}
+BENCHMARK(BM_SubscriberForwarder_ForwardUnknown)->Arg(256)->Arg(64 << 10);
+
+}  // namespace
@@ -56,8 +56,7 @@ void PhoneControl::onMessagePublished(const string action) {
     if (action == PHONECONTROL_DIAL) {
         mLogger->log(Level::INFO, TAG, "PhoneControl::onMessagePublished, Launcing Dialer app.");
         if (mAppController != nullptr) {
-            mAppController->startApp(APP_NAME, VERSION_NAME);
-            mAppController->displayApp(APP_NAME, VERSION_NAME);
+            mAppController->startAndDisplayApp(APP_NAME, VERSION_NAME);
         }
     }
 }
@@ -40,8 +40,8 @@ public:
          shared_ptr<vshl::common::interfaces::IAFBApi> afbApi,
          shared_ptr<vshl::common::interfaces::ICapability> capability);
 
-  // Sends the message
-  bool publish(const string action, const string payload);
+  // Sends the message. The payload is borrowed.
+  bool publish(const string &action, json_object *payload);
 
   // Subscribe
   bool subscribe(vshl::common::interfaces::IAFBRequest &request,
@@ -44,8 +44,8 @@ public:
     // Connect a subscriber forwarder to this publisher forwarder
     void setSubscriberForwarder(shared_ptr<SubscriberForwarder> subscriberForwarder);
 
-    // Forward message to the subscriber forwarder
-    bool forwardMessage(const string action, const string payload);
+    // Forward message to the subscriber forwarder. The payload is borrowed.
+    bool forwardMessage(const string& action, json_object* payload);
 
     // Destructor
     ~PublisherForwarder();
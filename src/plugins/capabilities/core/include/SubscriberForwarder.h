@@ -40,8 +40,9 @@ public:
          shared_ptr<vshl::common::interfaces::IAFBApi> afbApi,
          shared_ptr<vshl::common::interfaces::ICapability> capability);
 
-  // Publish a capability message to the actual client.
-  bool forwardMessage(const string action, const string payload);
+  // Publish a capability message to the actual client. The payload is
+  // borrowed, the published event takes its own reference on it.
+  bool forwardMessage(const string &action, json_object *payload);
 
   // Subscribe
   bool subscribe(vshl::common::interfaces::IAFBRequest &request,
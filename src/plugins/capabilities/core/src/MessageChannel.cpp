@@ -38,7 +38,7 @@ MessageChannel::MessageChannel(
     mPublisherForwarder->setSubscriberForwarder(mSubscriberForwarder);
 }
 
-bool MessageChannel::publish(const string action, const string payload) {
+bool MessageChannel::publish(const string& action, json_object* payload) {
     return mPublisherForwarder->forwardMessage(action, payload);
 }
 
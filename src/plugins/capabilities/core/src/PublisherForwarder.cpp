@@ -55,7 +55,7 @@ void PublisherForwarder::setSubscriberForwarder(shared_ptr<SubscriberForwarder>
     mSubscriberForwarder = subscriberForwarder;
 }
 
-bool PublisherForwarder::forwardMessage(const string action, const string payload) {
+bool PublisherForwarder::forwardMessage(const string& action, json_object* payload) {
     if (!mSubscriberForwarder) {
         mLogger->log(Level::ERROR, TAG, "Failed to forward message for capability: " + mCapability->getName());
         return false;
@@ -98,20 +98,23 @@ void SubscriberForwarder::createEvents() {
     }
 }
 
-bool SubscriberForwarder::forwardMessage(const string action, const string payload) {
+bool SubscriberForwarder::forwardMessage(const string& action, json_object* payload) {
     auto upstreamEventIt = mUpstreamEventsMap.find(action);
     if (upstreamEventIt != mUpstreamEventsMap.end()) {
-        mLogger->log(Level::NOTICE, TAG, "Publishing upstream event: " + action);
-        upstreamEventIt->second->publishEvent(json_object_new_string(payload.c_str()));
-        // Let the capability know about it.
+        if (upstreamEventIt->second->hasSubscribers()) {
+            upstreamEventIt->second->publishEvent(vshl::utilities::json::JsonHandle::copy(payload));
+        }
+        // Let the capability know about it, even if nobody listens yet, it
+        // launches the app that subscribes.
         mCapability->onMessagePublished(action);
         return true;
     }
 
     auto downstreamEventIt = mDownstreamEventsMap.find(action);
     if (downstreamEventIt != mDownstreamEventsMap.end()) {
-        mLogger->log(Level::NOTICE, TAG, "Publishing downstream event: " + action);
-        downstreamEventIt->second->publishEvent(json_object_new_string(payload.c_str()));
+        if (downstreamEventIt->second->hasSubscribers()) {
+            downstreamEventIt->second->publishEvent(vshl::utilities::json::JsonHandle::copy(payload));
+        }
         return true;
     }
 
@@ -56,8 +56,7 @@ void GuiMetadata::onMessagePublished(const string action) {
     if (action == GUIMETADATA_RENDER_TEMPLATE) {
         mLogger->log(Level::INFO, TAG, "GuiMetadata::onMessagePublished, Launcing GUIMetada app.");
         if (mAppController != nullptr) {
-            mAppController->startApp(APP_NAME, VERSION_NAME);
-            mAppController->displayApp(APP_NAME, VERSION_NAME);
+            mAppController->startAndDisplayApp(APP_NAME, VERSION_NAME);
         }
     }
 }
@@ -56,8 +56,7 @@ void Navigation::onMessagePublished(const string action) {
     if (action == NAVIGATION_SET_DESTINATION) {
         mLogger->log(Level::INFO, TAG, "Navigation::onMessagePublished, Launcing Navigation app.");
         if (mAppController != nullptr) {
-            mAppController->startApp(APP_NAME, VERSION_NAME);
-            mAppController->displayApp(APP_NAME, VERSION_NAME);
+            mAppController->startAndDisplayApp(APP_NAME, VERSION_NAME);
         }
     }
 }
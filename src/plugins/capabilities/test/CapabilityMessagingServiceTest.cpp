@@ -14,6 +14,8 @@
  */
 #include <gtest/gtest.h>
 
+#include <json-c/json.h>
+
 #include "capabilities/CapabilityMessagingService.h"
 
 #include "test/common/ConsoleLogger.h"
@@ -92,5 +94,98 @@ TEST_F(CapabilityMessagingServiceTest, canSubscribeAndPublishCapabilityEvents) {
     ASSERT_TRUE(result);
 }
 
+TEST_F(CapabilityMessagingServiceTest, canSubscribeAndPublishByCapabilityId) {
+    auto service = CapabilityMessagingService::create(mConsoleLogger, mAfbApi);
+
+    auto capability = std::make_shared<::testing::NiceMock<CapabilityMock>>();
+    std::list<std::string> upstreamEvents({"up-ev1", "up-ev2"});
+    std::list<std::string> downstreamEvents({"down-ev1", "down-ev2"});
+    std::string capabilityName = "weather";
+
+    ON_CALL(*capability, getName()).WillByDefault(::testing::Return(capabilityName));
+    ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
+    ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(downstreamEvents));
+
+    std::shared_ptr<AFBEventMock> mockEvent(new ::testing::NiceMock<AFBEventMock>());
+    ON_CALL(*mockEvent, subscribe(::testing::_)).WillByDefault(::testing::Return(true));
+    ON_CALL(*mockEvent, publishEvent(::testing::_)).WillByDefault(::testing::Return(true));
+    auto eventCreator = [mockEvent](const std::string& eventName) -> std::shared_ptr<IAFBApi::IAFBEvent> {
+        mockEvent->setName(eventName);
+        return mockEvent;
+    };
+
+    ON_CALL(*mAfbApi, createEvent(::testing::_)).WillByDefault(::testing::Invoke(eventCreator));
+
+    ASSERT_EQ(service->getCapabilityId(capabilityName), -1);
+
+    int capabilityId = service->registerCapability(capability);
+    ASSERT_NE(capabilityId, -1);
+    ASSERT_EQ(service->getCapabilityId(capabilityName), capabilityId);
+
+    // Registering the same capability again returns the same id.
+    ASSERT_EQ(service->registerCapability(capability), capabilityId);
+
+    auto request = std::make_shared<::testing::StrictMock<AFBRequestMock>>();
+    std::string payload = "The answer to life the universe and everything = 42";
+
+    ASSERT_TRUE(service->subscribe(*request, capabilityId, *upstreamEvents.begin()));
+    ASSERT_TRUE(service->publish(capabilityId, *downstreamEvents.begin(), payload));
+
+    // Registered capabilities can still be used by reference.
+    ASSERT_TRUE(service->publish(capability, *downstreamEvents.begin(), payload));
+
+    // Unknown ids are rejected.
+    ASSERT_FALSE(service->subscribe(*request, capabilityId + 1, *upstreamEvents.begin()));
+    ASSERT_FALSE(service->publish(-1, *downstreamEvents.begin(), payload));
+}
+
+TEST_F(CapabilityMessagingServiceTest, structuredPayloadsArePublishedAsIs) {
+    auto service = CapabilityMessagingService::create(mConsoleLogger, mAfbApi);
+
+    auto capability = std::make_shared<::testing::NiceMock<CapabilityMock>>();
+    std::list<std::string> upstreamEvents({"up-ev1"});
+    std::list<std::string> downstreamEvents({"down-ev1"});
+
+    ON_CALL(*capability, getName()).WillByDefault(::testing::Return("guimetadata"));
+    ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
+    ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(downstreamEvents));
+
+    std::vector<json_object*> publishedPayloads;
+    std::shared_ptr<AFBEventMock> mockEvent(new ::testing::NiceMock<AFBEventMock>());
+    ON_CALL(*mockEvent, publishEvent(::testing::_))
+        .WillByDefault(::testing::Invoke([&publishedPayloads](json_object* payload) {
+            publishedPayloads.push_back(payload);
+            return 1;
+        }));
+    auto eventCreator = [mockEvent](const std::string& eventName) -> std::shared_ptr<IAFBApi::IAFBEvent> {
+        return mockEvent;
+    };
+
+    ON_CALL(*mAfbApi, createEvent(::testing::_)).WillByDefault(::testing::Invoke(eventCreator));
+
+    int capabilityId = service->registerCapability(capability);
+    ASSERT_NE(capabilityId, -1);
+
+    json_object* payload = json_tokener_parse("{\"title\":{\"mainTitle\":\"Weather\"},\"items\":[1,2,3]}");
+    ASSERT_TRUE(service->publish(capabilityId, *upstreamEvents.begin(), payload));
+
+    // Subscribers get a copy of the object, not a string holding its serialization.
+    ASSERT_EQ(publishedPayloads.size(), 1);
+    ASSERT_NE(publishedPayloads[0], payload);
+    ASSERT_TRUE(json_object_is_type(publishedPayloads[0], json_type_object));
+    ASSERT_STREQ(json_object_to_json_string(publishedPayloads[0]), json_object_to_json_string(payload));
+
+    // Legacy string payloads are still forwarded as strings.
+    ASSERT_TRUE(service->publish(capabilityId, *upstreamEvents.begin(), std::string("legacy")));
+    ASSERT_EQ(publishedPayloads.size(), 2);
+    ASSERT_TRUE(json_object_is_type(publishedPayloads[1], json_type_string));
+    ASSERT_STREQ(json_object_get_string(publishedPayloads[1]), "legacy");
+
+    for (auto publishedPayload : publishedPayloads) {
+        json_object_put(publishedPayload);
+    }
+    json_object_put(payload);
+}
+
 }  // namespace test
 }  // namespace vshl
\ No newline at end of file
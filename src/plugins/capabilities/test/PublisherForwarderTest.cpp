@@ -94,6 +94,8 @@ TEST_F(PublisherForwarderTest, canForwardMessages) {
     std::list<std::string> downstreamEvents({"down-ev1", "down-ev2"});
     ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
     ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(downstreamEvents));
+    // Only upstream messages are reported back to the capability.
+    EXPECT_CALL(*capability, onMessagePublished(::testing::_)).Times(2);
 
     auto publisherForwarder = createPublisherForwarder(capability);
     ASSERT_NE(publisherForwarder, nullptr);
@@ -101,7 +103,7 @@ TEST_F(PublisherForwarderTest, canForwardMessages) {
     auto subscriberForwarder = createSubscriberForwarder(capability);
     ASSERT_NE(subscriberForwarder, nullptr);
 
-    std::string payload = "The answer to life the universe and everything = 42";
+    json_object* payload = json_object_new_string("The answer to life the universe and everything = 42");
     publisherForwarder->setSubscriberForwarder(subscriberForwarder);
 
     auto itCapability = downstreamEvents.begin();
@@ -110,6 +112,7 @@ TEST_F(PublisherForwarderTest, canForwardMessages) {
     itCapability = upstreamEvents.begin();
     ASSERT_TRUE(publisherForwarder->forwardMessage(*itCapability++, payload));
     ASSERT_TRUE(publisherForwarder->forwardMessage(*itCapability++, payload));
+    json_object_put(payload);
 }
 
 }  // namespace test
@@ -139,7 +139,6 @@ TEST_F(SubscriberForwarderTest, canNotSubscribeOnEventCreationFailure) {
 
     auto itCapability = downstreamEvents.begin();
     auto request = std::make_shared<::testing::StrictMock<AFBRequestMock>>();
-    std::string payload = "The answer to life the universe and everything = 42";
     ASSERT_FALSE(forwarder->subscribe(*request, *itCapability++));
     ASSERT_FALSE(forwarder->subscribe(*request, *itCapability++));
     itCapability = upstreamEvents.begin();
@@ -198,10 +197,12 @@ TEST_F(SubscriberForwarderTest, canNotPublishNonExistentEvents) {
     ASSERT_NE(forwarder, nullptr);
 
     auto nonExistentEvents = std::list<std::string>({"non", "existent", "events"});
+    json_object* payload = json_object_new_string("My-Payload");
     auto itCapability = nonExistentEvents.begin();
-    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, "My-Payload"));
-    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, "My-Payload"));
-    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, "My-Payload"));
+    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
+    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
+    ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
+    json_object_put(payload);
 }
 
 TEST_F(SubscriberForwarderTest, canNotPublishOnEventCreationFailure) {
@@ -220,12 +221,13 @@ TEST_F(SubscriberForwarderTest, canNotPublishOnEventCreationFailure) {
     ASSERT_NE(forwarder, nullptr);
 
     auto itCapability = downstreamEvents.begin();
-    std::string payload = "The answer to life the universe and everything = 42";
+    json_object* payload = json_object_new_string("The answer to life the universe and everything = 42");
     ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
     ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
     itCapability = upstreamEvents.begin();
     ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
     ASSERT_FALSE(forwarder->forwardMessage(*itCapability++, payload));
+    json_object_put(payload);
 }
 
 TEST_F(SubscriberForwarderTest, canPublishEvents) {
@@ -245,17 +247,81 @@ TEST_F(SubscriberForwarderTest, canPublishEvents) {
     auto capability = std::make_shared<::testing::StrictMock<CapabilityMock>>();
     ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
     ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(downstreamEvents));
+    // Only upstream messages are reported back to the capability.
+    EXPECT_CALL(*capability, onMessagePublished(::testing::_)).Times(2);
 
     auto forwarder = createSubscriberForwarder(capability);
     ASSERT_NE(forwarder, nullptr);
 
     auto itCapability = downstreamEvents.begin();
-    std::string payload = "The answer to life the universe and everything = 42";
+    json_object* payload = json_object_new_string("The answer to life the universe and everything = 42");
     ASSERT_TRUE(forwarder->forwardMessage(*itCapability++, payload));
     ASSERT_TRUE(forwarder->forwardMessage(*itCapability++, payload));
     itCapability = upstreamEvents.begin();
     ASSERT_TRUE(forwarder->forwardMessage(*itCapability++, payload));
     ASSERT_TRUE(forwarder->forwardMessage(*itCapability++, payload));
+    json_object_put(payload);
+}
+
+TEST_F(SubscriberForwarderTest, forwardsCopyOfPayload) {
+    json_object* payload = json_object_new_string("The answer to life the universe and everything = 42");
+    json_object* publishedPayload = nullptr;
+
+    std::shared_ptr<AFBEventMock> mockEvent(new ::testing::StrictMock<AFBEventMock>());
+    EXPECT_CALL(*mockEvent, publishEvent(::testing::_))
+        .WillOnce(::testing::DoAll(::testing::SaveArg<0>(&publishedPayload), ::testing::Return(1)));
+    auto eventCreator = [mockEvent](const std::string& eventName) -> std::shared_ptr<IAFBApi::IAFBEvent> {
+        return mockEvent;
+    };
+
+    ON_CALL(*mAfbApi, createEvent(::testing::_)).WillByDefault(::testing::Invoke(eventCreator));
+    EXPECT_CALL(*mAfbApi, createEvent(::testing::_)).Times(1);
+
+    std::list<std::string> upstreamEvents({"up-ev1"});
+    auto capability = std::make_shared<::testing::StrictMock<CapabilityMock>>();
+    ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
+    ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(std::list<std::string>()));
+    EXPECT_CALL(*capability, onMessagePublished(::testing::_)).Times(1);
+
+    auto forwarder = createSubscriberForwarder(capability);
+    ASSERT_NE(forwarder, nullptr);
+
+    // The published event gets a copy, the caller keeps the only reference on its payload.
+    ASSERT_TRUE(forwarder->forwardMessage("up-ev1", payload));
+    ASSERT_NE(publishedPayload, payload);
+    ASSERT_STREQ(json_object_get_string(publishedPayload), json_object_get_string(payload));
+    ASSERT_EQ(json_object_put(publishedPayload), 1);
+    ASSERT_EQ(json_object_put(payload), 1);
+}
+
+TEST_F(SubscriberForwarderTest, skipsPublishingEventsNobodyListensTo) {
+    json_object* payload = json_object_new_string("The answer to life the universe and everything = 42");
+
+    std::shared_ptr<AFBEventMock> mockEvent(new ::testing::StrictMock<AFBEventMock>());
+    mockEvent->setHasSubscribers(false);
+    EXPECT_CALL(*mockEvent, publishEvent(::testing::_)).Times(0);
+    auto eventCreator = [mockEvent](const std::string& eventName) -> std::shared_ptr<IAFBApi::IAFBEvent> {
+        return mockEvent;
+    };
+
+    ON_CALL(*mAfbApi, createEvent(::testing::_)).WillByDefault(::testing::Invoke(eventCreator));
+    EXPECT_CALL(*mAfbApi, createEvent(::testing::_)).Times(2);
+
+    std::list<std::string> upstreamEvents({"up-ev1"});
+    std::list<std::string> downstreamEvents({"down-ev1"});
+    auto capability = std::make_shared<::testing::StrictMock<CapabilityMock>>();
+    ON_CALL(*capability, getUpstreamMessages()).WillByDefault(::testing::Return(upstreamEvents));
+    ON_CALL(*capability, getDownstreamMessages()).WillByDefault(::testing::Return(downstreamEvents));
+    // The capability still hears of upstream messages, it launches the app that subscribes.
+    EXPECT_CALL(*capability, onMessagePublished(::testing::_)).Times(1);
+
+    auto forwarder = createSubscriberForwarder(capability);
+    ASSERT_NE(forwarder, nullptr);
+
+    // No reference is taken on the payload.
+    ASSERT_TRUE(forwarder->forwardMessage("up-ev1", payload));
+    ASSERT_TRUE(forwarder->forwardMessage("down-ev1", payload));
+    ASSERT_EQ(json_object_put(payload), 1);
 }
 
 }  // namespace test
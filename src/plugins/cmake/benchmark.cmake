@@ -0,0 +1,33 @@
+# Google benchmark
+
+find_package(Threads REQUIRED)
+
+# Enable ExternalProject CMake module
+INCLUDE(ExternalProject)
+
+ExternalProject_Add(
+    benchmark
+    URL https://github.com/google/benchmark/archive/v1.4.1.zip
+    SOURCE_DIR "${CMAKE_BINARY_DIR}/benchmark-src"
+    BINARY_DIR "${CMAKE_BINARY_DIR}/benchmark-build"
+    CMAKE_ARGS -DCMAKE_BUILD_TYPE=Release -DBENCHMARK_ENABLE_TESTING=OFF
+    INSTALL_COMMAND ""
+    LOG_DOWNLOAD ON
+    LOG_CONFIGURE ON
+    LOG_BUILD ON
+)
+
+# Get benchmark source and binary directories from CMake project
+ExternalProject_Get_Property(benchmark source_dir binary_dir)
+
+# Create a libbenchmark target to be used as a dependency by benchmark programs
+ADD_LIBRARY(libbenchmark INTERFACE)
+TARGET_INCLUDE_DIRECTORIES(libbenchmark
+    INTERFACE
+        ${source_dir}/include
+)
+TARGET_LINK_LIBRARIES(libbenchmark
+    INTERFACE
+        ${binary_dir}/src/libbenchmark.a
+        ${CMAKE_THREAD_LIBS_INIT}
+)
@@ -15,6 +15,7 @@
 #ifndef VSHL_CORE_INCLUDE_VR_REQUESTPROCESSOR_H_
 #define VSHL_CORE_INCLUDE_VR_REQUESTPROCESSOR_H_
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -44,6 +45,22 @@ public:
     // is returned.
     string startListening();
 
+    // Called with the outcome of an asynchronous start listening request.
+    using StartListeningCallback = function<
+        void(const string& requestId, const string& voiceAgentId, bool started, const string& error)>;
+
+    // Same as @c startListening, but returns as soon as the request is
+    // created. @c onCompleted receives the outcome of the voiceagent call.
+    string startListeningAsync(StartListeningCallback onCompleted);
+
+    // Same as @c startListening and @c startListeningAsync, but the request
+    // goes to @c voiceAgent, e.g. the one that owns a detected wakeword,
+    // rather than to the default voiceagent.
+    string startListening(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent);
+    string startListeningAsync(
+        shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent,
+        StartListeningCallback onCompleted);
+
     // Cancels all the active requests
     void cancel();
 
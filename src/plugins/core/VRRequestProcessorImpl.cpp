@@ -52,10 +52,48 @@ string VRRequestProcessor::startListening() {
         return "";
     }
 
+    return startListening(defaultVA);
+}
+
+string VRRequestProcessor::startListening(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) {
+    if (!voiceAgent) {
+        mLogger->log(Level::ERROR, TAG, "Failed to start. No voiceagent.");
+        return "";
+    }
+
     // If the requests container is not empty, then clear the
     // existing requests in flight and create a new request.
     mDelegate->cancelAllRequests();
-    return mDelegate->startRequestForVoiceAgent(defaultVA);
+    return mDelegate->startRequestForVoiceAgent(voiceAgent);
+}
+
+string VRRequestProcessor::startListeningAsync(StartListeningCallback onCompleted) {
+    shared_ptr<vshl::common::interfaces::IVoiceAgent> defaultVA = mDelegate->getDefaultVoiceAgent();
+    if (!defaultVA) {
+        mLogger->log(Level::ERROR, TAG, "Failed to start. No default voiceagent found.");
+        return "";
+    }
+
+    return startListeningAsync(defaultVA, onCompleted);
+}
+
+string VRRequestProcessor::startListeningAsync(
+    shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent,
+    StartListeningCallback onCompleted) {
+    if (!voiceAgent) {
+        mLogger->log(Level::ERROR, TAG, "Failed to start. No voiceagent.");
+        return "";
+    }
+
+    mDelegate->cancelAllRequests();
+
+    string voiceAgentId = voiceAgent->getId();
+    return mDelegate->startRequestForVoiceAgentAsync(
+        voiceAgent, [onCompleted, voiceAgentId](const string& requestId, bool started, const string& error) {
+            if (onCompleted) {
+                onCompleted(requestId, voiceAgentId, started, error);
+            }
+        });
 }
 
 void VRRequestProcessor::cancel() {
@@ -52,6 +52,8 @@ protected:
       shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) override;
   void OnVoiceAgentDeactivated(
       shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) override;
+  void OnVoiceAgentUpdated(
+      shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) override;
 
 private:
   // Constructor
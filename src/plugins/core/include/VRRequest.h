@@ -15,6 +15,7 @@
 #ifndef VSHL_CORE_INCLUDE_VR_REQUEST_H_
 #define VSHL_CORE_INCLUDE_VR_REQUEST_H_
 
+#include <functional>
 #include <memory>
 
 #include "interfaces/afb/IAFBApi.h"
@@ -45,12 +46,23 @@ public:
     // Destructor
     ~VRRequest();
 
-    // Invokes the underlying voiceagent's startlistening API.
-    // Returns true if started successfully. False otherwise.
+    // Called with the outcome of an asynchronous start. @c error is
+    // empty when the voiceagent started listening.
+    using StartListeningCallback = function<void(const string& requestId, bool started, const string& error)>;
+
+    // Invokes the underlying voiceagent's startlistening API without
+    // blocking on its reply. Returns true if the call was issued.
     bool startListening();
 
-    // Cancels the voice recognition in the unlerlying voiceagent.
-    // Returns true if canceled successfully. False otherwise.
+    // Invokes the underlying voiceagent's startlistening API without
+    // waiting for its reply. @c onCompleted receives the outcome.
+    void startListeningAsync(StartListeningCallback onCompleted);
+
+    // Returns the request ID.
+    string getRequestId() const;
+
+    // Cancels the voice recognition in the unlerlying voiceagent without
+    // blocking on its reply. Returns true if the call was issued.
     bool cancel();
 
 private:
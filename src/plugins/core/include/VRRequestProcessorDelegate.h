@@ -16,6 +16,7 @@
 #define VSHL_CORE_INCLUDE_VR_REQUESTPROCESSORDELEGATE_H_
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "core/include/VRRequest.h"
@@ -56,6 +57,13 @@ public:
     // voiceagent is called.
     string startRequestForVoiceAgent(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent);
 
+    // Same as @c startRequestForVoiceAgent, but the request is added right
+    // away and the voiceagent is not waited for. @c onCompleted receives
+    // the outcome of the voiceagent's startlistening call.
+    string startRequestForVoiceAgentAsync(
+        shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent,
+        VRRequest::StartListeningCallback onCompleted);
+
     // Cancel all requests
     void cancelAllRequests();
 
@@ -72,6 +80,9 @@ private:
     // Binding API reference
     shared_ptr<vshl::common::interfaces::IAFBApi> mApi;
 
+    // Guards the default voiceagent and the requests, verbs may run concurrently.
+    mutable mutex mMutex;
+
     // Default voiceagent
     shared_ptr<vshl::common::interfaces::IVoiceAgent> mDefaultVoiceAgent;
 
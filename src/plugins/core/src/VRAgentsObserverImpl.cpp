@@ -50,5 +50,15 @@ void VRAgentsObserver::OnVoiceAgentActivated(shared_ptr<vshl::common::interfaces
 
 void VRAgentsObserver::OnVoiceAgentDeactivated(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) {
 }
+
+void VRAgentsObserver::OnVoiceAgentUpdated(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) {
+    if (auto delegate = mWeakDelegate.lock()) {
+        // Requests must go to the reloaded default voiceagent.
+        auto defaultVoiceAgent = delegate->getDefaultVoiceAgent();
+        if (defaultVoiceAgent && defaultVoiceAgent->getId() == voiceAgent->getId()) {
+            delegate->setDefaultVoiceAgent(voiceAgent);
+        }
+    }
+}
 }  // namespace core
 }  // namespace vshl
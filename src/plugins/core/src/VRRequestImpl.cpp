@@ -14,19 +14,10 @@
  */
 #include "core/include/VRRequest.h"
 
-#define FREEIF(x) \
-    if (!x) {     \
-        free(x);  \
-    }
-#define BREAKIF(x)      \
-    if (x) {            \
-        result = false; \
-        break;          \
-    }
-
 static string TAG = "vshl::core::VRRequest";
 
 using Level = vshl::common::interfaces::ILogger::Level;
+using vshl::utilities::json::JsonHandle;
 
 namespace vshl {
 namespace core {
@@ -67,23 +58,47 @@ VRRequest::~VRRequest() {
 }
 
 bool VRRequest::startListening() {
-    json_object* object = NULL;
-    std::string error, info;
-    bool result = true;
-    int rc = mApi->callSync(mVoiceAgent->getApi(), VA_VERB_STARTLISTENING, NULL, &object, error, info);
-
-    FREEIF(object);
+    // Nothing waits for the voiceagent's reply, so failures are only logged.
+    auto logger = mLogger;
+    startListeningAsync([logger](const string& requestId, bool started, const string& error) {
+        if (!started) {
+            logger->log(Level::WARNING, TAG, "Failed to start listening for request: " + requestId + ", " + error);
+        }
+    });
 
     return true;
 }
 
-bool VRRequest::cancel() {
-    json_object* object = NULL;
-    std::string error, info;
-    bool result = true;
-    int rc = mApi->callSync(mVoiceAgent->getApi(), VA_VERB_CANCEL, NULL, &object, error, info);
+void VRRequest::startListeningAsync(StartListeningCallback onCompleted) {
+    // The completion may outlive this request, so it only captures values.
+    string requestId = mRequestId;
+    mApi->callAsync(
+        mVoiceAgent->getApi(),
+        VA_VERB_STARTLISTENING,
+        JsonHandle(),
+        [onCompleted, requestId](int rc, json_object* result, const string& error, const string& info) {
+            if (onCompleted) {
+                onCompleted(requestId, rc == 0, rc == 0 ? "" : error);
+            }
+        });
+}
+
+string VRRequest::getRequestId() const {
+    return mRequestId;
+}
 
-    FREEIF(object);
+bool VRRequest::cancel() {
+    auto logger = mLogger;
+    string requestId = mRequestId;
+    mApi->callAsync(
+        mVoiceAgent->getApi(),
+        VA_VERB_CANCEL,
+        JsonHandle(),
+        [logger, requestId](int rc, json_object* result, const string& error, const string& info) {
+            if (rc != 0) {
+                logger->log(Level::WARNING, TAG, "Failed to cancel request: " + requestId + ", " + error);
+            }
+        });
 
     return true;
 }
@@ -58,34 +58,65 @@ string VRRequestProcessorDelegate::startRequestForVoiceAgent(
     }
 
     // Insert only if its started successfully.
+    lock_guard<mutex> lock(mMutex);
     mVRRequests.insert(make_pair(voiceAgent->getId(), newRequest));
 
     return newReqId;
 }
 
+string VRRequestProcessorDelegate::startRequestForVoiceAgentAsync(
+    shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent,
+    VRRequest::StartListeningCallback onCompleted) {
+    if (!mApi) {
+        mLogger->log(
+            Level::ERROR, TAG, "Failed to startRequestForVoiceAgentAsync: " + voiceAgent->getId() + ", No API.");
+        return "";
+    }
+
+    // Generate a new request ID.
+    string newReqId = vshl::utilities::uuid::generateUUID();
+
+    // Create a new request and track it before the voiceagent answers,
+    // so that it can be cancelled in the meantime.
+    shared_ptr<VRRequest> newRequest = VRRequest::create(mLogger, mApi, newReqId, voiceAgent);
+    {
+        lock_guard<mutex> lock(mMutex);
+        mVRRequests.insert(make_pair(voiceAgent->getId(), newRequest));
+    }
+
+    newRequest->startListeningAsync(onCompleted);
+
+    return newReqId;
+}
+
 void VRRequestProcessorDelegate::cancelAllRequests() {
+    // Take the pending requests out first, cancelling them calls the voiceagents.
+    unordered_map<string, shared_ptr<VRRequest>> vrRequests;
+    {
+        lock_guard<mutex> lock(mMutex);
+        vrRequests.swap(mVRRequests);
+    }
+
     // Cancel Pending requests
-    if (!mVRRequests.empty()) {
-        auto vrRequestsIt = mVRRequests.begin();
-        while (vrRequestsIt != mVRRequests.end()) {
-            if (!vrRequestsIt->second->cancel()) {
-                mLogger->log(Level::WARNING, TAG, "Failed to cancel request: " + vrRequestsIt->first);
-            }
-            vrRequestsIt++;
+    for (auto vrRequest : vrRequests) {
+        if (!vrRequest.second->cancel()) {
+            mLogger->log(Level::WARNING, TAG, "Failed to cancel request: " + vrRequest.first);
         }
-        mVRRequests.clear();
     }
 }
 
 unordered_map<string, shared_ptr<VRRequest>> VRRequestProcessorDelegate::getAllRequests() {
+    lock_guard<mutex> lock(mMutex);
     return mVRRequests;
 }
 
 void VRRequestProcessorDelegate::setDefaultVoiceAgent(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent) {
+    lock_guard<mutex> lock(mMutex);
     mDefaultVoiceAgent = voiceAgent;
 }
 
 shared_ptr<vshl::common::interfaces::IVoiceAgent> VRRequestProcessorDelegate::getDefaultVoiceAgent() const {
+    lock_guard<mutex> lock(mMutex);
     return mDefaultVoiceAgent;
 }
 
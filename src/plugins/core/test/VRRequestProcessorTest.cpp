@@ -22,6 +22,7 @@
 #include "test/common/ConsoleLogger.h"
 #include "test/mocks/AFBApiMock.h"
 
+using namespace vshl::common::interfaces;
 using namespace vshl::core;
 using namespace vshl::voiceagents;
 using namespace vshl::test::common;
@@ -34,6 +35,7 @@ protected:
     void SetUp() override {
         mConsoleLogger = std::make_shared<ConsoleLogger>();
         mAfbApi = std::make_shared<::testing::StrictMock<AFBApiMock>>();
+        mAfbApi->delegateCallAsyncToCallSync();
 
         auto vaTestData = *(getVoiceAgentsTestData().begin());
         mVoiceAgent = VoiceAgent::create(
@@ -68,6 +70,44 @@ TEST_F(VRRequestProcessorTest, startListeningFailsOnLackOfDefaultAgent) {
     ASSERT_EQ(requestId, "");
 }
 
+TEST_F(VRRequestProcessorTest, startListeningOnVoiceAgentNeedsNoDefaultAgent) {
+    {
+        ::testing::InSequence dummy;
+
+        EXPECT_CALL(
+            *mAfbApi,
+            callSync(
+                mVoiceAgent->getApi(),
+                VRRequest::VA_VERB_STARTLISTENING,
+                ::testing::_,
+                ::testing::_,
+                ::testing::_,
+                ::testing::_))
+            .Times(1);
+
+        // Cancelled on destruction.
+        EXPECT_CALL(
+            *mAfbApi,
+            callSync(
+                mVoiceAgent->getApi(),
+                VRRequest::VA_VERB_CANCEL,
+                ::testing::_,
+                ::testing::_,
+                ::testing::_,
+                ::testing::_))
+            .Times(1);
+    }
+
+    auto requestId = mVRRequestProcessor->startListening(mVoiceAgent);
+    ASSERT_NE(requestId, "");
+
+    auto requests = mVRReqProcessorDelegate->getAllRequests();
+    ASSERT_EQ(requests.size(), 1);
+    ASSERT_EQ(requests.begin()->first, mVoiceAgent->getId());
+
+    ASSERT_EQ(mVRRequestProcessor->startListening(nullptr), "");
+}
+
 TEST_F(VRRequestProcessorTest, startListeningAndCancelWorks) {
     mVRReqProcessorDelegate->setDefaultVoiceAgent(mVoiceAgent);
 
@@ -209,5 +249,48 @@ TEST_F(VRRequestProcessorTest, backToBackStartListeningCancelsEarlierRequest) {
     ASSERT_EQ(requests.size(), 0);
 }
 
+TEST_F(VRRequestProcessorTest, startListeningAsyncReportsOutcomeLater) {
+    mVRReqProcessorDelegate->setDefaultVoiceAgent(mVoiceAgent);
+
+    IAFBApi::CallCompletion completion;
+    EXPECT_CALL(
+        *mAfbApi,
+        callAsync(mVoiceAgent->getApi(), VRRequest::VA_VERB_STARTLISTENING, ::testing::_, ::testing::_, ::testing::_))
+        .WillOnce(::testing::SaveArg<4>(&completion));
+    EXPECT_CALL(
+        *mAfbApi,
+        callSync(
+            mVoiceAgent->getApi(), VRRequest::VA_VERB_CANCEL, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+        .Times(1);
+
+    int completions = 0;
+    std::string completedRequestId, completedVoiceAgentId, completedError;
+    bool completedStarted = true;
+    auto requestId = mVRRequestProcessor->startListeningAsync(
+        [&](const std::string& requestId, const std::string& voiceAgentId, bool started, const std::string& error) {
+            ++completions;
+            completedRequestId = requestId;
+            completedVoiceAgentId = voiceAgentId;
+            completedStarted = started;
+            completedError = error;
+        });
+
+    // The request is tracked before the voiceagent answers.
+    ASSERT_NE(requestId, "");
+    ASSERT_EQ(completions, 0);
+    ASSERT_EQ(mVRReqProcessorDelegate->getAllRequests().size(), 1);
+
+    ASSERT_TRUE(completion);
+    completion(-1, nullptr, "timeout", "");
+    ASSERT_EQ(completions, 1);
+    ASSERT_EQ(completedRequestId, requestId);
+    ASSERT_EQ(completedVoiceAgentId, mVoiceAgent->getId());
+    ASSERT_FALSE(completedStarted);
+    ASSERT_EQ(completedError, "timeout");
+
+    mVRRequestProcessor->cancel();
+    ASSERT_EQ(mVRReqProcessorDelegate->getAllRequests().size(), 0);
+}
+
 }  // namespace test
 }  // namespace vshl
\ No newline at end of file
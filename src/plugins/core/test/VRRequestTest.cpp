@@ -36,6 +36,7 @@ protected:
 
         mConsoleLogger = std::make_shared<ConsoleLogger>();
         mAfbApi = std::make_shared<::testing::StrictMock<AFBApiMock>>();
+        mAfbApi->delegateCallAsyncToCallSync();
 
         auto vaTestData = *(getVoiceAgentsTestData().begin());
         mVoiceAgent = VoiceAgent::create(
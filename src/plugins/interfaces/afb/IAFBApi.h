@@ -15,11 +15,15 @@
 #ifndef VSHL_COMMON_INTERFACES_AFBAPI_H_
 #define VSHL_COMMON_INTERFACES_AFBAPI_H_
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 
 #include <json-c/json_object.h>
 
+#include "utilities/json/JsonHandle.h"
+
 using namespace std;
 
 namespace vshl {
@@ -40,6 +44,12 @@ public:
 /**
  * Interface to encapsulate all AFB (AGL Application Framework Binding)
  * functions.
+ *
+ * json-c reference counts are not atomic, so a json object is only used by
+ * one thread at a time. An object handed to the binder, published, replied,
+ * or kept for later by a timer or a job, is either one whose last reference
+ * the caller gives up, or a deep copy, see @c JsonHandle::copy. Never a new
+ * reference on an object the caller, or the binder, keeps using.
  */
 class IAFBApi {
 public:
@@ -59,11 +69,19 @@ public:
         virtual bool isValid() = 0;
 
         /**
-         * Publish event to all observers.
+         * Publish event to all observers. The payload is consumed.
          *
          * @return The number of observers that received the event.
          */
-        virtual int publishEvent(struct json_object* payload) = 0;
+        virtual int publishEvent(vshl::utilities::json::JsonHandle payload) = 0;
+
+        /**
+         * Returns false if nobody listens to the event, so that callers can
+         * skip building its payload as well as publishing it. A false answer
+         * counts as a skipped push. It may be true after the last subscriber
+         * went away, until the next publish finds out.
+         */
+        virtual bool hasSubscribers() = 0;
 
         /**
          * Subscribe to the event
@@ -80,15 +98,65 @@ public:
         virtual bool unsubscribe(IAFBRequest& request) = 0;
     };
 
+    /**
+     * Completion of an asynchronous call.
+     *
+     * @c rc 0 on success, negative on failure.
+     * @c result Reply of the called verb, only valid during the callback.
+     * @c error Error status, empty on success.
+     * @c info Informational message of the reply.
+     */
+    using CallCompletion = std::function<
+        void(int rc, struct json_object* result, const std::string& error, const std::string& info)>;
+
     virtual std::shared_ptr<IAFBEvent> createEvent(const std::string& eventName) = 0;
 
+    /**
+     * Calls the verb and waits for its reply, which is stored in @c result.
+     * The request is consumed.
+     *
+     * This is a thin wrapper over the binder's synchronous call, deadlines do
+     * not apply to it. Verbs and completions, which run on binder threads, use
+     * @c callAsync instead.
+     */
     virtual int callSync(
         const std::string& api,
         const std::string& verb,
-        struct json_object* request,
-        struct json_object** result,
+        vshl::utilities::json::JsonHandle request,
+        vshl::utilities::json::JsonHandle& result,
         std::string& error,
         std::string& info) = 0;
+
+    /**
+     * Calls the verb without waiting for its reply. @c completion is
+     * invoked once with the outcome, possibly from another thread.
+     * The request is consumed, as for @c callSync.
+     *
+     * If no reply arrived by @c deadline, the call is abandoned and
+     * completes with an error, a reply arriving later is dropped. A zero
+     * deadline uses the default deadline of the target API, if any.
+     */
+    virtual void callAsync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        std::chrono::milliseconds deadline,
+        CallCompletion completion) = 0;
+
+    // Calls the verb with the default deadline of the target API.
+    void callAsync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        CallCompletion completion) {
+        callAsync(api, verb, std::move(request), std::chrono::milliseconds::zero(), completion);
+    }
+
+    /**
+     * Runs @c job on the binder's job queue, so that work started from
+     * threads of our own, such as timers, runs on a binder thread.
+     */
+    virtual void queueJob(std::function<void()> job) = 0;
 };
 
 }  // namespace interfaces
@@ -37,6 +37,11 @@ public:
    */
   virtual bool displayApp(const string& name, const string& version) = 0;
 
+  /**
+   * start the application and display it once it is started.
+   */
+  virtual bool startAndDisplayApp(const string& name, const string& version) = 0;
+
   /**
    * Virtual destructor to assure proper cleanup of derived types.
    */
@@ -17,6 +17,8 @@
 
 #include <string>
 
+#include <json-c/json.h>
+
 using namespace std;
 
 namespace vshl {
@@ -33,7 +35,9 @@ public:
 
     // Every event filter needs to implement this method and
     // return true if consuming the event or false otherwise.
-    virtual bool onIncomingEvent(const string eventName, const string voiceAgentId, const string payload) = 0;
+    // The payload is borrowed, filters that keep or forward it must
+    // take their own reference with json_object_get.
+    virtual bool onIncomingEvent(const string& eventName, const string& voiceAgentId, json_object* payload) = 0;
 
     // Destructor
     virtual ~IEventFilter() = default;
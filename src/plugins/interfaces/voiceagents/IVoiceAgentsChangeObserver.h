@@ -67,6 +67,13 @@ public:
    */
   virtual void OnVoiceAgentDeactivated(shared_ptr<IVoiceAgent> voiceAgent) = 0;
 
+  /**
+   * This method notifies the observers that the configuration of a voiceagent
+   * has been reloaded with new values. @c voiceAgent replaces the voiceagent
+   * with the same id.
+   */
+  virtual void OnVoiceAgentUpdated(shared_ptr<IVoiceAgent> voiceAgent) = 0;
+
   /**
    * Virtual destructor to assure proper cleanup of derived types.
    */
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "VshlApi.h"
+#include "bench/fakes/FakeBinder.h"
+
+using namespace vshl::bench::fakes;
+
+namespace vshl {
+namespace test {
+
+static const char* VOICEAGENTS_CONFIG =
+    "{\"default\": \"VA-001\", \"agents\": [{"
+    "\"id\": \"VA-001\", \"active\": true, \"name\": \"Alexa\", \"api\": \"alexa-voiceagent\","
+    "\"wakewords\": [\"alexa\", \"computer\", \"echo\"], \"activewakeword\": \"alexa\","
+    "\"description\": \"Alexa voice assistant by Amazon.\", \"vendor\": \"Amazon.com Services Inc\"}]}";
+
+static const char* VOICEAGENT_API = "alexa-voiceagent";
+
+static const char* GUI_METADATA_PRIVILEGE = "urn:AGL:permission:vshl:guiMetadata:public";
+
+static const std::chrono::milliseconds REPLY_TIMEOUT(5000);
+
+static const std::chrono::milliseconds VOICEAGENT_LATENCY(20);
+
+static int succeed(json_object* args, json_object** result, std::string& error) {
+    *result = json_object_new_object();
+    return 0;
+}
+
+static int fail(json_object* args, json_object** result, std::string& error) {
+    error = "busy";
+    return -1;
+}
+
+/*
+ * Drives the verbs of VshlApi.cpp end to end through a FakeBinder. The plugin
+ * keeps its state in statics, so it is loaded once for all the tests and its
+ * binder is never destroyed.
+ */
+class VshlApiTest : public ::testing::Test {
+protected:
+    static void SetUpTestCase() {
+        if (sBinder != nullptr) {
+            return;
+        }
+
+        sBinder = FakeBinder::create("vshl", 2).release();
+        sBinder->setTarget(VOICEAGENT_API, "subscribe", succeed);
+        sBinder->setTarget(VOICEAGENT_API, "startSubscriptionProcess", succeed);
+        sBinder->setTarget(VOICEAGENT_API, "startListening", succeed);
+        sBinder->setTargetLatency(VOICEAGENT_API, VOICEAGENT_LATENCY);
+        CtlPluginT plugin;
+        memset(&plugin, 0, sizeof(plugin));
+        plugin.api = sBinder->getApi();
+        ASSERT_EQ(CtlPluginOnload(&plugin, nullptr), 0);
+
+        json_object* configJ = json_tokener_parse(VOICEAGENTS_CONFIG);
+        ASSERT_EQ(sBinder->callAction(loadVoiceAgentsConfig, configJ, nullptr), 0);
+        json_object_put(configJ);
+    }
+
+    void TearDown() override {
+        sBinder->setPermissionGranted(GUI_METADATA_PRIVILEGE, true);
+        sBinder->setTarget(VOICEAGENT_API, "startListening", succeed);
+    }
+
+    // Calls @c verb with the request @c query on behalf of @c clientId.
+    static void callVerb(FakeBinder::Verb verb, const char* query, int clientId, FakeBinder::Reply& reply) {
+        json_object* queryJ = json_tokener_parse(query);
+        ASSERT_TRUE(sBinder->callVerb(verb, nullptr, queryJ, clientId, reply, REPLY_TIMEOUT));
+        json_object_put(queryJ);
+    }
+
+    // Returns the result of the batch operation @c idx in @c reply.
+    static json_object* getBatchResult(const FakeBinder::Reply& reply, size_t idx) {
+        json_object* resultsJ = nullptr;
+        if (!json_object_object_get_ex(reply.object, "results", &resultsJ) ||
+            idx >= json_object_array_length(resultsJ)) {
+            return nullptr;
+        }
+        return json_object_array_get_idx(resultsJ, idx);
+    }
+
+    // Returns the integer member @c name of the statistics of @c verb, as replied by the stats verb.
+    static int64_t getVerbStat(const char* verb, const char* name) {
+        FakeBinder::Reply reply;
+        callVerb(stats, "{}", 0, reply);
+        json_object* verbsJ = nullptr;
+        json_object* verbJ = nullptr;
+        json_object* statJ = nullptr;
+        if (!json_object_object_get_ex(reply.object, "verbs", &verbsJ) ||
+            !json_object_object_get_ex(verbsJ, verb, &verbJ) || !json_object_object_get_ex(verbJ, name, &statJ)) {
+            return 0;
+        }
+        return json_object_get_int64(statJ);
+    }
+
+    // Returns the string member @c name of @c objectJ, or an empty string.
+    static std::string getString(json_object* objectJ, const char* name) {
+        json_object* memberJ = nullptr;
+        if (!json_object_object_get_ex(objectJ, name, &memberJ)) {
+            return "";
+        }
+        return json_object_get_string(memberJ);
+    }
+
+    static FakeBinder* sBinder;
+};
+
+FakeBinder* VshlApiTest::sBinder = nullptr;
+
+TEST_F(VshlApiTest, batchRunsEveryOperationPastAFailingOne) {
+    uint64_t pushCount = sBinder->getPushCount("vshl/render_template");
+    uint64_t deliveryCount = sBinder->getDeliveryCount("vshl/render_template");
+
+    FakeBinder::Reply reply;
+    callVerb(
+        batch,
+        "{\"operations\": ["
+        "{\"capability\": \"guimetadata\", \"op\": \"subscribe\", \"actions\": [\"render_template\"]},"
+        "{\"capability\": \"guimetadata\", \"op\": \"unsubscribe\"},"
+        "{\"capability\": \"guimetadata\", \"op\": \"publish\", \"action\": \"render_template\","
+        " \"payload\": {\"title\": \"Weather\"}}"
+        "]}",
+        1,
+        reply);
+    ASSERT_TRUE(reply.isSuccess());
+
+    json_object* subscribeJ = getBatchResult(reply, 0);
+    ASSERT_EQ(getString(subscribeJ, "status"), "success");
+    ASSERT_FALSE(json_object_object_get_ex(subscribeJ, "error", nullptr));
+
+    json_object* unknownOpJ = getBatchResult(reply, 1);
+    ASSERT_EQ(getString(unknownOpJ, "status"), "failed");
+    ASSERT_EQ(getString(unknownOpJ, "error"), "Unknown op: unsubscribe");
+
+    json_object* publishJ = getBatchResult(reply, 2);
+    ASSERT_EQ(getString(publishJ, "status"), "success");
+    ASSERT_EQ(getBatchResult(reply, 3), nullptr);
+
+    // The publish reached the client the batch subscribed.
+    ASSERT_EQ(sBinder->getPushCount("vshl/render_template"), pushCount + 1);
+    ASSERT_GE(sBinder->getDeliveryCount("vshl/render_template"), deliveryCount + 1);
+}
+
+TEST_F(VshlApiTest, batchReportsSubscriptionsLeftByPartialSubscribe) {
+    FakeBinder::Reply reply;
+    callVerb(
+        batch,
+        "{\"operations\": ["
+        "{\"capability\": \"guimetadata\", \"op\": \"subscribe\","
+        " \"actions\": [\"clear_template\", \"render_player_info\", \"no_such_action\", \"clear_player_info\"]},"
+        "{\"capability\": \"guimetadata\", \"op\": \"subscribe\", \"actions\": [\"no_such_action\"]}"
+        "]}",
+        2,
+        reply);
+    ASSERT_TRUE(reply.isSuccess());
+
+    json_object* partialJ = getBatchResult(reply, 0);
+    ASSERT_EQ(getString(partialJ, "status"), "failed");
+    ASSERT_EQ(getString(partialJ, "error"), "Failed to subscribe to event: no_such_action");
+    json_object* subscribedJ = nullptr;
+    ASSERT_TRUE(json_object_object_get_ex(partialJ, "subscribed", &subscribedJ));
+    ASSERT_EQ(json_object_array_length(subscribedJ), 2);
+    ASSERT_STREQ(json_object_get_string(json_object_array_get_idx(subscribedJ, 0)), "clear_template");
+    ASSERT_STREQ(json_object_get_string(json_object_array_get_idx(subscribedJ, 1)), "render_player_info");
+
+    // Nothing was subscribed, so there is nothing to report.
+    json_object* failedJ = getBatchResult(reply, 1);
+    ASSERT_EQ(getString(failedJ, "status"), "failed");
+    ASSERT_FALSE(json_object_object_get_ex(failedJ, "subscribed", nullptr));
+}
+
+TEST_F(VshlApiTest, batchRejectsUnknownCapabilitiesAndDeniedPermissions) {
+    sBinder->setPermissionGranted(GUI_METADATA_PRIVILEGE, false);
+
+    FakeBinder::Reply reply;
+    callVerb(
+        batch,
+        "{\"operations\": ["
+        "{\"capability\": \"weather\", \"op\": \"subscribe\", \"actions\": [\"forecast\"]},"
+        "{\"capability\": \"guimetadata\", \"op\": \"subscribe\", \"actions\": [\"render_template\"]},"
+        "{\"capability\": \"navigation\", \"op\": \"subscribe\", \"actions\": [\"set_destination\"]}"
+        "]}",
+        3,
+        reply);
+    ASSERT_TRUE(reply.isSuccess());
+
+    json_object* unknownJ = getBatchResult(reply, 0);
+    ASSERT_EQ(getString(unknownJ, "status"), "failed");
+    ASSERT_EQ(getString(unknownJ, "error"), "Unknown capability: weather");
+
+    json_object* deniedJ = getBatchResult(reply, 1);
+    ASSERT_EQ(getString(deniedJ, "status"), "failed");
+    ASSERT_EQ(getString(deniedJ, "error"), "Permission denied for capability: guimetadata");
+
+    ASSERT_EQ(getString(getBatchResult(reply, 2), "status"), "success");
+}
+
+TEST_F(VshlApiTest, startListeningIsRecordedOnceTheVoiceagentReplied) {
+    int64_t calls = getVerbStat("startListening", "calls");
+    int64_t failures = getVerbStat("startListening", "failures");
+
+    FakeBinder::Reply reply;
+    callVerb(startListening, "{}", 1, reply);
+    ASSERT_TRUE(reply.isSuccess());
+
+    ASSERT_EQ(getVerbStat("startListening", "calls"), calls + 1);
+    ASSERT_EQ(getVerbStat("startListening", "failures"), failures);
+    ASSERT_GE(
+        getVerbStat("startListening", "max_us"),
+        std::chrono::duration_cast<std::chrono::microseconds>(VOICEAGENT_LATENCY).count());
+}
+
+TEST_F(VshlApiTest, startListeningFailuresRepliedByTheVerbAreRecordedAsFailures) {
+    int64_t calls = getVerbStat("startListening", "calls");
+    int64_t failures = getVerbStat("startListening", "failures");
+
+    // Failed by the verb itself.
+    FakeBinder::Reply unknownWakewordReply;
+    callVerb(startListening, "{\"wakeword\": \"jarvis\"}", 1, unknownWakewordReply);
+    ASSERT_FALSE(unknownWakewordReply.isSuccess());
+
+    // Failed by the voiceagent, once it replied.
+    sBinder->setTarget(VOICEAGENT_API, "startListening", fail);
+    FakeBinder::Reply voiceAgentFailedReply;
+    callVerb(startListening, "{}", 1, voiceAgentFailedReply);
+    ASSERT_FALSE(voiceAgentFailedReply.isSuccess());
+
+    ASSERT_EQ(getVerbStat("startListening", "calls"), calls + 2);
+    ASSERT_EQ(getVerbStat("startListening", "failures"), failures + 2);
+}
+
+}  // namespace test
+}  // namespace vshl
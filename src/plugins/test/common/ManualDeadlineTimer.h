@@ -0,0 +1,97 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_TEST_COMMON_MANUAL_DEADLINE_TIMER_H_
+#define VSHL_TEST_COMMON_MANUAL_DEADLINE_TIMER_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "utilities/timer/DeadlineTimer.h"
+
+namespace vshl {
+namespace test {
+namespace common {
+
+/*
+ * DeadlineTimer driven by the test. Its clock only moves on advance, which
+ * runs the callbacks that became due on the calling thread.
+ */
+class ManualDeadlineTimer : public vshl::utilities::timer::DeadlineTimer {
+public:
+    static std::shared_ptr<ManualDeadlineTimer> create() {
+        return std::shared_ptr<ManualDeadlineTimer>(new ManualDeadlineTimer());
+    }
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback) override {
+        std::lock_guard<std::mutex> lock(mMutex);
+        TimerId timerId = mNextTimerId++;
+        mCallbacks.emplace(std::make_pair(mNow + delay, timerId), std::move(callback));
+        return timerId;
+    }
+
+    bool cancel(TimerId timerId) override {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto callbackIt = mCallbacks.begin(); callbackIt != mCallbacks.end(); ++callbackIt) {
+            if (callbackIt->first.second == timerId) {
+                mCallbacks.erase(callbackIt);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the clock forward by @c elapsed, running the callbacks due meanwhile in deadline order.
+    void advance(std::chrono::milliseconds elapsed) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto until = mNow + elapsed;
+        while (!mCallbacks.empty() && mCallbacks.begin()->first.first <= until) {
+            auto earliestIt = mCallbacks.begin();
+            mNow = earliestIt->first.first;
+            Callback callback = std::move(earliestIt->second);
+            mCallbacks.erase(earliestIt);
+
+            lock.unlock();
+            callback();
+            callback = nullptr;
+            lock.lock();
+        }
+        mNow = until;
+    }
+
+private:
+    ManualDeadlineTimer() : mNow(0), mNextTimerId(1) {
+    }
+
+    // Guards everything below.
+    std::mutex mMutex;
+
+    // Time elapsed since the timer was made.
+    std::chrono::milliseconds mNow;
+
+    // Pending callbacks ordered by deadline.
+    std::map<std::pair<std::chrono::milliseconds, TimerId>, Callback> mCallbacks;
+
+    // Next timer id.
+    TimerId mNextTimerId;
+};
+
+}  // namespace common
+}  // namespace test
+}  // namespace vshl
+
+#endif  // VSHL_TEST_COMMON_MANUAL_DEADLINE_TIMER_H_
@@ -22,6 +22,11 @@
 namespace vshl {
 namespace test {
 
+/*
+ * gmock can't mock methods taking move-only arguments, so the calls are
+ * forwarded to mocked overloads taking the raw objects, which get the
+ * references the handles owned.
+ */
 class AFBApiMock : public vshl::common::interfaces::IAFBApi {
 public:
     MOCK_METHOD1(createEvent, std::shared_ptr<IAFBEvent>(const std::string& eventName));
@@ -33,6 +38,72 @@ public:
             struct json_object** result,
             std::string& error,
             std::string& info));
+    MOCK_METHOD5(
+        callAsync,
+        void(const std::string& api,
+             const std::string& verb,
+             struct json_object* request,
+             std::chrono::milliseconds deadline,
+             CallCompletion completion));
+
+    using IAFBApi::callAsync;
+
+    int callSync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        vshl::utilities::json::JsonHandle& result,
+        std::string& error,
+        std::string& info) override {
+        struct json_object* resultObject = nullptr;
+        int rc = callSync(api, verb, request.release(), &resultObject, error, info);
+        result.reset(resultObject);
+        return rc;
+    }
+
+    void callAsync(
+        const std::string& api,
+        const std::string& verb,
+        vshl::utilities::json::JsonHandle request,
+        std::chrono::milliseconds deadline,
+        CallCompletion completion) override {
+        callAsync(api, verb, request.release(), deadline, completion);
+    }
+
+    // Runs the job right away, on the calling thread.
+    void queueJob(std::function<void()> job) override {
+        job();
+    }
+
+    /**
+     * Completes every @c callAsync right away with the outcome of @c callSync,
+     * so tests can keep expressing their expectations on @c callSync. The
+     * request is released once the mocked @c callSync returned.
+     */
+    void delegateCallAsyncToCallSync() {
+        ON_CALL(*this, callAsync(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault(::testing::Invoke([this](
+                                                 const std::string& api,
+                                                 const std::string& verb,
+                                                 struct json_object* request,
+                                                 std::chrono::milliseconds deadline,
+                                                 CallCompletion completion) {
+                struct json_object* result = nullptr;
+                std::string error, info;
+                int rc = callSync(api, verb, request, &result, error, info);
+                if (request) {
+                    json_object_put(request);
+                }
+                if (completion) {
+                    completion(rc, result, error, info);
+                }
+                if (result) {
+                    json_object_put(result);
+                }
+            }));
+        EXPECT_CALL(*this, callAsync(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(::testing::AnyNumber());
+    }
 };
 
 }  // namespace test
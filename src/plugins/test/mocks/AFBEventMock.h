@@ -32,13 +32,27 @@ public:
         return mName;
     }
 
+    void setHasSubscribers(bool hasSubscribers) {
+        mHasSubscribers = hasSubscribers;
+    }
+
+    bool hasSubscribers() override {
+        return mHasSubscribers;
+    }
+
     MOCK_METHOD0(isValid, bool());
+    // Forwarded to the mocked overload, which gets the reference on the payload.
+    int publishEvent(vshl::utilities::json::JsonHandle payload) override {
+        return publishEvent(payload.release());
+    }
+
     MOCK_METHOD1(publishEvent, int(struct json_object* payload));
     MOCK_METHOD1(subscribe, bool(vshl::common::interfaces::IAFBRequest& request));
     MOCK_METHOD1(unsubscribe, bool(vshl::common::interfaces::IAFBRequest& request));
 
 private:
     std::string mName;
+    bool mHasSubscribers = true;
 };
 
 }  // namespace test
@@ -27,6 +27,7 @@ public:
     MOCK_CONST_METHOD0(getName, std::string());
     MOCK_CONST_METHOD0(getUpstreamMessages, std::list<std::string>());
     MOCK_CONST_METHOD0(getDownstreamMessages, std::list<std::string>());
+    MOCK_METHOD1(onMessagePublished, void(const std::string action));
 };
 
 }  // namespace test
@@ -30,6 +30,7 @@ public:
     MOCK_METHOD1(OnVoiceAgentActiveWakeWordChanged, void(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent));
     MOCK_METHOD1(OnVoiceAgentActivated, void(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent));
     MOCK_METHOD1(OnVoiceAgentDeactivated, void(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent));
+    MOCK_METHOD1(OnVoiceAgentUpdated, void(shared_ptr<vshl::common::interfaces::IVoiceAgent> voiceAgent));
 };
 
 }  // namespace test
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/events/EventCoalescer.h"
+
+#include "utilities/json/JsonHelpers.h"
+
+static string JSON_ATTR_STATE = "state";
+
+using namespace vshl::utilities::json;
+using namespace vshl::utilities::timer;
+
+namespace vshl {
+namespace utilities {
+namespace events {
+
+shared_ptr<EventCoalescer> EventCoalescer::create(
+    shared_ptr<DeadlineTimer> timer,
+    const CoalescingPolicy& policy,
+    Push push,
+    Dispatch dispatch) {
+    if (timer == nullptr || push == nullptr) {
+        return nullptr;
+    }
+
+    return shared_ptr<EventCoalescer>(new EventCoalescer(timer, policy, push, dispatch));
+}
+
+EventCoalescer::EventCoalescer(
+    shared_ptr<DeadlineTimer> timer,
+    const CoalescingPolicy& policy,
+    Push push,
+    Dispatch dispatch) :
+        mTimer(timer),
+        mPolicy(policy),
+        mPush(push),
+        mDispatch(dispatch),
+        mWindowOpen(false),
+        mWindowTimerId(0) {
+}
+
+EventCoalescer::~EventCoalescer() {
+    if (mWindowOpen) {
+        mTimer->cancel(mWindowTimerId);
+    }
+}
+
+void EventCoalescer::onEvent(json_object* payload) {
+    lock_guard<mutex> lock(mMutex);
+    if (!mWindowOpen) {
+        mPush(JsonHandle::copy(payload));
+        openWindow();
+        return;
+    }
+
+    if (isCritical(payload)) {
+        // The critical payload supersedes the coalesced one.
+        mPending.reset();
+        mPush(JsonHandle::copy(payload));
+        return;
+    }
+
+    mPending = JsonHandle::copy(payload);
+}
+
+bool EventCoalescer::isCritical(json_object* payload) const {
+    string state;
+    if (!vshl::utilities::json::getString(payload, JSON_ATTR_STATE, state)) {
+        return false;
+    }
+
+    return mPolicy.criticalStates.find(state) != mPolicy.criticalStates.end();
+}
+
+void EventCoalescer::openWindow() {
+    weak_ptr<EventCoalescer> weakSelf = shared_from_this();
+    Dispatch dispatch = mDispatch;
+    mWindowOpen = true;
+    mWindowTimerId = mTimer->schedule(mPolicy.window, [weakSelf, dispatch]() {
+        auto windowEnd = [weakSelf]() {
+            auto self = weakSelf.lock();
+            if (self) {
+                self->onWindowEnd();
+            }
+        };
+
+        if (dispatch) {
+            dispatch(windowEnd);
+        } else {
+            windowEnd();
+        }
+    });
+}
+
+void EventCoalescer::onWindowEnd() {
+    lock_guard<mutex> lock(mMutex);
+    if (!mPending) {
+        mWindowOpen = false;
+        return;
+    }
+
+    mPush(std::move(mPending));
+    openWindow();
+}
+
+}  // namespace events
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_EVENTS_EVENTCOALESCER_H_
+#define VSHL_UTILITIES_EVENTS_EVENTCOALESCER_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include <json-c/json.h>
+
+#include "utilities/json/JsonHandle.h"
+#include "utilities/timer/DeadlineTimer.h"
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace events {
+
+/*
+ * How the payloads of a high frequency event are coalesced.
+ */
+struct CoalescingPolicy {
+    // Payloads arriving within this window of a push are coalesced, only the
+    // last one is pushed when the window ends.
+    chrono::milliseconds window;
+
+    // Payloads whose "state" member is one of these are pushed right away,
+    // superseding any coalesced payload.
+    unordered_set<string> criticalStates;
+};
+
+/*
+ * Coalesces the payloads of one event, last value wins. The first payload
+ * is pushed right away and opens a window, payloads arriving within the
+ * window replace each other and the last one is pushed when it ends, which
+ * opens the next window. Critical payloads are never delayed.
+ *
+ * The end of a window is handed to the dispatcher, if any, so that its push
+ * doesn't run on the timer's thread.
+ */
+class EventCoalescer : public enable_shared_from_this<EventCoalescer> {
+public:
+    // Pushes a payload.
+    using Push = function<void(vshl::utilities::json::JsonHandle payload)>;
+
+    // Runs a job on another thread, e.g. queues it on the binder.
+    using Dispatch = function<void(function<void()> job)>;
+
+    // Create an EventCoalescer. Without a dispatcher, windows end on the timer's thread.
+    static shared_ptr<EventCoalescer> create(
+        shared_ptr<vshl::utilities::timer::DeadlineTimer> timer,
+        const CoalescingPolicy& policy,
+        Push push,
+        Dispatch dispatch = nullptr);
+
+    // Pushes or coalesces a payload. The payload is borrowed, what is pushed or
+    // kept for the end of the window is a copy of it, see IAFBApi.h.
+    void onEvent(json_object* payload);
+
+    // Destructor. A coalesced payload not pushed yet is dropped.
+    ~EventCoalescer();
+
+private:
+    // Constructor
+    EventCoalescer(
+        shared_ptr<vshl::utilities::timer::DeadlineTimer> timer,
+        const CoalescingPolicy& policy,
+        Push push,
+        Dispatch dispatch);
+
+    // Returns true if the payload is a critical transition.
+    bool isCritical(json_object* payload) const;
+
+    // Opens a new window. Called with the lock held.
+    void openWindow();
+
+    // Called when the window ends, through the dispatcher if any.
+    void onWindowEnd();
+
+    // Timer ending the windows.
+    shared_ptr<vshl::utilities::timer::DeadlineTimer> mTimer;
+
+    // Policy
+    CoalescingPolicy mPolicy;
+
+    // Pushes the payloads.
+    Push mPush;
+
+    // Runs the ends of the windows, may be null.
+    Dispatch mDispatch;
+
+    // Guards everything below. Held while pushing so that pushes keep their order.
+    mutex mMutex;
+
+    // Whether a window is open, and the timer that ends it.
+    bool mWindowOpen;
+    vshl::utilities::timer::DeadlineTimer::TimerId mWindowTimerId;
+
+    // Last payload received within the window, not pushed yet.
+    vshl::utilities::json::JsonHandle mPending;
+};
+
+}  // namespace events
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_EVENTS_EVENTCOALESCER_H_
@@ -33,7 +33,7 @@ EventRouter::~EventRouter() {
     mEventFilters.clear();
 }
 
-bool EventRouter::handleIncomingEvent(const string eventName, const string voiceAgentId, const string payload) {
+bool EventRouter::handleIncomingEvent(const string& eventName, const string& voiceAgentId, json_object* payload) {
     for (auto eventFilter : mEventFilters) {
         if (eventFilter->onIncomingEvent(eventName, voiceAgentId, payload)) {
             return true;
@@ -19,6 +19,8 @@
 #include <string>
 #include <unordered_set>
 
+#include <json-c/json.h>
+
 #include "interfaces/utilities/events/IEventFilter.h"
 #include "interfaces/utilities/logging/ILogger.h"
 
@@ -46,8 +48,8 @@ public:
     bool removeEventFilter(shared_ptr<vshl::common::interfaces::IEventFilter> filter);
 
     // This method is called by the controller for routing
-    // the event to appropriate listener.
-    bool handleIncomingEvent(const string eventName, const string voiceAgentId, const string payload);
+    // the event to appropriate listener. The payload is borrowed.
+    bool handleIncomingEvent(const string& eventName, const string& voiceAgentId, json_object* payload);
 
 private:
     EventRouter(shared_ptr<vshl::common::interfaces::ILogger> logger);
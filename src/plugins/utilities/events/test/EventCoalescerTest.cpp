@@ -0,0 +1,146 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <vector>
+
+#include "test/common/ManualDeadlineTimer.h"
+#include "utilities/events/EventCoalescer.h"
+#include "utilities/json/JsonHelpers.h"
+
+using namespace vshl::test::common;
+using namespace vshl::utilities::events;
+
+namespace vshl {
+namespace test {
+
+class EventCoalescerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mTimer = ManualDeadlineTimer::create();
+        mPolicy.window = std::chrono::milliseconds(100);
+        mPolicy.criticalStates = {"IDLE"};
+    }
+
+    std::shared_ptr<EventCoalescer> createCoalescer(EventCoalescer::Dispatch dispatch = nullptr) {
+        return EventCoalescer::create(
+            mTimer,
+            mPolicy,
+            [this](vshl::utilities::json::JsonHandle payload) {
+                std::string state;
+                vshl::utilities::json::getString(payload.get(), "state", state);
+                mPushedStates.push_back(state);
+            },
+            dispatch);
+    }
+
+    void onEvent(std::shared_ptr<EventCoalescer> coalescer, const std::string& state) {
+        json_object* payload = json_object_new_object();
+        vshl::utilities::json::addString(payload, "state", state);
+        coalescer->onEvent(payload);
+        json_object_put(payload);
+    }
+
+    std::shared_ptr<ManualDeadlineTimer> mTimer;
+    CoalescingPolicy mPolicy;
+    std::vector<std::string> mPushedStates;
+};
+
+TEST_F(EventCoalescerTest, firstPayloadIsPushedRightAway) {
+    auto coalescer = createCoalescer();
+
+    onEvent(coalescer, "THINKING");
+
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING"}));
+}
+
+TEST_F(EventCoalescerTest, lastPayloadOfTheWindowWins) {
+    auto coalescer = createCoalescer();
+
+    onEvent(coalescer, "THINKING");
+    onEvent(coalescer, "SPEAKING");
+    onEvent(coalescer, "THINKING");
+    onEvent(coalescer, "SPEAKING");
+    mTimer->advance(mPolicy.window - std::chrono::milliseconds(1));
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING"}));
+
+    mTimer->advance(std::chrono::milliseconds(1));
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "SPEAKING"}));
+}
+
+TEST_F(EventCoalescerTest, keepsNoReferenceOnTheCallersPayload) {
+    auto coalescer = createCoalescer();
+
+    // The pushed payload and the one coalesced until the end of the window are copies.
+    for (auto state : {"THINKING", "SPEAKING"}) {
+        json_object* payload = json_object_new_object();
+        vshl::utilities::json::addString(payload, "state", state);
+        coalescer->onEvent(payload);
+        ASSERT_EQ(json_object_put(payload), 1);
+    }
+
+    mTimer->advance(mPolicy.window);
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "SPEAKING"}));
+}
+
+TEST_F(EventCoalescerTest, criticalPayloadSupersedesCoalescedOne) {
+    auto coalescer = createCoalescer();
+
+    onEvent(coalescer, "THINKING");
+    onEvent(coalescer, "SPEAKING");
+    onEvent(coalescer, "IDLE");
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "IDLE"}));
+
+    // Nothing is left to push when the window ends, the next payload opens a new window.
+    mTimer->advance(mPolicy.window * 2);
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "IDLE"}));
+
+    onEvent(coalescer, "LISTENING");
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "IDLE", "LISTENING"}));
+}
+
+TEST_F(EventCoalescerTest, windowEndIsDispatched) {
+    std::vector<std::function<void()>> jobs;
+    auto coalescer = createCoalescer([&jobs](std::function<void()> job) { jobs.push_back(job); });
+
+    onEvent(coalescer, "THINKING");
+    onEvent(coalescer, "SPEAKING");
+    mTimer->advance(mPolicy.window);
+
+    // The timer only hands the end of the window over.
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING"}));
+    ASSERT_EQ(jobs.size(), 1);
+
+    jobs.front()();
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING", "SPEAKING"}));
+}
+
+TEST_F(EventCoalescerTest, windowEndOfReleasedCoalescerPushesNothing) {
+    std::vector<std::function<void()>> jobs;
+    auto coalescer = createCoalescer([&jobs](std::function<void()> job) { jobs.push_back(job); });
+
+    onEvent(coalescer, "THINKING");
+    onEvent(coalescer, "SPEAKING");
+    mTimer->advance(mPolicy.window);
+    coalescer.reset();
+
+    ASSERT_EQ(jobs.size(), 1);
+    jobs.front()();
+    ASSERT_EQ(mPushedStates, std::vector<std::string>({"THINKING"}));
+}
+
+}  // namespace test
+}  // namespace vshl
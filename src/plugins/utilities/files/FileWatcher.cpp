@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/files/FileWatcher.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+
+// Changes that leave the file with a new content.
+static const uint32_t WATCHED_CHANGES = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+namespace vshl {
+namespace utilities {
+namespace files {
+
+std::unique_ptr<FileWatcher> FileWatcher::create(const string& path, Callback callback) {
+    if (path.empty() || !callback) {
+        return nullptr;
+    }
+
+    string directory = ".";
+    string fileName = path;
+    size_t separator = path.find_last_of('/');
+    if (separator != string::npos) {
+        directory = separator == 0 ? "/" : path.substr(0, separator);
+        fileName = path.substr(separator + 1);
+    }
+    if (fileName.empty()) {
+        return nullptr;
+    }
+
+    int inotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotifyFd < 0) {
+        return nullptr;
+    }
+
+    if (inotify_add_watch(inotifyFd, directory.c_str(), WATCHED_CHANGES) < 0) {
+        close(inotifyFd);
+        return nullptr;
+    }
+
+    int stopFd = eventfd(0, EFD_CLOEXEC);
+    if (stopFd < 0) {
+        close(inotifyFd);
+        return nullptr;
+    }
+
+    return std::unique_ptr<FileWatcher>(new FileWatcher(inotifyFd, stopFd, fileName, std::move(callback)));
+}
+
+FileWatcher::FileWatcher(int inotifyFd, int stopFd, const string& fileName, Callback callback) :
+        mInotifyFd(inotifyFd),
+        mStopFd(stopFd),
+        mFileName(fileName),
+        mCallback(std::move(callback)) {
+    mThread = thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+    // Writing an event fd only fails on overflow, which a single write can't cause.
+    uint64_t stop = 1;
+    ssize_t written = write(mStopFd, &stop, sizeof(stop));
+    (void)written;
+    mThread.join();
+
+    close(mStopFd);
+    close(mInotifyFd);
+}
+
+void FileWatcher::run() {
+    // Large enough for several events with a file name of NAME_MAX.
+    alignas(struct inotify_event) char buffer[4096 + sizeof(struct inotify_event) + NAME_MAX + 1];
+
+    struct pollfd fds[2];
+    fds[0].fd = mInotifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = mStopFd;
+    fds[1].events = POLLIN;
+
+    while (true) {
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+
+        // Drain the pending events, the file changed if one of them is about it.
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(mInotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                auto event = reinterpret_cast<struct inotify_event*>(cursor);
+                if ((event->mask & WATCHED_CHANGES) != 0 && event->len > 0 && mFileName == event->name) {
+                    changed = true;
+                }
+                cursor += sizeof(struct inotify_event) + event->len;
+            }
+        }
+
+        if (changed) {
+            mCallback();
+        }
+    }
+}
+
+}  // namespace files
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_FILES_FILEWATCHER_H_
+#define VSHL_UTILITIES_FILES_FILEWATCHER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace files {
+/*
+ * Watches a file with inotify and runs a callback each time it is written or
+ * replaced, e.g. by an editor that renames a new file over it. The directory
+ * of the file is watched, so the file doesn't need to exist yet. Changes are
+ * reported on a worker thread owned by the watcher, changes that happen
+ * together are reported once.
+ */
+class FileWatcher {
+public:
+    using Callback = function<void()>;
+
+    /**
+     * Starts watching the file at @c path.
+     *
+     * @return The watcher, or nullptr if the directory of the file can't be watched.
+     */
+    static std::unique_ptr<FileWatcher> create(const string& path, Callback callback);
+
+    // Destructor. Stops watching. Must not run on the worker thread, i.e. from the callback.
+    ~FileWatcher();
+
+private:
+    // Constructor
+    FileWatcher(int inotifyFd, int stopFd, const string& fileName, Callback callback);
+
+    // Worker thread loop.
+    void run();
+
+    // Inotify instance watching the directory of the file.
+    int mInotifyFd;
+
+    // Event fd signalled on destruction.
+    int mStopFd;
+
+    // Name of the file within its directory.
+    string mFileName;
+
+    // Run on each change.
+    Callback mCallback;
+
+    // Worker thread.
+    thread mThread;
+};
+
+}  // namespace files
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_FILES_FILEWATCHER_H_
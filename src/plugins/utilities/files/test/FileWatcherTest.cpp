@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+#include <unistd.h>
+
+#include "utilities/files/FileWatcher.h"
+
+using namespace vshl::utilities::files;
+
+namespace vshl {
+namespace test {
+
+class FileWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char directory[] = "/tmp/vshl-watcher-test-XXXXXX";
+        ASSERT_NE(mkdtemp(directory), nullptr);
+        mDirectory = directory;
+        mPath = mDirectory + "/voiceagents.json";
+        mChanges = 0;
+    }
+
+    void TearDown() override {
+        unlink(mPath.c_str());
+        unlink((mDirectory + "/other.json").c_str());
+        rmdir(mDirectory.c_str());
+    }
+
+    std::unique_ptr<FileWatcher> createWatcher() {
+        return FileWatcher::create(mPath, [this]() {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mChanges;
+            mCondition.notify_all();
+        });
+    }
+
+    // Waits until @c changes changes were reported.
+    bool waitForChanges(int changes) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCondition.wait_for(lock, std::chrono::seconds(5), [&]() { return mChanges >= changes; });
+    }
+
+    std::string mDirectory;
+    std::string mPath;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    int mChanges;
+};
+
+TEST_F(FileWatcherTest, reportsWritesOfTheWatchedFileOnly) {
+    auto watcher = createWatcher();
+    ASSERT_NE(watcher, nullptr);
+
+    std::ofstream(mDirectory + "/other.json") << "{}";
+    std::ofstream(mPath) << "{}";
+    ASSERT_TRUE(waitForChanges(1));
+
+    std::ofstream(mDirectory + "/other.json") << "{\"default\": \"VA-001\"}";
+    std::ofstream(mPath) << "{\"default\": \"VA-001\"}";
+    ASSERT_TRUE(waitForChanges(2));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    ASSERT_EQ(mChanges, 2);
+}
+
+TEST_F(FileWatcherTest, reportsFilesRenamedOverTheWatchedFile) {
+    auto watcher = createWatcher();
+    ASSERT_NE(watcher, nullptr);
+
+    std::string tmpPath = mPath + ".tmp";
+    std::ofstream(tmpPath) << "{}";
+    ASSERT_EQ(rename(tmpPath.c_str(), mPath.c_str()), 0);
+    ASSERT_TRUE(waitForChanges(1));
+}
+
+TEST_F(FileWatcherTest, failsToWatchMissingDirectory) {
+    mPath = mDirectory + "/missing/voiceagents.json";
+    ASSERT_EQ(createWatcher(), nullptr);
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/health/CircuitBreaker.h"
+
+using namespace vshl::utilities::timer;
+
+namespace vshl {
+namespace utilities {
+namespace health {
+
+std::shared_ptr<CircuitBreaker> CircuitBreaker::create(
+    shared_ptr<DeadlineTimer> timer,
+    const BreakerPolicy& policy,
+    Probe probe) {
+    return std::shared_ptr<CircuitBreaker>(new CircuitBreaker(timer, policy, probe));
+}
+
+CircuitBreaker::CircuitBreaker(shared_ptr<DeadlineTimer> timer, const BreakerPolicy& policy, Probe probe) :
+        mTimer(timer),
+        mPolicy(policy),
+        mProbe(probe),
+        mState(State::CLOSED),
+        mConsecutiveFailures(0),
+        mRejectedCalls(0),
+        mProbeTimerId(0) {
+}
+
+CircuitBreaker::~CircuitBreaker() {
+    auto timer = mTimer.lock();
+    if (timer && mProbeTimerId != 0) {
+        timer->cancel(mProbeTimerId);
+    }
+}
+
+bool CircuitBreaker::allowCall() {
+    lock_guard<mutex> lock(mMutex);
+    auto now = chrono::steady_clock::now();
+    switch (mState) {
+        case State::CLOSED:
+            return true;
+        case State::OPEN:
+            if (now - mOpenedAt >= mPolicy.openDuration) {
+                startProbe(now);
+                return true;
+            }
+            break;
+        case State::HALF_OPEN:
+            // A probe that never completed doesn't keep the breaker half open.
+            if (now - mProbeStartedAt >= mPolicy.openDuration) {
+                startProbe(now);
+                return true;
+            }
+            break;
+    }
+
+    ++mRejectedCalls;
+    return false;
+}
+
+void CircuitBreaker::onSuccess() {
+    lock_guard<mutex> lock(mMutex);
+    mState = State::CLOSED;
+    mConsecutiveFailures = 0;
+}
+
+void CircuitBreaker::onFailure() {
+    lock_guard<mutex> lock(mMutex);
+    ++mConsecutiveFailures;
+    if (mState == State::HALF_OPEN ||
+        (mState == State::CLOSED && mPolicy.failureThreshold > 0 &&
+         mConsecutiveFailures >= mPolicy.failureThreshold)) {
+        open();
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::getState() {
+    lock_guard<mutex> lock(mMutex);
+    return mState;
+}
+
+uint64_t CircuitBreaker::getRejectedCount() {
+    lock_guard<mutex> lock(mMutex);
+    return mRejectedCalls;
+}
+
+json_object* CircuitBreaker::toJson() {
+    lock_guard<mutex> lock(mMutex);
+    json_object* breakerJ = json_object_new_object();
+    json_object_object_add(breakerJ, "state", json_object_new_string(getStateName(mState).c_str()));
+    json_object_object_add(breakerJ, "consecutive_failures", json_object_new_int64(mConsecutiveFailures));
+    json_object_object_add(breakerJ, "rejected_calls", json_object_new_int64(mRejectedCalls));
+    return breakerJ;
+}
+
+string CircuitBreaker::getStateName(State state) {
+    switch (state) {
+        case State::CLOSED:
+            return "closed";
+        case State::OPEN:
+            return "open";
+        case State::HALF_OPEN:
+            return "half-open";
+    }
+    return "unknown";
+}
+
+void CircuitBreaker::open() {
+    mState = State::OPEN;
+    mOpenedAt = chrono::steady_clock::now();
+
+    auto timer = mTimer.lock();
+    if (!mProbe || !timer) {
+        return;
+    }
+
+    if (mProbeTimerId != 0) {
+        timer->cancel(mProbeTimerId);
+    }
+    weak_ptr<CircuitBreaker> weakThis = shared_from_this();
+    mProbeTimerId = timer->schedule(mPolicy.openDuration, [weakThis]() {
+        auto breaker = weakThis.lock();
+        if (breaker) {
+            breaker->onOpenDurationElapsed();
+        }
+    });
+}
+
+void CircuitBreaker::onOpenDurationElapsed() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mProbeTimerId = 0;
+        // A call may have been let through as the probe already.
+        if (mState != State::OPEN) {
+            return;
+        }
+        startProbe(chrono::steady_clock::now());
+    }
+
+    weak_ptr<CircuitBreaker> weakThis = shared_from_this();
+    mProbe([weakThis](bool healthy) {
+        auto breaker = weakThis.lock();
+        if (!breaker) {
+            return;
+        }
+
+        if (healthy) {
+            breaker->onSuccess();
+        } else {
+            breaker->onFailure();
+        }
+    });
+}
+
+void CircuitBreaker::startProbe(chrono::steady_clock::time_point now) {
+    mState = State::HALF_OPEN;
+    mProbeStartedAt = now;
+}
+
+}  // namespace health
+}  // namespace utilities
+}  // namespace vshl
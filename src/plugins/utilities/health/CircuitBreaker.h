@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_HEALTH_CIRCUITBREAKER_H_
+#define VSHL_UTILITIES_HEALTH_CIRCUITBREAKER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <json-c/json.h>
+
+#include "utilities/timer/DeadlineTimer.h"
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace health {
+
+/*
+ * When a circuit breaker opens, and for how long.
+ */
+struct BreakerPolicy {
+    // Consecutive failures that open the breaker, zero never opens it.
+    uint32_t failureThreshold;
+
+    // Time the breaker stays open before the API is probed again.
+    chrono::milliseconds openDuration;
+};
+
+/*
+ * Tracks the health of one downstream API, so that calls to an API known
+ * to be down fail fast instead of paying the failure latency.
+ *
+ * The breaker is closed while calls succeed. Once the consecutive failures
+ * reach the threshold it opens, and rejects calls. When the open duration
+ * elapsed it turns half open and lets a single probe through: a healthy
+ * probe closes the breaker, a failed one opens it again.
+ *
+ * With a probe function, the probe is sent in the background when the open
+ * duration elapsed. Without one, the first call made afterwards is the probe.
+ */
+class CircuitBreaker : public enable_shared_from_this<CircuitBreaker> {
+public:
+    enum class State { CLOSED, OPEN, HALF_OPEN };
+
+    // Probes the API and reports whether it is healthy, possibly from another thread.
+    using Probe = function<void(function<void(bool healthy)> done)>;
+
+    // Create a CircuitBreaker. @c probe may be empty.
+    static std::shared_ptr<CircuitBreaker> create(
+        shared_ptr<vshl::utilities::timer::DeadlineTimer> timer,
+        const BreakerPolicy& policy,
+        Probe probe);
+
+    // Destructor. A scheduled probe is dropped.
+    ~CircuitBreaker();
+
+    // Returns true if a call may be sent, false if it must fail fast. When
+    // true, the outcome of the call must be reported.
+    bool allowCall();
+
+    // Reports a call that reached the API.
+    void onSuccess();
+
+    // Reports a call that found the API unavailable.
+    void onFailure();
+
+    // Current state.
+    State getState();
+
+    // Number of calls rejected while open.
+    uint64_t getRejectedCount();
+
+    // Returns the state and counters as a new json object.
+    json_object* toJson();
+
+    // Name of @c state, as reported in json.
+    static string getStateName(State state);
+
+private:
+    // Constructor
+    CircuitBreaker(
+        shared_ptr<vshl::utilities::timer::DeadlineTimer> timer,
+        const BreakerPolicy& policy,
+        Probe probe);
+
+    // Opens the breaker and schedules the background probe. Called with mMutex held.
+    void open();
+
+    // Sends the background probe once the open duration elapsed.
+    void onOpenDurationElapsed();
+
+    // Lets a probe through. Called with mMutex held.
+    void startProbe(chrono::steady_clock::time_point now);
+
+    // Schedules the background probe. Weak, so that the timer doesn't keep
+    // the breaker alive nor is destroyed from its own thread.
+    weak_ptr<vshl::utilities::timer::DeadlineTimer> mTimer;
+
+    BreakerPolicy mPolicy;
+    Probe mProbe;
+
+    // Guards everything below.
+    mutex mMutex;
+
+    State mState;
+    uint32_t mConsecutiveFailures;
+    uint64_t mRejectedCalls;
+
+    // When the breaker opened, and when the probe in flight was let through.
+    chrono::steady_clock::time_point mOpenedAt;
+    chrono::steady_clock::time_point mProbeStartedAt;
+
+    // Scheduled background probe, 0 if none.
+    vshl::utilities::timer::DeadlineTimer::TimerId mProbeTimerId;
+};
+
+}  // namespace health
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_HEALTH_CIRCUITBREAKER_H_
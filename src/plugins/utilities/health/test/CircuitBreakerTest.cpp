@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+
+#include "utilities/health/CircuitBreaker.h"
+
+using namespace vshl::utilities::health;
+using namespace vshl::utilities::timer;
+
+namespace vshl {
+namespace test {
+
+class CircuitBreakerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mTimer = DeadlineTimer::create();
+        mPolicy.failureThreshold = 3;
+        mPolicy.openDuration = std::chrono::milliseconds(50);
+    }
+
+    std::shared_ptr<CircuitBreaker> createOpenBreaker(CircuitBreaker::Probe probe) {
+        auto breaker = CircuitBreaker::create(mTimer, mPolicy, probe);
+        for (uint32_t failure = 0; failure < mPolicy.failureThreshold; ++failure) {
+            EXPECT_TRUE(breaker->allowCall());
+            breaker->onFailure();
+        }
+        return breaker;
+    }
+
+    std::shared_ptr<DeadlineTimer> mTimer;
+    BreakerPolicy mPolicy;
+};
+
+TEST_F(CircuitBreakerTest, opensAfterConsecutiveFailures) {
+    auto breaker = CircuitBreaker::create(mTimer, mPolicy, nullptr);
+
+    breaker->onFailure();
+    breaker->onFailure();
+    breaker->onSuccess();
+    breaker->onFailure();
+    breaker->onFailure();
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::CLOSED);
+
+    breaker->onFailure();
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::OPEN);
+    ASSERT_FALSE(breaker->allowCall());
+    ASSERT_FALSE(breaker->allowCall());
+    ASSERT_EQ(breaker->getRejectedCount(), 2);
+}
+
+TEST_F(CircuitBreakerTest, zeroThresholdNeverOpens) {
+    mPolicy.failureThreshold = 0;
+    auto breaker = CircuitBreaker::create(mTimer, mPolicy, nullptr);
+
+    for (int failure = 0; failure < 10; ++failure) {
+        breaker->onFailure();
+    }
+    ASSERT_TRUE(breaker->allowCall());
+}
+
+TEST_F(CircuitBreakerTest, firstCallAfterOpenDurationIsTheProbe) {
+    auto breaker = createOpenBreaker(nullptr);
+    std::this_thread::sleep_for(mPolicy.openDuration);
+
+    ASSERT_TRUE(breaker->allowCall());
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::HALF_OPEN);
+    ASSERT_FALSE(breaker->allowCall());
+
+    breaker->onSuccess();
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::CLOSED);
+    ASSERT_TRUE(breaker->allowCall());
+}
+
+TEST_F(CircuitBreakerTest, failedProbeOpensAgain) {
+    auto breaker = createOpenBreaker(nullptr);
+    std::this_thread::sleep_for(mPolicy.openDuration);
+
+    ASSERT_TRUE(breaker->allowCall());
+    breaker->onFailure();
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::OPEN);
+    ASSERT_FALSE(breaker->allowCall());
+}
+
+TEST_F(CircuitBreakerTest, probesInBackground) {
+    std::promise<void> probed;
+    auto breaker = createOpenBreaker([&probed](std::function<void(bool healthy)> done) {
+        done(true);
+        probed.set_value();
+    });
+
+    ASSERT_EQ(probed.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    ASSERT_EQ(breaker->getState(), CircuitBreaker::State::CLOSED);
+    ASSERT_TRUE(breaker->allowCall());
+}
+
+TEST_F(CircuitBreakerTest, reportsStateAsJson) {
+    auto breaker = createOpenBreaker(nullptr);
+    breaker->allowCall();
+
+    json_object* breakerJ = breaker->toJson();
+    ASSERT_STREQ(
+        json_object_to_json_string_ext(breakerJ, JSON_C_TO_STRING_PLAIN),
+        "{\"state\":\"open\",\"consecutive_failures\":3,\"rejected_calls\":1}");
+    json_object_put(breakerJ);
+}
+
+}  // namespace test
+}  // namespace vshl
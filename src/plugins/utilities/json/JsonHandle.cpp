@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/json/JsonHandle.h"
+
+#include <atomic>
+
+namespace vshl {
+namespace utilities {
+namespace json {
+
+#ifdef VSHL_JSON_ACCOUNTING
+static std::atomic<int64_t> sLiveCount(0);
+
+static void onAcquired(json_object* object) {
+    if (object) {
+        ++sLiveCount;
+    }
+}
+
+static void onReleased(json_object* object) {
+    if (object) {
+        --sLiveCount;
+    }
+}
+#else
+static void onAcquired(json_object* object) {
+}
+
+static void onReleased(json_object* object) {
+}
+#endif
+
+JsonHandle::JsonHandle() : mObject(nullptr) {
+}
+
+JsonHandle::JsonHandle(json_object* object) : mObject(object) {
+    onAcquired(mObject);
+}
+
+JsonHandle JsonHandle::share(json_object* object) {
+    return JsonHandle(json_object_get(object));
+}
+
+JsonHandle JsonHandle::copy(json_object* object) {
+    json_object* copied = nullptr;
+    if (object && json_object_deep_copy(object, &copied, NULL) != 0) {
+        return JsonHandle();
+    }
+    return JsonHandle(copied);
+}
+
+JsonHandle::JsonHandle(JsonHandle&& other) : mObject(other.mObject) {
+    other.mObject = nullptr;
+}
+
+JsonHandle& JsonHandle::operator=(JsonHandle&& other) {
+    if (this != &other) {
+        reset();
+        mObject = other.mObject;
+        other.mObject = nullptr;
+    }
+    return *this;
+}
+
+JsonHandle::~JsonHandle() {
+    reset();
+}
+
+json_object* JsonHandle::release() {
+    json_object* object = mObject;
+    onReleased(object);
+    mObject = nullptr;
+    return object;
+}
+
+void JsonHandle::reset(json_object* object) {
+    if (mObject) {
+        onReleased(mObject);
+        json_object_put(mObject);
+    }
+    mObject = object;
+    onAcquired(mObject);
+}
+
+int64_t JsonHandle::getLiveCount() {
+#ifdef VSHL_JSON_ACCOUNTING
+    return sLiveCount;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace json
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_JSON_JSONHANDLE_H_
+#define VSHL_UTILITIES_JSON_JSONHANDLE_H_
+
+#include <cstdint>
+
+#include <json-c/json.h>
+
+namespace vshl {
+namespace utilities {
+namespace json {
+
+/**
+ * Move-only owner of one reference on a json-c object, released when the
+ * handle goes away. Used wherever a reference changes hands, so that a
+ * transferred object is released exactly once, with json_object_put.
+ *
+ * When built with VSHL_JSON_ACCOUNTING, the handles owning a reference are
+ * counted, which lets tests assert that repeated calls don't leak.
+ */
+class JsonHandle {
+public:
+    // An empty handle.
+    JsonHandle();
+
+    // Takes over the reference on @c object the caller owns.
+    explicit JsonHandle(json_object* object);
+
+    // Takes a new reference on @c object, which the caller keeps owning.
+    static JsonHandle share(json_object* object);
+
+    // Takes a deep copy of @c object, which shares no reference with it. An
+    // empty handle if @c object is null or can't be copied.
+    static JsonHandle copy(json_object* object);
+
+    JsonHandle(JsonHandle&& other);
+    JsonHandle& operator=(JsonHandle&& other);
+
+    JsonHandle(const JsonHandle&) = delete;
+    JsonHandle& operator=(const JsonHandle&) = delete;
+
+    // Releases the reference.
+    ~JsonHandle();
+
+    // The object, still owned by the handle.
+    json_object* get() const {
+        return mObject;
+    }
+
+    // Gives up the reference to the caller, leaving the handle empty.
+    json_object* release();
+
+    // Releases the reference and takes over the one on @c object.
+    void reset(json_object* object = nullptr);
+
+    explicit operator bool() const {
+        return mObject != nullptr;
+    }
+
+    // Number of handles owning a reference, always 0 without VSHL_JSON_ACCOUNTING.
+    static int64_t getLiveCount();
+
+private:
+    json_object* mObject;
+};
+
+}  // namespace json
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_JSON_JSONHANDLE_H_
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/json/JsonHelpers.h"
+
+namespace vshl {
+namespace utilities {
+namespace json {
+
+json_object* getMember(json_object* object, const string& key) {
+    json_object* member = nullptr;
+    if (object == nullptr || !json_object_is_type(object, json_type_object)) {
+        return nullptr;
+    }
+
+    if (!json_object_object_get_ex(object, key.c_str(), &member)) {
+        return nullptr;
+    }
+
+    return member;
+}
+
+json_object* getMember(json_object* object, const string& key, json_type type) {
+    json_object* member = getMember(object, key);
+    if (member == nullptr || !json_object_is_type(member, type)) {
+        return nullptr;
+    }
+
+    return member;
+}
+
+bool hasMember(json_object* object, const string& key) {
+    if (object == nullptr || !json_object_is_type(object, json_type_object)) {
+        return false;
+    }
+
+    return json_object_object_get_ex(object, key.c_str(), nullptr);
+}
+
+bool getString(json_object* object, const string& key, string& value) {
+    json_object* member = getMember(object, key);
+    if (member == nullptr || !json_object_is_type(member, json_type_string)) {
+        return false;
+    }
+
+    value.assign(json_object_get_string(member), json_object_get_string_len(member));
+    return true;
+}
+
+bool getBool(json_object* object, const string& key, bool& value) {
+    json_object* member = getMember(object, key);
+    if (member == nullptr || !json_object_is_type(member, json_type_boolean)) {
+        return false;
+    }
+
+    value = json_object_get_boolean(member);
+    return true;
+}
+
+bool getInt64(json_object* object, const string& key, int64_t& value) {
+    json_object* member = getMember(object, key);
+    if (member == nullptr || !json_object_is_type(member, json_type_int)) {
+        return false;
+    }
+
+    value = json_object_get_int64(member);
+    return true;
+}
+
+bool getStringList(json_object* object, const string& key, list<string>& values) {
+    json_object* member = getMember(object, key);
+    if (member == nullptr || !json_object_is_type(member, json_type_array)) {
+        return false;
+    }
+
+    list<string> result;
+    size_t length = json_object_array_length(member);
+    for (size_t idx = 0; idx < length; ++idx) {
+        json_object* item = json_object_array_get_idx(member, idx);
+        if (item == nullptr || !json_object_is_type(item, json_type_string)) {
+            return false;
+        }
+        result.emplace_back(json_object_get_string(item), json_object_get_string_len(item));
+    }
+
+    values.swap(result);
+    return true;
+}
+
+bool getStringSet(json_object* object, const string& key, unordered_set<string>& values) {
+    list<string> items;
+    if (!getStringList(object, key, items)) {
+        return false;
+    }
+
+    values.clear();
+    values.insert(items.begin(), items.end());
+    return true;
+}
+
+void addString(json_object* object, const string& key, const string& value) {
+    json_object_object_add(object, key.c_str(), json_object_new_string_len(value.c_str(), value.size()));
+}
+
+void addBool(json_object* object, const string& key, bool value) {
+    json_object_object_add(object, key.c_str(), json_object_new_boolean(value));
+}
+
+}  // namespace json
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_JSON_JSONHELPERS_H_
+#define VSHL_UTILITIES_JSON_JSONHELPERS_H_
+
+#include <list>
+#include <string>
+#include <unordered_set>
+
+#include <json-c/json.h>
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace json {
+
+/**
+ * Accessors that read values straight out of a json-c object tree.
+ * None of them serialize or re-parse the object. All of them return
+ * false when the member is missing or has an unexpected type, in which
+ * case the output parameter is left untouched.
+ */
+
+// Returns the member @c key of @c object, or nullptr if absent.
+json_object* getMember(json_object* object, const string& key);
+
+// Returns the member @c key of @c object if it has the given type, or nullptr.
+json_object* getMember(json_object* object, const string& key, json_type type);
+
+// Returns true if @c object has a member named @c key.
+bool hasMember(json_object* object, const string& key);
+
+// Reads a string member.
+bool getString(json_object* object, const string& key, string& value);
+
+// Reads a boolean member.
+bool getBool(json_object* object, const string& key, bool& value);
+
+// Reads an integer member.
+bool getInt64(json_object* object, const string& key, int64_t& value);
+
+// Reads an array of strings member.
+bool getStringList(json_object* object, const string& key, list<string>& values);
+
+// Reads an array of strings member into a set.
+bool getStringSet(json_object* object, const string& key, unordered_set<string>& values);
+
+/**
+ * Builders used to assemble replies directly as json-c objects.
+ */
+
+// Adds a string member to @c object.
+void addString(json_object* object, const string& key, const string& value);
+
+// Adds a boolean member to @c object.
+void addBool(json_object* object, const string& key, bool value);
+
+}  // namespace json
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_JSON_JSONHELPERS_H_
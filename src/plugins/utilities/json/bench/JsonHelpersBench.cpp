@@ -0,0 +1,299 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <string>
+#include <unordered_set>
+
+#include <json-c/json.h>
+
+#include "json.hpp"
+#include "utilities/json/JsonHelpers.h"
+
+#include "bench/common/AllocationCounter.h"
+
+/**
+ * Before/after benchmarks for the argument decoding and reply building done by
+ * the verb handlers in VshlApi.cpp. The "Legacy" variants reproduce the former
+ * json-c -> string -> nlohmann -> string -> json-c round trip, the "JsonC"
+ * variants use the accessors from utilities/json/JsonHelpers.h.
+ */
+
+using nljson = nlohmann::json;
+using namespace vshl::bench::common;
+using namespace vshl::utilities::json;
+
+namespace {
+
+static const char* SUBSCRIBE_REQUEST =
+    "{\"va_id\":\"VA-001\",\"events\":[\"voice_authstate_event\",\"voice_dialogstate_event\","
+    "\"voice_connectionstate_event\"]}";
+static const char* PUBLISH_REQUEST =
+    "{\"action\":\"RenderTemplate\",\"payload\":\"{\\\"title\\\":{\\\"mainTitle\\\":\\\"Weather\\\"},"
+    "\\\"currentWeather\\\":\\\"75 degrees\\\",\\\"description\\\":\\\"Sunny with a light breeze\\\"}\"}";
+static const char* AGENT_EVENT = "{\"va_id\":\"VA-001\",\"state\":\"LISTENING\"}";
+static const char* AGENTS_CONFIG =
+    "{\"default\":\"VA-001\",\"agents\":["
+    "{\"id\":\"VA-001\",\"active\":true,\"name\":\"Alexa\",\"api\":\"alexa-voiceagent\","
+    "\"wakewords\":[\"alexa\",\"computer\",\"echo\"],\"activewakeword\":\"alexa\","
+    "\"description\":\"Alexa voice assistant by Amazon.\",\"vendor\":\"Amazon.com Services Inc\"},"
+    "{\"id\":\"VA-002\",\"active\":true,\"name\":\"Nuance\",\"api\":\"nuance-voiceagent\","
+    "\"wakewords\":[\"hello nuance\"],\"activewakeword\":\"hello nuance\","
+    "\"description\":\"Nuance voice assistant.\",\"vendor\":\"Nuance Communications\"}]}";
+
+json_object* parseJson(const char* text) {
+    return json_tokener_parse(text);
+}
+
+// startListening / enumerateVoiceAgents style reply.
+void BM_Legacy_StartListeningReply(benchmark::State& state) {
+    std::string requestId("d2c8e8d4-7f3e-4c8e-9b61-2a4f1d7d3f21");
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson responseJson;
+        responseJson["request_id"] = requestId;
+        json_object* reply = json_tokener_parse(responseJson.dump().c_str());
+        benchmark::DoNotOptimize(reply);
+        json_object_put(reply);
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_Legacy_StartListeningReply);
+
+void BM_JsonC_StartListeningReply(benchmark::State& state) {
+    std::string requestId("d2c8e8d4-7f3e-4c8e-9b61-2a4f1d7d3f21");
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        json_object* reply = json_object_new_object();
+        addString(reply, "request_id", requestId);
+        benchmark::DoNotOptimize(reply);
+        json_object_put(reply);
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_JsonC_StartListeningReply);
+
+// onAuthStateEvent / onConnectionStateEvent / onDialogStateEvent.
+void BM_Legacy_AgentEvent(benchmark::State& state) {
+    json_object* eventJ = parseJson(AGENT_EVENT);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson eventJson = nljson::parse(json_object_to_json_string(eventJ));
+        std::string voiceAgentId(eventJson["va_id"].get<std::string>());
+        benchmark::DoNotOptimize(voiceAgentId);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_Legacy_AgentEvent);
+
+void BM_JsonC_AgentEvent(benchmark::State& state) {
+    json_object* eventJ = parseJson(AGENT_EVENT);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        std::string voiceAgentId;
+        getString(eventJ, "va_id", voiceAgentId);
+        benchmark::DoNotOptimize(voiceAgentId);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_JsonC_AgentEvent);
+
+// subscribe and the capability *Subscribe verbs.
+void BM_Legacy_Subscribe(benchmark::State& state) {
+    json_object* eventJ = parseJson(SUBSCRIBE_REQUEST);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson subscribeJson = nljson::parse(json_object_to_json_string(eventJ));
+        std::string voiceAgentId(subscribeJson["va_id"].get<std::string>());
+        std::list<std::string> events(subscribeJson["events"].get<std::list<std::string>>());
+        benchmark::DoNotOptimize(voiceAgentId);
+        benchmark::DoNotOptimize(events);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_Legacy_Subscribe);
+
+void BM_JsonC_Subscribe(benchmark::State& state) {
+    json_object* eventJ = parseJson(SUBSCRIBE_REQUEST);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        std::string voiceAgentId;
+        std::list<std::string> events;
+        getString(eventJ, "va_id", voiceAgentId);
+        getStringList(eventJ, "events", events);
+        benchmark::DoNotOptimize(voiceAgentId);
+        benchmark::DoNotOptimize(events);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_JsonC_Subscribe);
+
+// guiMetadataPublish / phonecontrolPublish / navigationPublish.
+void BM_Legacy_Publish(benchmark::State& state) {
+    json_object* eventJ = parseJson(PUBLISH_REQUEST);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson publishJson = nljson::parse(json_object_to_json_string(eventJ));
+        std::string action(publishJson["action"].get<std::string>());
+        std::string payload(publishJson["payload"].get<std::string>());
+        benchmark::DoNotOptimize(action);
+        benchmark::DoNotOptimize(payload);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_Legacy_Publish);
+
+void BM_JsonC_Publish(benchmark::State& state) {
+    json_object* eventJ = parseJson(PUBLISH_REQUEST);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        std::string action;
+        getString(eventJ, "action", action);
+        json_object* payloadJ = getMember(eventJ, "payload", json_type_string);
+        benchmark::DoNotOptimize(action);
+        benchmark::DoNotOptimize(payloadJ);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(eventJ);
+}
+BENCHMARK(BM_JsonC_Publish);
+
+// loadVoiceAgentsConfig.
+void BM_Legacy_LoadVoiceAgentsConfig(benchmark::State& state) {
+    json_object* argsJ = parseJson(AGENTS_CONFIG);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson agentsConfigJson = nljson::parse(json_object_to_json_string(argsJ));
+        for (auto agentIt : agentsConfigJson["agents"]) {
+            std::string id(agentIt["id"].get<std::string>());
+            bool isActive(agentIt["active"].get<bool>());
+            std::string name(agentIt["name"].get<std::string>());
+            std::string api(agentIt["api"].get<std::string>());
+            std::unordered_set<std::string> wakewords(
+                agentIt["wakewords"].get<std::unordered_set<std::string>>());
+            std::string activeWakeword(agentIt["activewakeword"].get<std::string>());
+            std::string description(agentIt["description"].get<std::string>());
+            std::string vendor(agentIt["vendor"].get<std::string>());
+            benchmark::DoNotOptimize(id);
+            benchmark::DoNotOptimize(isActive);
+            benchmark::DoNotOptimize(wakewords);
+        }
+        std::string defaultAgentId(agentsConfigJson["default"].get<std::string>());
+        benchmark::DoNotOptimize(defaultAgentId);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(argsJ);
+}
+BENCHMARK(BM_Legacy_LoadVoiceAgentsConfig);
+
+void BM_JsonC_LoadVoiceAgentsConfig(benchmark::State& state) {
+    json_object* argsJ = parseJson(AGENTS_CONFIG);
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        json_object* agentsJson = getMember(argsJ, "agents");
+        size_t agentsCount = json_object_array_length(agentsJson);
+        for (size_t agentIdx = 0; agentIdx < agentsCount; ++agentIdx) {
+            json_object* agentJson = json_object_array_get_idx(agentsJson, agentIdx);
+            std::string id, name, api, description, vendor, activeWakeword;
+            bool isActive = false;
+            std::unordered_set<std::string> wakewords;
+            getString(agentJson, "id", id);
+            getBool(agentJson, "active", isActive);
+            getString(agentJson, "name", name);
+            getString(agentJson, "api", api);
+            getStringSet(agentJson, "wakewords", wakewords);
+            getString(agentJson, "activewakeword", activeWakeword);
+            getString(agentJson, "description", description);
+            getString(agentJson, "vendor", vendor);
+            benchmark::DoNotOptimize(id);
+            benchmark::DoNotOptimize(isActive);
+            benchmark::DoNotOptimize(wakewords);
+        }
+        std::string defaultAgentId;
+        getString(argsJ, "default", defaultAgentId);
+        benchmark::DoNotOptimize(defaultAgentId);
+    }
+    reportAllocations(state, allocations);
+    json_object_put(argsJ);
+}
+BENCHMARK(BM_JsonC_LoadVoiceAgentsConfig);
+
+// enumerateVoiceAgents reply.
+void BM_Legacy_EnumerateReply(benchmark::State& state) {
+    std::unordered_set<std::string> wakewords{"alexa", "computer", "echo"};
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        nljson responseJson;
+        nljson agentsJson = nljson::array();
+        for (int i = 0; i < 2; i++) {
+            nljson agentJson;
+            agentJson["id"] = "VA-001";
+            agentJson["name"] = "Alexa";
+            agentJson["description"] = "Alexa voice assistant by Amazon.";
+            agentJson["api"] = "alexa-voiceagent";
+            agentJson["vendor"] = "Amazon.com Services Inc";
+            agentJson["active"] = true;
+            agentJson["activewakeword"] = "alexa";
+            agentJson["wakewords"] = wakewords;
+            agentsJson.push_back(agentJson);
+        }
+        responseJson["agents"] = agentsJson;
+        responseJson["default"] = "VA-001";
+        json_object* reply = json_tokener_parse(responseJson.dump().c_str());
+        benchmark::DoNotOptimize(reply);
+        json_object_put(reply);
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_Legacy_EnumerateReply);
+
+void BM_JsonC_EnumerateReply(benchmark::State& state) {
+    std::unordered_set<std::string> wakewords{"alexa", "computer", "echo"};
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        json_object* reply = json_object_new_object();
+        json_object* agentsJson = json_object_new_array();
+        for (int i = 0; i < 2; i++) {
+            json_object* agentJson = json_object_new_object();
+            addString(agentJson, "id", "VA-001");
+            addString(agentJson, "name", "Alexa");
+            addString(agentJson, "description", "Alexa voice assistant by Amazon.");
+            addString(agentJson, "api", "alexa-voiceagent");
+            addString(agentJson, "vendor", "Amazon.com Services Inc");
+            addBool(agentJson, "active", true);
+            addString(agentJson, "activewakeword", "alexa");
+            json_object* wakewordsJson = json_object_new_array();
+            for (auto& wakeword : wakewords) {
+                json_object_array_add(wakewordsJson, json_object_new_string(wakeword.c_str()));
+            }
+            json_object_object_add(agentJson, "wakewords", wakewordsJson);
+            json_object_array_add(agentsJson, agentJson);
+        }
+        json_object_object_add(reply, "agents", agentsJson);
+        addString(reply, "default", "VA-001");
+        benchmark::DoNotOptimize(reply);
+        json_object_put(reply);
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_JsonC_EnumerateReply);
+
+}  // namespace
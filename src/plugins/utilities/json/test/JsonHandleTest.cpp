@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "utilities/json/JsonHandle.h"
+
+using namespace vshl::utilities::json;
+
+namespace vshl {
+namespace test {
+
+TEST(JsonHandleTest, releasesOwnedReferenceOnDestruction) {
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    json_object* object = json_object_new_object();
+    json_object_get(object);
+    {
+        JsonHandle handle(object);
+        ASSERT_EQ(handle.get(), object);
+        ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles + 1);
+    }
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles);
+    // Only the reference kept by the test is left.
+    ASSERT_EQ(json_object_put(object), 1);
+}
+
+TEST(JsonHandleTest, shareTakesNewReference) {
+    json_object* object = json_object_new_object();
+    {
+        JsonHandle handle = JsonHandle::share(object);
+        ASSERT_TRUE(handle);
+    }
+    ASSERT_EQ(json_object_put(object), 1);
+}
+
+TEST(JsonHandleTest, copySharesNoReference) {
+    json_object* object = json_tokener_parse("{\"state\":\"LISTENING\",\"items\":[1,2]}");
+    {
+        JsonHandle handle = JsonHandle::copy(object);
+        ASSERT_TRUE(handle);
+        ASSERT_NE(handle.get(), object);
+        ASSERT_STREQ(json_object_to_json_string(handle.get()), json_object_to_json_string(object));
+    }
+    ASSERT_FALSE(JsonHandle::copy(nullptr));
+    ASSERT_EQ(json_object_put(object), 1);
+}
+
+TEST(JsonHandleTest, moveTransfersOwnership) {
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    JsonHandle first(json_object_new_string("payload"));
+    JsonHandle second(std::move(first));
+    ASSERT_FALSE(first);
+    ASSERT_TRUE(second);
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles + 1);
+
+    JsonHandle third;
+    third = std::move(second);
+    ASSERT_FALSE(second);
+    ASSERT_STREQ(json_object_get_string(third.get()), "payload");
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles + 1);
+}
+
+TEST(JsonHandleTest, releaseGivesUpOwnership) {
+    int64_t liveHandles = JsonHandle::getLiveCount();
+    JsonHandle handle(json_object_new_object());
+    json_object* object = handle.release();
+    ASSERT_FALSE(handle);
+    ASSERT_EQ(JsonHandle::getLiveCount(), liveHandles);
+    ASSERT_EQ(json_object_put(object), 1);
+}
+
+}  // namespace test
+}  // namespace vshl
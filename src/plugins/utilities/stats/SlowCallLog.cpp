@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/stats/SlowCallLog.h"
+
+static string JSON_ATTR_API = "api";
+static string JSON_ATTR_VERB = "verb";
+static string JSON_ATTR_DURATION_US = "duration_us";
+static string JSON_ATTR_ERROR = "error";
+static string JSON_ATTR_INFO = "info";
+static string JSON_ATTR_TIME_MS = "time_ms";
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+
+std::shared_ptr<SlowCallLog> SlowCallLog::create(size_t capacity, chrono::microseconds threshold) {
+    return std::shared_ptr<SlowCallLog>(new SlowCallLog(capacity, threshold));
+}
+
+SlowCallLog::SlowCallLog(size_t capacity, chrono::microseconds threshold) :
+        mThresholdUs(threshold.count()),
+        mCapacity(capacity),
+        mNext(0) {
+    mCalls.reserve(capacity);
+}
+
+void SlowCallLog::setThreshold(chrono::microseconds threshold) {
+    mThresholdUs.store(threshold.count(), memory_order_relaxed);
+}
+
+bool SlowCallLog::isSlow(uint64_t durationUs) const {
+    return durationUs >= mThresholdUs.load(memory_order_relaxed);
+}
+
+void SlowCallLog::record(SlowCall call) {
+    lock_guard<mutex> lock(mMutex);
+    if (mCapacity == 0) {
+        return;
+    }
+
+    if (mCalls.size() < mCapacity) {
+        mCalls.push_back(std::move(call));
+    } else {
+        mCalls[mNext] = std::move(call);
+    }
+    mNext = (mNext + 1) % mCapacity;
+}
+
+void SlowCallLog::reset() {
+    lock_guard<mutex> lock(mMutex);
+    mCalls.clear();
+    mNext = 0;
+}
+
+json_object* SlowCallLog::toJson() {
+    lock_guard<mutex> lock(mMutex);
+    json_object* callsJ = json_object_new_array();
+    for (size_t idx = 1; idx <= mCalls.size(); ++idx) {
+        const SlowCall& call = mCalls[(mNext + mCalls.size() - idx) % mCalls.size()];
+        auto timeMs = chrono::duration_cast<chrono::milliseconds>(call.time.time_since_epoch());
+
+        json_object* callJ = json_object_new_object();
+        json_object_object_add(callJ, JSON_ATTR_API.c_str(), json_object_new_string(call.api.c_str()));
+        json_object_object_add(callJ, JSON_ATTR_VERB.c_str(), json_object_new_string(call.verb.c_str()));
+        json_object_object_add(callJ, JSON_ATTR_DURATION_US.c_str(), json_object_new_int64(call.durationUs));
+        json_object_object_add(callJ, JSON_ATTR_ERROR.c_str(), json_object_new_string(call.error.c_str()));
+        json_object_object_add(callJ, JSON_ATTR_INFO.c_str(), json_object_new_string(call.info.c_str()));
+        json_object_object_add(callJ, JSON_ATTR_TIME_MS.c_str(), json_object_new_int64(timeMs.count()));
+        json_object_array_add(callsJ, callJ);
+    }
+    return callsJ;
+}
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_STATS_SLOWCALLLOG_H_
+#define VSHL_UTILITIES_STATS_SLOWCALLLOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json-c/json.h>
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+/*
+ * Keeps the most recent calls slower than a threshold, with what they
+ * replied, so that a slow call can be told apart from a slow plugin.
+ * The threshold test is lock free, only slow calls take the lock.
+ */
+class SlowCallLog {
+public:
+    // A call slower than the threshold.
+    struct SlowCall {
+        string api;
+        string verb;
+        uint64_t durationUs;
+        string error;
+        string info;
+        chrono::system_clock::time_point time;
+    };
+
+    // Create a SlowCallLog keeping the last @c capacity calls slower than @c threshold.
+    static std::shared_ptr<SlowCallLog> create(size_t capacity, chrono::microseconds threshold);
+
+    // Sets the threshold of the calls recorded from now on.
+    void setThreshold(chrono::microseconds threshold);
+
+    // Whether a call of @c durationUs is slow.
+    bool isSlow(uint64_t durationUs) const;
+
+    // Records a slow call, overwriting the oldest one when full.
+    void record(SlowCall call);
+
+    // Drops the recorded calls.
+    void reset();
+
+    /**
+     * Returns the recorded calls as a new json array, most recent first:
+     * [ { "api", "verb", "duration_us", "error", "info", "time_ms" }, ... ]
+     * with time_ms the wall clock time of the reply in ms since the epoch.
+     */
+    json_object* toJson();
+
+private:
+    // Constructor
+    SlowCallLog(size_t capacity, chrono::microseconds threshold);
+
+    atomic<uint64_t> mThresholdUs;
+
+    // Guards the ring.
+    mutex mMutex;
+
+    // Ring of the recorded calls, mNext is where the next one goes.
+    vector<SlowCall> mCalls;
+    size_t mCapacity;
+    size_t mNext;
+};
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_STATS_SLOWCALLLOG_H_
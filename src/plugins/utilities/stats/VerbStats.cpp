@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/stats/VerbStats.h"
+
+static string JSON_ATTR_CALLS = "calls";
+static string JSON_ATTR_FAILURES = "failures";
+static string JSON_ATTR_TOTAL_US = "total_us";
+static string JSON_ATTR_MEAN_US = "mean_us";
+static string JSON_ATTR_MAX_US = "max_us";
+static string JSON_ATTR_HISTOGRAM = "histogram_log2_us";
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+
+std::shared_ptr<VerbStats> VerbStats::create(const string& verb) {
+    return std::shared_ptr<VerbStats>(new VerbStats(verb));
+}
+
+VerbStats::VerbStats(const string& verb) : mVerb(verb) {
+    reset();
+}
+
+string VerbStats::getVerb() const {
+    return mVerb;
+}
+
+size_t VerbStats::getBucket(uint64_t durationUs) {
+    size_t bucket = 0;
+    while (durationUs > 0 && bucket < NUM_BUCKETS - 1) {
+        durationUs >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void VerbStats::record(uint64_t durationUs, bool failed) {
+    mCalls.fetch_add(1, memory_order_relaxed);
+    if (failed) {
+        mFailures.fetch_add(1, memory_order_relaxed);
+    }
+    mTotalUs.fetch_add(durationUs, memory_order_relaxed);
+    mBuckets[getBucket(durationUs)].fetch_add(1, memory_order_relaxed);
+
+    uint64_t maxUs = mMaxUs.load(memory_order_relaxed);
+    while (durationUs > maxUs && !mMaxUs.compare_exchange_weak(maxUs, durationUs, memory_order_relaxed)) {
+    }
+}
+
+void VerbStats::reset() {
+    mCalls.store(0, memory_order_relaxed);
+    mFailures.store(0, memory_order_relaxed);
+    mTotalUs.store(0, memory_order_relaxed);
+    mMaxUs.store(0, memory_order_relaxed);
+    for (auto& bucket : mBuckets) {
+        bucket.store(0, memory_order_relaxed);
+    }
+}
+
+uint64_t VerbStats::getCalls() const {
+    return mCalls.load(memory_order_relaxed);
+}
+
+uint64_t VerbStats::getFailures() const {
+    return mFailures.load(memory_order_relaxed);
+}
+
+uint64_t VerbStats::getBucketCount(size_t bucket) const {
+    if (bucket >= NUM_BUCKETS) {
+        return 0;
+    }
+    return mBuckets[bucket].load(memory_order_relaxed);
+}
+
+json_object* VerbStats::toJson() const {
+    uint64_t calls = getCalls();
+    uint64_t totalUs = mTotalUs.load(memory_order_relaxed);
+
+    json_object* statsJ = json_object_new_object();
+    json_object_object_add(statsJ, JSON_ATTR_CALLS.c_str(), json_object_new_int64(calls));
+    json_object_object_add(statsJ, JSON_ATTR_FAILURES.c_str(), json_object_new_int64(getFailures()));
+    json_object_object_add(statsJ, JSON_ATTR_TOTAL_US.c_str(), json_object_new_int64(totalUs));
+    json_object_object_add(
+        statsJ, JSON_ATTR_MEAN_US.c_str(), json_object_new_int64(calls > 0 ? totalUs / calls : 0));
+    json_object_object_add(
+        statsJ, JSON_ATTR_MAX_US.c_str(), json_object_new_int64(mMaxUs.load(memory_order_relaxed)));
+
+    json_object* histogramJ = json_object_new_array();
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        json_object_array_add(histogramJ, json_object_new_int64(getBucketCount(bucket)));
+    }
+    json_object_object_add(statsJ, JSON_ATTR_HISTOGRAM.c_str(), histogramJ);
+
+    return statsJ;
+}
+
+VerbTimer::VerbTimer(shared_ptr<VerbStats> stats) :
+        mStats(stats),
+        mStartTime(chrono::steady_clock::now()),
+        mFailed(false) {
+}
+
+VerbTimer::VerbTimer(VerbTimer&& other) :
+        mStats(std::move(other.mStats)),
+        mStartTime(other.mStartTime),
+        mFailed(other.mFailed) {
+    other.mStats.reset();
+}
+
+void VerbTimer::setFailed(bool failed) {
+    mFailed = failed;
+}
+
+VerbTimer::~VerbTimer() {
+    if (!mStats) {
+        return;
+    }
+
+    auto duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - mStartTime);
+    mStats->record(duration.count(), mFailed);
+}
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
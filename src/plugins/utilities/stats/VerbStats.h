@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_STATS_VERBSTATS_H_
+#define VSHL_UTILITIES_STATS_VERBSTATS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <json-c/json.h>
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+/*
+ * Call counters and latency histogram of a single verb.
+ * All updates are lock free so that recording can happen on every call.
+ *
+ * The latency histogram has log2 buckets in microseconds. Bucket 0 counts
+ * calls under 1us, bucket i counts calls in [2^(i-1), 2^i) us and the last
+ * bucket counts everything above.
+ */
+class VerbStats {
+public:
+    // Number of histogram buckets, the last one is open ended (>= ~0.5s).
+    static const size_t NUM_BUCKETS = 21;
+
+    // Create a VerbStats.
+    static std::shared_ptr<VerbStats> create(const string& verb);
+
+    // Verb name.
+    string getVerb() const;
+
+    // Records one call of the verb.
+    void record(uint64_t durationUs, bool failed);
+
+    // Clears all counters.
+    void reset();
+
+    // Number of recorded calls.
+    uint64_t getCalls() const;
+
+    // Number of recorded failed calls.
+    uint64_t getFailures() const;
+
+    // Number of recorded calls in histogram bucket @c bucket.
+    uint64_t getBucketCount(size_t bucket) const;
+
+    // Index of the histogram bucket @c durationUs falls into.
+    static size_t getBucket(uint64_t durationUs);
+
+    // Returns the counters as a new json object.
+    json_object* toJson() const;
+
+private:
+    // Constructor
+    VerbStats(const string& verb);
+
+    // Verb name
+    string mVerb;
+
+    // Counters
+    atomic<uint64_t> mCalls;
+    atomic<uint64_t> mFailures;
+    atomic<uint64_t> mTotalUs;
+    atomic<uint64_t> mMaxUs;
+    array<atomic<uint64_t>, NUM_BUCKETS> mBuckets;
+};
+
+/*
+ * Measures the duration of a verb call from construction to destruction
+ * and records it in the verb's @c VerbStats. A verb that replies later, from
+ * a completion, moves its timer there so that the call is recorded once replied.
+ */
+class VerbTimer {
+public:
+    // Starts timing a call of the verb.
+    VerbTimer(shared_ptr<VerbStats> stats);
+
+    // Takes over the timing of the call of @c other, which records nothing.
+    VerbTimer(VerbTimer&& other);
+
+    VerbTimer(const VerbTimer&) = delete;
+    VerbTimer& operator=(const VerbTimer&) = delete;
+
+    // Marks the call as failed.
+    void setFailed(bool failed);
+
+    // Records the call.
+    ~VerbTimer();
+
+private:
+    shared_ptr<VerbStats> mStats;
+    chrono::steady_clock::time_point mStartTime;
+    bool mFailed;
+};
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_STATS_VERBSTATS_H_
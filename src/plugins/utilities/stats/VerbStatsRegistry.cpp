@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/stats/VerbStatsRegistry.h"
+
+static string JSON_ATTR_ELAPSED_MS = "elapsed_ms";
+static string JSON_ATTR_VERBS = "verbs";
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+
+std::unique_ptr<VerbStatsRegistry> VerbStatsRegistry::create() {
+    return std::unique_ptr<VerbStatsRegistry>(new VerbStatsRegistry());
+}
+
+VerbStatsRegistry::VerbStatsRegistry() : mResetTime(chrono::steady_clock::now()) {
+}
+
+shared_ptr<VerbStats> VerbStatsRegistry::getVerbStats(const string& verb) {
+    lock_guard<mutex> lock(mMutex);
+    for (auto verbStats : mVerbStats) {
+        if (verbStats->getVerb() == verb) {
+            return verbStats;
+        }
+    }
+
+    auto verbStats = VerbStats::create(verb);
+    mVerbStats.push_back(verbStats);
+    return verbStats;
+}
+
+void VerbStatsRegistry::reset() {
+    lock_guard<mutex> lock(mMutex);
+    for (auto verbStats : mVerbStats) {
+        verbStats->reset();
+    }
+    mResetTime = chrono::steady_clock::now();
+}
+
+json_object* VerbStatsRegistry::toJson() {
+    lock_guard<mutex> lock(mMutex);
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - mResetTime);
+
+    json_object* verbsJ = json_object_new_object();
+    for (auto verbStats : mVerbStats) {
+        json_object_object_add(verbsJ, verbStats->getVerb().c_str(), verbStats->toJson());
+    }
+
+    json_object* statsJ = json_object_new_object();
+    json_object_object_add(statsJ, JSON_ATTR_ELAPSED_MS.c_str(), json_object_new_int64(elapsed.count()));
+    json_object_object_add(statsJ, JSON_ATTR_VERBS.c_str(), verbsJ);
+    return statsJ;
+}
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_STATS_VERBSTATSREGISTRY_H_
+#define VSHL_UTILITIES_STATS_VERBSTATSREGISTRY_H_
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <json-c/json.h>
+
+#include "utilities/stats/VerbStats.h"
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace stats {
+/*
+ * Holds the @c VerbStats of all the verbs of the plugin.
+ * Verbs look up their stats once and keep the reference, so the registry
+ * itself is only touched on the first call of a verb and when dumping.
+ */
+class VerbStatsRegistry {
+public:
+    // Create a VerbStatsRegistry.
+    static std::unique_ptr<VerbStatsRegistry> create();
+
+    // Returns the stats of the verb, creating them on first use.
+    shared_ptr<VerbStats> getVerbStats(const string& verb);
+
+    // Clears the stats of all verbs.
+    void reset();
+
+    /**
+     * Returns the stats of all verbs as a new json object:
+     * { "elapsed_ms": <time since creation or last reset>,
+     *   "verbs": { "<verb>": { ... }, ... } }
+     */
+    json_object* toJson();
+
+private:
+    // Constructor
+    VerbStatsRegistry();
+
+    // Guards the stats list and the reset time.
+    mutex mMutex;
+
+    // Stats of all the verbs
+    list<shared_ptr<VerbStats>> mVerbStats;
+
+    // Time of creation or last reset
+    chrono::steady_clock::time_point mResetTime;
+};
+
+}  // namespace stats
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_STATS_VERBSTATSREGISTRY_H_
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "utilities/json/JsonHelpers.h"
+#include "utilities/stats/SlowCallLog.h"
+
+using namespace vshl::utilities::json;
+using namespace vshl::utilities::stats;
+
+namespace vshl {
+namespace test {
+
+static SlowCallLog::SlowCall createSlowCall(const std::string& verb, uint64_t durationUs) {
+    return {"alexa-voiceagent", verb, durationUs, "", "", std::chrono::system_clock::now()};
+}
+
+// Verbs of the recorded calls, most recent first.
+static std::vector<std::string> getRecordedVerbs(std::shared_ptr<SlowCallLog> slowCalls) {
+    std::vector<std::string> verbs;
+    json_object* callsJ = slowCalls->toJson();
+    for (size_t idx = 0; idx < json_object_array_length(callsJ); ++idx) {
+        std::string verb;
+        getString(json_object_array_get_idx(callsJ, idx), "verb", verb);
+        verbs.push_back(verb);
+    }
+    json_object_put(callsJ);
+    return verbs;
+}
+
+TEST(SlowCallLogTest, callsUnderThresholdAreNotSlow) {
+    auto slowCalls = SlowCallLog::create(4, std::chrono::milliseconds(100));
+    ASSERT_FALSE(slowCalls->isSlow(99999));
+    ASSERT_TRUE(slowCalls->isSlow(100000));
+
+    slowCalls->setThreshold(std::chrono::milliseconds(200));
+    ASSERT_FALSE(slowCalls->isSlow(100000));
+}
+
+TEST(SlowCallLogTest, keepsMostRecentCalls) {
+    auto slowCalls = SlowCallLog::create(3, std::chrono::milliseconds(100));
+    slowCalls->record(createSlowCall("subscribe", 100000));
+    slowCalls->record(createSlowCall("startListening", 200000));
+    ASSERT_EQ(getRecordedVerbs(slowCalls), std::vector<std::string>({"startListening", "subscribe"}));
+
+    slowCalls->record(createSlowCall("cancel", 300000));
+    slowCalls->record(createSlowCall("startListening", 400000));
+    ASSERT_EQ(getRecordedVerbs(slowCalls), std::vector<std::string>({"startListening", "cancel", "startListening"}));
+
+    slowCalls->reset();
+    ASSERT_TRUE(getRecordedVerbs(slowCalls).empty());
+}
+
+TEST(SlowCallLogTest, reportsRepliesAsJson) {
+    auto slowCalls = SlowCallLog::create(1, std::chrono::milliseconds(100));
+    slowCalls->record({"alexa-voiceagent", "startListening", 150000, "timeout", "no reply", {}});
+
+    json_object* callsJ = slowCalls->toJson();
+    ASSERT_STREQ(
+        json_object_to_json_string_ext(callsJ, JSON_C_TO_STRING_PLAIN),
+        "[{\"api\":\"alexa-voiceagent\",\"verb\":\"startListening\",\"duration_us\":150000,"
+        "\"error\":\"timeout\",\"info\":\"no reply\",\"time_ms\":0}]");
+    json_object_put(callsJ);
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "utilities/stats/VerbStats.h"
+#include "utilities/stats/VerbStatsRegistry.h"
+
+using namespace vshl::utilities::stats;
+
+namespace vshl {
+namespace test {
+
+TEST(VerbStatsTest, bucketsAreLog2Microseconds) {
+    ASSERT_EQ(VerbStats::getBucket(0), 0);
+    ASSERT_EQ(VerbStats::getBucket(1), 1);
+    ASSERT_EQ(VerbStats::getBucket(2), 2);
+    ASSERT_EQ(VerbStats::getBucket(3), 2);
+    ASSERT_EQ(VerbStats::getBucket(4), 3);
+    ASSERT_EQ(VerbStats::getBucket(1023), 10);
+    ASSERT_EQ(VerbStats::getBucket(1024), 11);
+    ASSERT_EQ(VerbStats::getBucket(UINT64_MAX), VerbStats::NUM_BUCKETS - 1);
+}
+
+TEST(VerbStatsTest, recordsAndResetsCalls) {
+    auto stats = VerbStats::create("startListening");
+    stats->record(0, false);
+    stats->record(3, true);
+    stats->record(3, false);
+
+    ASSERT_EQ(stats->getCalls(), 3);
+    ASSERT_EQ(stats->getFailures(), 1);
+    ASSERT_EQ(stats->getBucketCount(0), 1);
+    ASSERT_EQ(stats->getBucketCount(2), 2);
+
+    json_object* statsJ = stats->toJson();
+    json_object* maxJ = nullptr;
+    ASSERT_TRUE(json_object_object_get_ex(statsJ, "max_us", &maxJ));
+    ASSERT_EQ(json_object_get_int64(maxJ), 3);
+    json_object_put(statsJ);
+
+    stats->reset();
+    ASSERT_EQ(stats->getCalls(), 0);
+    ASSERT_EQ(stats->getFailures(), 0);
+    ASSERT_EQ(stats->getBucketCount(2), 0);
+}
+
+TEST(VerbStatsTest, timerRecordsOneCall) {
+    auto registry = VerbStatsRegistry::create();
+    auto stats = registry->getVerbStats("subscribe");
+    ASSERT_EQ(registry->getVerbStats("subscribe"), stats);
+
+    {
+        VerbTimer timer(stats);
+        timer.setFailed(true);
+    }
+
+    ASSERT_EQ(stats->getCalls(), 1);
+    ASSERT_EQ(stats->getFailures(), 1);
+
+    registry->reset();
+    ASSERT_EQ(stats->getCalls(), 0);
+}
+
+TEST(VerbStatsTest, movedTimerRecordsOnceWhenItsNewOwnerIsDone) {
+    auto registry = VerbStatsRegistry::create();
+    auto stats = registry->getVerbStats("startListening");
+
+    std::unique_ptr<VerbTimer> completionTimer;
+    {
+        VerbTimer timer(stats);
+        completionTimer.reset(new VerbTimer(std::move(timer)));
+    }
+    ASSERT_EQ(stats->getCalls(), 0);
+
+    completionTimer->setFailed(true);
+    completionTimer.reset();
+    ASSERT_EQ(stats->getCalls(), 1);
+    ASSERT_EQ(stats->getFailures(), 1);
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "utilities/timer/DeadlineTimer.h"
+
+namespace vshl {
+namespace utilities {
+namespace timer {
+
+std::shared_ptr<DeadlineTimer> DeadlineTimer::create() {
+    return std::shared_ptr<DeadlineTimer>(new DeadlineTimer());
+}
+
+DeadlineTimer::DeadlineTimer() : mState(make_shared<State>()) {
+}
+
+DeadlineTimer::~DeadlineTimer() {
+    {
+        lock_guard<mutex> lock(mState->mutex);
+        mState->stopped = true;
+        mState->callbacks.clear();
+        mState->deadlines.clear();
+    }
+    mState->condition.notify_all();
+
+    if (!mThread.joinable()) {
+        return;
+    }
+
+    // A callback releasing the last reference to the timer runs on the
+    // worker thread, which can't join itself.
+    if (mThread.get_id() == this_thread::get_id()) {
+        mThread.detach();
+    } else {
+        mThread.join();
+    }
+}
+
+DeadlineTimer::TimerId DeadlineTimer::schedule(chrono::milliseconds delay, Callback callback) {
+    lock_guard<mutex> lock(mState->mutex);
+    if (!mThread.joinable()) {
+        mThread = thread(&DeadlineTimer::run, mState);
+    }
+
+    TimerId timerId = mState->nextTimerId++;
+    auto deadline = chrono::steady_clock::now() + delay;
+    bool isEarliest = mState->callbacks.empty() || deadline < mState->callbacks.begin()->first.first;
+    mState->callbacks.emplace(make_pair(deadline, timerId), std::move(callback));
+    mState->deadlines.emplace(timerId, deadline);
+
+    if (isEarliest) {
+        mState->condition.notify_one();
+    }
+
+    return timerId;
+}
+
+bool DeadlineTimer::cancel(TimerId timerId) {
+    lock_guard<mutex> lock(mState->mutex);
+    auto deadlineIt = mState->deadlines.find(timerId);
+    if (deadlineIt == mState->deadlines.end()) {
+        return false;
+    }
+
+    mState->callbacks.erase(make_pair(deadlineIt->second, timerId));
+    mState->deadlines.erase(deadlineIt);
+    return true;
+}
+
+void DeadlineTimer::run(shared_ptr<State> state) {
+    unique_lock<mutex> lock(state->mutex);
+    while (!state->stopped) {
+        if (state->callbacks.empty()) {
+            state->condition.wait(lock);
+            continue;
+        }
+
+        auto earliestIt = state->callbacks.begin();
+        if (chrono::steady_clock::now() < earliestIt->first.first) {
+            state->condition.wait_until(lock, earliestIt->first.first);
+            continue;
+        }
+
+        Callback callback = std::move(earliestIt->second);
+        state->deadlines.erase(earliestIt->first.second);
+        state->callbacks.erase(earliestIt);
+
+        lock.unlock();
+        callback();
+        // Released before taking the lock, the callback may hold the last
+        // reference to objects that schedule or cancel deadlines when destroyed.
+        callback = nullptr;
+        lock.lock();
+    }
+}
+
+}  // namespace timer
+}  // namespace utilities
+}  // namespace vshl
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_UTILITIES_TIMER_DEADLINETIMER_H_
+#define VSHL_UTILITIES_TIMER_DEADLINETIMER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+namespace vshl {
+namespace utilities {
+namespace timer {
+/*
+ * Runs callbacks once their deadline has passed. All the deadlines share
+ * one worker thread, started on first use, on which the callbacks are run.
+ * Callbacks are invoked without any lock held, so they may schedule or
+ * cancel other deadlines.
+ *
+ * schedule and cancel are virtual so that tests can drive the deadlines
+ * with a clock of their own.
+ */
+class DeadlineTimer {
+public:
+    using TimerId = uint64_t;
+    using Callback = function<void()>;
+
+    // Create a DeadlineTimer.
+    static std::shared_ptr<DeadlineTimer> create();
+
+    /**
+     * Runs @c callback once @c delay has elapsed.
+     *
+     * @return Id to cancel the deadline with.
+     */
+    virtual TimerId schedule(chrono::milliseconds delay, Callback callback);
+
+    /**
+     * Cancels a pending deadline.
+     *
+     * @return true if the callback won't run, false if it already ran or is running.
+     */
+    virtual bool cancel(TimerId timerId);
+
+    // Destructor. Pending callbacks are dropped. When run from one of the
+    // callbacks, the worker thread is left to exit once the callback returns.
+    virtual ~DeadlineTimer();
+
+protected:
+    // Constructor
+    DeadlineTimer();
+
+private:
+    using Deadline = pair<chrono::steady_clock::time_point, TimerId>;
+
+    // State shared with the worker thread, which may outlive the timer.
+    struct State {
+        State() : nextTimerId(1), stopped(false) {
+        }
+
+        // Guards everything below.
+        std::mutex mutex;
+
+        // Signalled when the earliest deadline changes or on shutdown.
+        condition_variable condition;
+
+        // Pending callbacks ordered by deadline.
+        map<Deadline, Callback> callbacks;
+
+        // Deadline of each pending timer, to cancel it.
+        unordered_map<TimerId, chrono::steady_clock::time_point> deadlines;
+
+        // Next timer id.
+        TimerId nextTimerId;
+
+        // Set on destruction.
+        bool stopped;
+    };
+
+    // Worker thread loop.
+    static void run(shared_ptr<State> state);
+
+    // State shared with the worker thread.
+    shared_ptr<State> mState;
+
+    // Worker thread, started on first use. Guarded by the state's mutex.
+    thread mThread;
+};
+
+}  // namespace timer
+}  // namespace utilities
+}  // namespace vshl
+
+#endif  // VSHL_UTILITIES_TIMER_DEADLINETIMER_H_
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+#include "utilities/timer/DeadlineTimer.h"
+
+using namespace vshl::utilities::timer;
+
+namespace vshl {
+namespace test {
+
+TEST(DeadlineTimerTest, runsCallbacksInDeadlineOrder) {
+    auto timer = DeadlineTimer::create();
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    std::promise<void> done;
+    auto record = [&](int value) {
+        std::lock_guard<std::mutex> lock(orderMutex);
+        order.push_back(value);
+        if (order.size() == 3) {
+            done.set_value();
+        }
+    };
+
+    timer->schedule(std::chrono::milliseconds(30), [&]() { record(3); });
+    timer->schedule(std::chrono::milliseconds(10), [&]() { record(1); });
+    timer->schedule(std::chrono::milliseconds(20), [&]() { record(2); });
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    ASSERT_EQ(order, std::vector<int>({1, 2, 3}));
+}
+
+TEST(DeadlineTimerTest, cancelledCallbacksDoNotRun) {
+    auto timer = DeadlineTimer::create();
+
+    std::atomic<int> cancelledRuns(0);
+    std::promise<void> done;
+    auto cancelledId = timer->schedule(std::chrono::milliseconds(10), [&]() { ++cancelledRuns; });
+    timer->schedule(std::chrono::milliseconds(30), [&]() { done.set_value(); });
+
+    ASSERT_TRUE(timer->cancel(cancelledId));
+    ASSERT_FALSE(timer->cancel(cancelledId));
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    ASSERT_EQ(cancelledRuns, 0);
+}
+
+TEST(DeadlineTimerTest, callbackThatRanCanNotBeCancelled) {
+    auto timer = DeadlineTimer::create();
+
+    std::promise<void> done;
+    auto timerId = timer->schedule(std::chrono::milliseconds(0), [&]() { done.set_value(); });
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    ASSERT_FALSE(timer->cancel(timerId));
+}
+
+TEST(DeadlineTimerTest, timerReleasedByItsOwnCallbackStops) {
+    auto timer = std::make_shared<std::shared_ptr<DeadlineTimer>>(DeadlineTimer::create());
+
+    // The callback releases the last reference to the timer, so the
+    // destructor runs on the worker thread.
+    std::promise<void> done;
+    (*timer)->schedule(std::chrono::milliseconds(0), [timer, &done]() {
+        timer->reset();
+        done.set_value();
+    });
+
+    ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+}
+
+}  // namespace test
+}  // namespace vshl
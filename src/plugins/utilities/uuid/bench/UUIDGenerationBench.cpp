@@ -0,0 +1,34 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <benchmark/benchmark.h>
+
+#include "utilities/uuid/UUIDGeneration.h"
+
+#include "bench/common/AllocationCounter.h"
+
+using namespace vshl::bench::common;
+
+namespace {
+
+void BM_UUIDGeneration_GenerateUUID(benchmark::State& state) {
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vshl::utilities::uuid::generateUUID());
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_UUIDGeneration_GenerateUUID);
+
+}  // namespace
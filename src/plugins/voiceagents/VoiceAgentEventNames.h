@@ -26,10 +26,12 @@ namespace voiceagents {
 static string VSHL_EVENT_AUTH_STATE_EVENT = "voice_authstate_event";
 static string VSHL_EVENT_CONNECTION_STATE_EVENT = "voice_connectionstate_event";
 static string VSHL_EVENT_DIALOG_STATE_EVENT = "voice_dialogstate_event";
+// Outcome of an asynchronous startListening request, published by vshl itself.
+static string VSHL_EVENT_START_LISTENING_EVENT = "voice_startlistening_event";
 
 static list<string> VSHL_EVENTS = {
     VSHL_EVENT_AUTH_STATE_EVENT, VSHL_EVENT_CONNECTION_STATE_EVENT,
-    VSHL_EVENT_DIALOG_STATE_EVENT,
+    VSHL_EVENT_DIALOG_STATE_EVENT, VSHL_EVENT_START_LISTENING_EVENT,
 };
 
 } // namespace voiceagents
@@ -16,9 +16,11 @@
 #define VSHL_VOICEAGENTS_INCLUDE_VOICEAGENTS_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "interfaces/afb/IAFBApi.h"
 #include "interfaces/utilities/events/IEventFilter.h"
@@ -27,16 +29,50 @@
 #include "interfaces/voiceagents/IVoiceAgentsChangeObserver.h"
 #include "voiceagents/include/VoiceAgent.h"
 #include "voiceagents/include/VoiceAgentEventsHandler.h"
+#include "voiceagents/include/VoiceAgentsConfig.h"
 
 namespace vshl {
 namespace voiceagents {
+// Subscription process progress of the voiceagents, defined with the implementation.
+struct SubscriptionProcesses;
+
+/*
+ * A view of the voiceagents data. Once published the set of voiceagents, the
+ * default voiceagent and the generation of a snapshot are never changed,
+ * updates publish a new snapshot instead. The @c VoiceAgent objects are shared
+ * between snapshots and their active and wakeword state changes in place.
+ */
+struct VoiceAgentsSnapshot {
+    // Voiceagents grouped by ID
+    unordered_map<string, shared_ptr<VoiceAgent>> voiceAgents;
+
+    // Default voiceagent
+    string defaultVoiceAgentId;
+
+    // Owner voiceagent id by case-folded wakeword, over the wakewords of all the voiceagents.
+    unordered_map<string, string> wakewordIndex;
+
+    // Generation of the voiceagents data.
+    uint64_t generation = 0;
+};
+
 /*
  * This class implements the data model for voiceagents.
  * Supports add, remove and query operations on voiceagent data.
  * Notifies the observers of the changes in the voiceagents data model.
+ *
+ * Readers work on the current @c VoiceAgentsSnapshot, which they get with a
+ * single atomic load and without taking any lock, so they can run on any
+ * number of threads. Writers are serialized, each of them copies the current
+ * snapshot, changes the copy and publishes it. The voiceagents themselves are
+ * not copied, so their active and wakeword state is read from the live
+ * @c VoiceAgent rather than from the snapshot the reader holds.
  */
 class VoiceAgentsDataManager {
 public:
+    // Progress of the subscription process of a voiceagent.
+    enum class SubscriptionState { NOT_STARTED, PENDING, COMPLETED, FAILED };
+
     // Create a VoiceAgentsDataManager.
     static std::unique_ptr<VoiceAgentsDataManager> create(
         shared_ptr<vshl::common::interfaces::ILogger> logger,
@@ -66,7 +102,7 @@ public:
     bool setActiveWakeWord(const string& voiceAgentId, const string& wakeword);
 
     // Adds a new voiceagent to the cache and also persists the information in a
-    // database.
+    // database. Fails if one of its wakewords belongs to another voiceagent.
     // This call would notify all the observers about the new voiceagent addition.
     bool addNewVoiceAgent(
         const string& id,
@@ -83,12 +119,63 @@ public:
     // voiceagent.
     bool removeVoiceAgent(const string& voiceAgentId);
 
+    /**
+     * Makes the voiceagents those of @c config, applying only what differs
+     * from the current ones. Voiceagents missing from @c config are removed
+     * and new ones are added. Voiceagents whose activation or active wakeword
+     * changed are updated in place. The ones whose other fields changed are
+     * replaced, but keep their vshl events and the subscriptions to them.
+     * Unchanged voiceagents are left alone. Observers are only notified of
+     * what changed.
+     *
+     * The whole configuration is checked first and nothing is changed if it
+     * is invalid. All the changes are published in a single snapshot.
+     *
+     * @return true if the configuration was applied.
+     */
+    bool reloadVoiceAgents(const VoiceAgentsConfig& config);
+
+    /**
+     * Returns the voiceagent that owns @c wakeword, compared case-folded, or
+     * nullptr if no voiceagent has it. Takes constant time whatever the number
+     * of voiceagents and wakewords.
+     */
+    shared_ptr<vshl::common::interfaces::IVoiceAgent> findVoiceAgentByWakeword(const string& wakeword) const;
+
+    /**
+     * Returns the form of @c wakeword used to compare wakewords: lower case,
+     * without leading and trailing spaces and with inner spaces collapsed.
+     */
+    static string foldWakeword(const string& wakeword);
+
     // Returns the set of all voice agents in @c VoiceAgentsDataManger cache
     std::set<std::shared_ptr<vshl::common::interfaces::IVoiceAgent>> getAllVoiceAgents();
 
+    /**
+     * Returns the current snapshot of the voiceagents data. Callers that read
+     * several values should use a single snapshot to get a consistent view.
+     */
+    shared_ptr<const VoiceAgentsSnapshot> getSnapshot() const;
+
+    /**
+     * Returns the generation of the voiceagents data. The generation is bumped
+     * every time a voiceagent is added, removed, activated, deactivated, the
+     * default voiceagent changes, an active wakeword changes or the voiceagents
+     * are reloaded with a different configuration. Callers can use
+     * it to find out whether data derived from @c getAllVoiceAgents is stale.
+     */
+    uint64_t getGeneration() const;
+
     // Returns the event filter that belongs to the core module.
     shared_ptr<vshl::common::interfaces::IEventFilter> getEventFilter() const;
 
+    // Coalesces the payloads of a vshl event of all the voiceagents.
+    bool setEventCoalescingPolicy(const string& eventName, const vshl::utilities::events::CoalescingPolicy& policy);
+
+    // False if nobody listens to the vshl event of the voiceagent, so that
+    // its payload need not be built.
+    bool hasVshlEventSubscribers(const string& eventName, const string& voiceAgentId);
+
     // Subscribe to an event coming from the voiceagent.
     bool subscribeToVshlEventFromVoiceAgent(
         vshl::common::interfaces::IAFBRequest& request,
@@ -101,9 +188,21 @@ public:
     // Removes the  voiceagent change observer from the list.
     bool removeVoiceAgentsChangeObserver(shared_ptr<vshl::common::interfaces::IVoiceAgentsChangeObserver> observer);
 
-    // Trigger the low level voice agents to do their subscriptions.
+    /**
+     * Triggers the low level voice agents to do their subscriptions. The
+     * voiceagents are all called at once, so the process takes as long as the
+     * slowest of them. Only the voiceagents whose process was not started or
+     * failed are called, so it is cheap to call again. Once it was called,
+     * voiceagents added later start their process right away.
+     */
     void startNewSubscriptionProcess();
 
+    // Returns the progress of the subscription process of a voiceagent.
+    SubscriptionState getSubscriptionState(const string& voiceAgentId) const;
+
+    // Returns the name of @c state, as reported in the health of the service.
+    static string getSubscriptionStateName(SubscriptionState state);
+
     // Destructor
     ~VoiceAgentsDataManager();
 
@@ -117,25 +216,39 @@ private:
     // for capability message subscriptions.
     void callStartSubscriptionProcessAPI(const shared_ptr<VoiceAgent> voiceAgent);
 
+    // Starts the subscription process of voiceagents that were just added, if
+    // startNewSubscriptionProcess was called.
+    void startSubscriptionProcessOfNewVoiceAgents(const vector<shared_ptr<VoiceAgent>>& voiceAgents);
+
+    // Publishes @c snapshot as the current one. Must be called with mWriteMutex held.
+    void publishSnapshot(shared_ptr<VoiceAgentsSnapshot> snapshot);
+
+    // Returns a copy of the current observers.
+    unordered_set<shared_ptr<vshl::common::interfaces::IVoiceAgentsChangeObserver>> getObservers();
+
     // Binding API reference
     shared_ptr<vshl::common::interfaces::IAFBApi> mAfbApi;
 
+    // Guards the observers list.
+    mutex mObserversMutex;
+
     // A list of all the voiceagent change observers
     unordered_set<shared_ptr<vshl::common::interfaces::IVoiceAgentsChangeObserver>> mVoiceAgentChangeObservers;
 
-    // A map of voiceagents grouped by ID
-    unordered_map<string, shared_ptr<VoiceAgent>> mVoiceAgents;
+    // Serializes the writers.
+    mutex mWriteMutex;
+
+    // Current snapshot, only accessed with the std::atomic_load/atomic_store functions.
+    shared_ptr<const VoiceAgentsSnapshot> mSnapshot;
 
     // Voiceagent event handler.
     shared_ptr<VoiceAgentEventsHandler> mVoiceAgentEventsHandler;
 
-    // Default voiceagent
-    string mDefaultVoiceAgentId;
-
     // Logger
     shared_ptr<vshl::common::interfaces::ILogger> mLogger;
 
-    bool mAlreadyPeformedSubscriptions;
+    // Subscription process progress by voiceagent id, shared with the calls in flight.
+    shared_ptr<SubscriptionProcesses> mSubscriptionProcesses;
 };
 
 }  // namespace voiceagents
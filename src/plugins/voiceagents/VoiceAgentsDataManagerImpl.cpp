@@ -14,6 +14,9 @@
  */
 #include "voiceagents/VoiceAgentsDataManager.h"
 
+#include <cctype>
+#include <vector>
+
 #include "voiceagents/include/VoiceAgentEventsHandler.h"
 
 static string TAG = "vshl::voiceagents::VoiceAgentsDataManager";
@@ -27,6 +30,16 @@ using Level = vshl::common::interfaces::ILogger::Level;
 namespace vshl {
 namespace voiceagents {
 
+struct SubscriptionProcesses {
+    std::mutex mutex;
+
+    // Whether startNewSubscriptionProcess was called.
+    bool started = false;
+
+    // Progress by voiceagent id, absent voiceagents were not started.
+    unordered_map<string, VoiceAgentsDataManager::SubscriptionState> states;
+};
+
 std::unique_ptr<VoiceAgentsDataManager> VoiceAgentsDataManager::create(
     shared_ptr<vshl::common::interfaces::ILogger> logger,
     shared_ptr<vshl::common::interfaces::IAFBApi> afbApi) {
@@ -38,9 +51,10 @@ VoiceAgentsDataManager::VoiceAgentsDataManager(
     shared_ptr<vshl::common::interfaces::ILogger> logger,
     shared_ptr<vshl::common::interfaces::IAFBApi> afbApi) :
         mLogger(logger),
-        mAfbApi(afbApi) {
+        mAfbApi(afbApi),
+        mSnapshot(make_shared<VoiceAgentsSnapshot>()),
+        mSubscriptionProcesses(make_shared<SubscriptionProcesses>()) {
     mVoiceAgentEventsHandler = VoiceAgentEventsHandler::create(mLogger, mAfbApi);
-    mAlreadyPeformedSubscriptions = false;
 }
 
 // Destructor
@@ -48,25 +62,45 @@ VoiceAgentsDataManager::~VoiceAgentsDataManager() {
     // Clear the observers
     mVoiceAgentChangeObservers.clear();
     // Clear the voiceagents
-    mVoiceAgents.clear();
+    std::atomic_store(&mSnapshot, shared_ptr<const VoiceAgentsSnapshot>(make_shared<VoiceAgentsSnapshot>()));
+}
+
+shared_ptr<const VoiceAgentsSnapshot> VoiceAgentsDataManager::getSnapshot() const {
+    return std::atomic_load(&mSnapshot);
+}
+
+void VoiceAgentsDataManager::publishSnapshot(shared_ptr<VoiceAgentsSnapshot> snapshot) {
+    std::atomic_store(&mSnapshot, shared_ptr<const VoiceAgentsSnapshot>(std::move(snapshot)));
+}
+
+unordered_set<shared_ptr<vshl::common::interfaces::IVoiceAgentsChangeObserver>> VoiceAgentsDataManager::
+    getObservers() {
+    lock_guard<mutex> lock(mObserversMutex);
+    return mVoiceAgentChangeObservers;
 }
 
 uint32_t VoiceAgentsDataManager::activateVoiceAgents(const unordered_set<string>& activeVoiceAgentIds) {
-    if (activeVoiceAgentIds.empty() || mVoiceAgents.empty()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (activeVoiceAgentIds.empty() || current->voiceAgents.empty()) {
         mLogger->log(Level::ERROR, TAG, "Failed to activate voiceagents");
         return 0;
     }
 
     uint32_t agentsActivated = 0;
     for (auto voiceAgentId : activeVoiceAgentIds) {
-        auto voiceAgentIt = mVoiceAgents.find(voiceAgentId);
-        if (voiceAgentIt != mVoiceAgents.end()) {
+        auto voiceAgentIt = current->voiceAgents.find(voiceAgentId);
+        if (voiceAgentIt != current->voiceAgents.end()) {
             // activate the voiceagent
             ++agentsActivated;
             if (!voiceAgentIt->second->isActive()) {
                 voiceAgentIt->second->setIsActive(true);
+                auto next = make_shared<VoiceAgentsSnapshot>(*current);
+                ++next->generation;
+                publishSnapshot(next);
+                current = getSnapshot();
                 // Notify observers
-                for (auto observer : mVoiceAgentChangeObservers) {
+                for (auto observer : getObservers()) {
                     observer->OnVoiceAgentActivated(voiceAgentIt->second);
                 }
             }
@@ -76,21 +110,27 @@ uint32_t VoiceAgentsDataManager::activateVoiceAgents(const unordered_set<string>
 }
 
 uint32_t VoiceAgentsDataManager::deactivateVoiceAgents(const unordered_set<string>& inactiveVoiceAgentIds) {
-    if (inactiveVoiceAgentIds.empty() || mVoiceAgents.empty()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (inactiveVoiceAgentIds.empty() || current->voiceAgents.empty()) {
         mLogger->log(Level::ERROR, TAG, "Failed to deactivate voiceagents");
         return 0;
     }
 
     uint32_t agentsDeactivated = 0;
     for (auto voiceAgentId : inactiveVoiceAgentIds) {
-        auto voiceAgentIt = mVoiceAgents.find(voiceAgentId);
-        if (voiceAgentIt != mVoiceAgents.end()) {
+        auto voiceAgentIt = current->voiceAgents.find(voiceAgentId);
+        if (voiceAgentIt != current->voiceAgents.end()) {
             ++agentsDeactivated;
             if (voiceAgentIt->second->isActive()) {
                 // deactivate the voiceagent
                 voiceAgentIt->second->setIsActive(false);
+                auto next = make_shared<VoiceAgentsSnapshot>(*current);
+                ++next->generation;
+                publishSnapshot(next);
+                current = getSnapshot();
                 // Notify observers
-                for (auto observer : mVoiceAgentChangeObservers) {
+                for (auto observer : getObservers()) {
                     observer->OnVoiceAgentDeactivated(voiceAgentIt->second);
                 }
             }
@@ -101,22 +141,27 @@ uint32_t VoiceAgentsDataManager::deactivateVoiceAgents(const unordered_set<strin
 }
 
 bool VoiceAgentsDataManager::setDefaultVoiceAgent(const string& voiceAgentId) {
-    if (mVoiceAgents.empty() || voiceAgentId.empty()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (current->voiceAgents.empty() || voiceAgentId.empty()) {
         string message = string("Failed to set default voiceagent id: ") + voiceAgentId;
         mLogger->log(Level::ERROR, TAG, message);
         return false;
     }
 
-    auto defaultVoiceAgentIt = mVoiceAgents.find(voiceAgentId);
+    auto defaultVoiceAgentIt = current->voiceAgents.find(voiceAgentId);
 
-    if (defaultVoiceAgentIt != mVoiceAgents.end()) {
-        if (mDefaultVoiceAgentId != voiceAgentId) {
+    if (defaultVoiceAgentIt != current->voiceAgents.end()) {
+        if (current->defaultVoiceAgentId != voiceAgentId) {
+            auto next = make_shared<VoiceAgentsSnapshot>(*current);
+            next->defaultVoiceAgentId = voiceAgentId;
+            ++next->generation;
+            publishSnapshot(next);
             // Notify observers
-            for (auto observer : mVoiceAgentChangeObservers) {
+            for (auto observer : getObservers()) {
                 observer->OnDefaultVoiceAgentChanged(defaultVoiceAgentIt->second);
             }
         }
-        mDefaultVoiceAgentId = voiceAgentId;
     } else {
         mLogger->log(Level::ERROR, TAG, "Can't set default agent. Invalid voice agent id:" + voiceAgentId);
         return false;
@@ -126,27 +171,49 @@ bool VoiceAgentsDataManager::setDefaultVoiceAgent(const string& voiceAgentId) {
 }
 
 std::string VoiceAgentsDataManager::getDefaultVoiceAgent() {
-    return mDefaultVoiceAgentId;
+    return getSnapshot()->defaultVoiceAgentId;
 }
 
 bool VoiceAgentsDataManager::setActiveWakeWord(const string& voiceAgentId, const string& wakeword) {
-    if (mVoiceAgents.empty() || wakeword.empty()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (current->voiceAgents.empty() || wakeword.empty()) {
         string message =
             string("Failed to set active wakeword: ") + wakeword + string(" for voiceagent id: ") + voiceAgentId;
         mLogger->log(Level::ERROR, TAG, message);
         return false;
     }
 
-    auto voiceAgentIt = mVoiceAgents.find(voiceAgentId);
-    if (voiceAgentIt == mVoiceAgents.end()) {
+    auto voiceAgentIt = current->voiceAgents.find(voiceAgentId);
+    if (voiceAgentIt == current->voiceAgents.end()) {
         return false;
     }
 
+    // The wakeword may be spelled differently, the voiceagent keeps its own spelling.
+    string foldedWakeword = foldWakeword(wakeword);
+    auto ownerIt = current->wakewordIndex.find(foldedWakeword);
+    if (ownerIt == current->wakewordIndex.end() || ownerIt->second != voiceAgentId) {
+        mLogger->log(
+            Level::ERROR, TAG, "Wakeword: " + wakeword + " doesn't belong to voiceagent id: " + voiceAgentId);
+        return false;
+    }
+
+    string activeWakeword = wakeword;
+    for (auto& ownWakeword : *voiceAgentIt->second->getWakeWords()) {
+        if (foldWakeword(ownWakeword) == foldedWakeword) {
+            activeWakeword = ownWakeword;
+            break;
+        }
+    }
+
     string oldWakeWord = voiceAgentIt->second->getActiveWakeword();
-    if (oldWakeWord != wakeword) {
-        voiceAgentIt->second->setActiveWakeWord(wakeword);
+    if (oldWakeWord != activeWakeword) {
+        voiceAgentIt->second->setActiveWakeWord(activeWakeword);
+        auto next = make_shared<VoiceAgentsSnapshot>(*current);
+        ++next->generation;
+        publishSnapshot(next);
         // Notify observers
-        for (auto observer : mVoiceAgentChangeObservers) {
+        for (auto observer : getObservers()) {
             observer->OnVoiceAgentActiveWakeWordChanged(voiceAgentIt->second);
         }
     }
@@ -172,37 +239,281 @@ bool VoiceAgentsDataManager::addNewVoiceAgent(
         return false;
     }
 
-    if (!mVoiceAgents.empty() && mVoiceAgents.find(voiceAgent->getId()) != mVoiceAgents.end()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (current->voiceAgents.find(voiceAgent->getId()) != current->voiceAgents.end()) {
         string message =
             string("Failed to add new voiceagent. Voiceagent: ") + voiceAgent->getId() + string(" already exists.");
         mLogger->log(Level::ERROR, TAG, message);
         return false;
     }
 
-    mVoiceAgents.insert(make_pair(voiceAgent->getId(), voiceAgent));
+    // A wakeword must lead to a single voiceagent.
+    for (auto& wakeword : *wakewords) {
+        auto ownerIt = current->wakewordIndex.find(foldWakeword(wakeword));
+        if (ownerIt != current->wakewordIndex.end()) {
+            string message = string("Failed to add new voiceagent: ") + voiceAgent->getId() +
+                             string(". Wakeword: ") + wakeword + string(" belongs to voiceagent: ") +
+                             ownerIt->second;
+            mLogger->log(Level::ERROR, TAG, message);
+            return false;
+        }
+    }
+
+    // Create all vshl events for the voiceagent before readers can find it.
+    mVoiceAgentEventsHandler->createVshlEventsForVoiceAgent(voiceAgent->getId());
+
+    auto next = make_shared<VoiceAgentsSnapshot>(*current);
+    next->voiceAgents.insert(make_pair(voiceAgent->getId(), voiceAgent));
+    for (auto& wakeword : *wakewords) {
+        next->wakewordIndex[foldWakeword(wakeword)] = voiceAgent->getId();
+    }
+    ++next->generation;
+    publishSnapshot(next);
 
     // Notify the observers
-    for (auto observer : mVoiceAgentChangeObservers) {
+    for (auto observer : getObservers()) {
         observer->OnVoiceAgentAdded(voiceAgent);
     }
 
-    // Create all vshl events for the voiceagent.
-    mVoiceAgentEventsHandler->createVshlEventsForVoiceAgent(voiceAgent->getId());
+    startSubscriptionProcessOfNewVoiceAgents({voiceAgent});
+
+    return true;
+}
+
+bool VoiceAgentsDataManager::reloadVoiceAgents(const VoiceAgentsConfig& config) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+
+    // Build the next snapshot from the configuration, reusing the voiceagents
+    // that can be updated in place. Nothing is changed until it is complete.
+    auto next = make_shared<VoiceAgentsSnapshot>();
+    next->defaultVoiceAgentId = config.defaultVoiceAgentId;
+    next->generation = current->generation + 1;
+
+    vector<shared_ptr<VoiceAgent>> addedVoiceAgents;
+    vector<shared_ptr<VoiceAgent>> updatedVoiceAgents;
+    vector<shared_ptr<VoiceAgent>> resubscribedVoiceAgents;
+    vector<pair<shared_ptr<VoiceAgent>, const VoiceAgentConfig*>> keptVoiceAgents;
+    for (auto& agentConfig : config.agents) {
+        if (agentConfig.id.empty() || next->voiceAgents.find(agentConfig.id) != next->voiceAgents.end()) {
+            mLogger->log(Level::ERROR, TAG, "Failed to reload voiceagents. Invalid voiceagent id: " + agentConfig.id);
+            return false;
+        }
+
+        auto wakewords =
+            make_shared<unordered_set<string>>(agentConfig.wakewords.begin(), agentConfig.wakewords.end());
+        for (auto& wakeword : *wakewords) {
+            auto indexIt = next->wakewordIndex.insert(make_pair(foldWakeword(wakeword), agentConfig.id)).first;
+            if (indexIt->second != agentConfig.id) {
+                string message = string("Failed to reload voiceagents. Wakeword: ") + wakeword +
+                                 string(" belongs to voiceagents: ") + indexIt->second + string(" and ") +
+                                 agentConfig.id;
+                mLogger->log(Level::ERROR, TAG, message);
+                return false;
+            }
+        }
+
+        shared_ptr<VoiceAgent> voiceAgent;
+        auto currentIt = current->voiceAgents.find(agentConfig.id);
+        if (currentIt != current->voiceAgents.end() && currentIt->second->getName() == agentConfig.name &&
+            currentIt->second->getDescription() == agentConfig.description &&
+            currentIt->second->getApi() == agentConfig.api && currentIt->second->getVendor() == agentConfig.vendor &&
+            *currentIt->second->getWakeWords() == *wakewords) {
+            if (wakewords->find(agentConfig.activeWakeword) == wakewords->end()) {
+                mLogger->log(
+                    Level::ERROR,
+                    TAG,
+                    "Failed to reload voiceagents. Invalid active wakeword of voiceagent: " + agentConfig.id);
+                return false;
+            }
+            voiceAgent = currentIt->second;
+            keptVoiceAgents.push_back(make_pair(voiceAgent, &agentConfig));
+        } else {
+            voiceAgent = VoiceAgent::create(
+                mLogger,
+                agentConfig.id,
+                agentConfig.name,
+                agentConfig.description,
+                agentConfig.api,
+                agentConfig.vendor,
+                agentConfig.activeWakeword,
+                agentConfig.isActive,
+                wakewords);
+            if (!voiceAgent) {
+                mLogger->log(Level::ERROR, TAG, "Failed to reload voiceagents. Invalid voiceagent: " + agentConfig.id);
+                return false;
+            }
+
+            if (currentIt == current->voiceAgents.end()) {
+                addedVoiceAgents.push_back(voiceAgent);
+            } else {
+                updatedVoiceAgents.push_back(voiceAgent);
+                if (currentIt->second->getApi() != agentConfig.api) {
+                    resubscribedVoiceAgents.push_back(voiceAgent);
+                }
+            }
+        }
+        next->voiceAgents.insert(make_pair(agentConfig.id, voiceAgent));
+    }
+
+    auto defaultVoiceAgentIt = next->voiceAgents.find(config.defaultVoiceAgentId);
+    if (defaultVoiceAgentIt == next->voiceAgents.end()) {
+        mLogger->log(
+            Level::ERROR,
+            TAG,
+            "Failed to reload voiceagents. Invalid default voiceagent id: " + config.defaultVoiceAgentId);
+        return false;
+    }
+
+    vector<shared_ptr<VoiceAgent>> removedVoiceAgents;
+    for (auto& element : current->voiceAgents) {
+        if (next->voiceAgents.find(element.first) == next->voiceAgents.end()) {
+            removedVoiceAgents.push_back(element.second);
+        }
+    }
+
+    vector<shared_ptr<VoiceAgent>> wakewordChangedVoiceAgents;
+    vector<shared_ptr<VoiceAgent>> activatedVoiceAgents;
+    vector<shared_ptr<VoiceAgent>> deactivatedVoiceAgents;
+    for (auto& kept : keptVoiceAgents) {
+        if (kept.first->getActiveWakeword() != kept.second->activeWakeword) {
+            wakewordChangedVoiceAgents.push_back(kept.first);
+        }
+        if (kept.first->isActive() != kept.second->isActive) {
+            (kept.second->isActive ? activatedVoiceAgents : deactivatedVoiceAgents).push_back(kept.first);
+        }
+    }
+
+    bool defaultChanged = current->defaultVoiceAgentId != config.defaultVoiceAgentId;
+    if (addedVoiceAgents.empty() && updatedVoiceAgents.empty() && removedVoiceAgents.empty() &&
+        wakewordChangedVoiceAgents.empty() && activatedVoiceAgents.empty() && deactivatedVoiceAgents.empty() &&
+        !defaultChanged) {
+        return true;
+    }
+
+    // Create all vshl events for the new voiceagents before readers can find them.
+    for (auto& voiceAgent : addedVoiceAgents) {
+        mVoiceAgentEventsHandler->createVshlEventsForVoiceAgent(voiceAgent->getId());
+    }
+
+    for (auto& kept : keptVoiceAgents) {
+        kept.first->setActiveWakeWord(kept.second->activeWakeword);
+        kept.first->setIsActive(kept.second->isActive);
+    }
+    publishSnapshot(next);
+
+    // Notify the observers
+    auto observers = getObservers();
+    for (auto observer : observers) {
+        for (auto& voiceAgent : removedVoiceAgents) {
+            observer->OnVoiceAgentRemoved(voiceAgent);
+        }
+        for (auto& voiceAgent : addedVoiceAgents) {
+            observer->OnVoiceAgentAdded(voiceAgent);
+        }
+        for (auto& voiceAgent : updatedVoiceAgents) {
+            observer->OnVoiceAgentUpdated(voiceAgent);
+        }
+        for (auto& voiceAgent : wakewordChangedVoiceAgents) {
+            observer->OnVoiceAgentActiveWakeWordChanged(voiceAgent);
+        }
+        for (auto& voiceAgent : activatedVoiceAgents) {
+            observer->OnVoiceAgentActivated(voiceAgent);
+        }
+        for (auto& voiceAgent : deactivatedVoiceAgents) {
+            observer->OnVoiceAgentDeactivated(voiceAgent);
+        }
+        if (defaultChanged) {
+            observer->OnDefaultVoiceAgentChanged(defaultVoiceAgentIt->second);
+        }
+    }
+
+    // Remove all vshl events for the removed voiceagents.
+    for (auto& voiceAgent : removedVoiceAgents) {
+        mVoiceAgentEventsHandler->removeVshlEventsForVoiceAgent(voiceAgent->getId());
+    }
+
+    // Voiceagents now behind another api go through the subscription process again.
+    {
+        lock_guard<mutex> lock(mSubscriptionProcesses->mutex);
+        for (auto& voiceAgent : removedVoiceAgents) {
+            mSubscriptionProcesses->states.erase(voiceAgent->getId());
+        }
+        for (auto& voiceAgent : resubscribedVoiceAgents) {
+            mSubscriptionProcesses->states.erase(voiceAgent->getId());
+        }
+    }
+    addedVoiceAgents.insert(addedVoiceAgents.end(), resubscribedVoiceAgents.begin(), resubscribedVoiceAgents.end());
+    startSubscriptionProcessOfNewVoiceAgents(addedVoiceAgents);
 
     return true;
 }
 
+void VoiceAgentsDataManager::startSubscriptionProcessOfNewVoiceAgents(
+    const vector<shared_ptr<VoiceAgent>>& voiceAgents) {
+    // Skip those whose process a concurrent startNewSubscriptionProcess started.
+    vector<shared_ptr<VoiceAgent>> startedVoiceAgents;
+    {
+        lock_guard<mutex> lock(mSubscriptionProcesses->mutex);
+        if (!mSubscriptionProcesses->started) {
+            return;
+        }
+
+        auto& states = mSubscriptionProcesses->states;
+        for (auto& voiceAgent : voiceAgents) {
+            if (states.find(voiceAgent->getId()) == states.end()) {
+                states[voiceAgent->getId()] = SubscriptionState::PENDING;
+                startedVoiceAgents.push_back(voiceAgent);
+            }
+        }
+    }
+
+    for (auto& voiceAgent : startedVoiceAgents) {
+        callStartSubscriptionProcessAPI(voiceAgent);
+    }
+}
+
 void VoiceAgentsDataManager::startNewSubscriptionProcess() {
-    if (mAlreadyPeformedSubscriptions)
-        return;
+    auto current = getSnapshot();
+    vector<shared_ptr<VoiceAgent>> voiceAgents;
+    {
+        lock_guard<mutex> lock(mSubscriptionProcesses->mutex);
+        mSubscriptionProcesses->started = true;
+        for (auto& element : current->voiceAgents) {
+            auto stateIt = mSubscriptionProcesses->states.find(element.first);
+            if (stateIt == mSubscriptionProcesses->states.end() || stateIt->second == SubscriptionState::FAILED) {
+                mSubscriptionProcesses->states[element.first] = SubscriptionState::PENDING;
+                voiceAgents.push_back(element.second);
+            }
+        }
+    }
 
-    for (auto agent : mVoiceAgents) {
-        // Temporarily added to trigger the voiceagent to start the capability
-        // subscription process.
-        callStartSubscriptionProcessAPI(agent.second);
-        mAlreadyPeformedSubscriptions = true;
+    // Temporarily added to trigger the voiceagents to start the capability
+    // subscription process. The calls don't wait for each other.
+    for (auto& voiceAgent : voiceAgents) {
+        callStartSubscriptionProcessAPI(voiceAgent);
     }
+}
 
+VoiceAgentsDataManager::SubscriptionState VoiceAgentsDataManager::getSubscriptionState(
+    const string& voiceAgentId) const {
+    lock_guard<mutex> lock(mSubscriptionProcesses->mutex);
+    auto stateIt = mSubscriptionProcesses->states.find(voiceAgentId);
+    return stateIt != mSubscriptionProcesses->states.end() ? stateIt->second : SubscriptionState::NOT_STARTED;
+}
+
+string VoiceAgentsDataManager::getSubscriptionStateName(SubscriptionState state) {
+    switch (state) {
+        case SubscriptionState::PENDING:
+            return "pending";
+        case SubscriptionState::COMPLETED:
+            return "completed";
+        case SubscriptionState::FAILED:
+            return "failed";
+        default:
+            return "not-started";
+    }
 }
 
 void VoiceAgentsDataManager::callStartSubscriptionProcessAPI(const shared_ptr<VoiceAgent> voiceAgent) {
@@ -211,33 +522,56 @@ void VoiceAgentsDataManager::callStartSubscriptionProcessAPI(const shared_ptr<Vo
         return;
     }
 
+    weak_ptr<SubscriptionProcesses> weakProcesses = mSubscriptionProcesses;
+    auto onCompleted = [weakProcesses](const string& voiceAgentId, bool succeeded) {
+        auto processes = weakProcesses.lock();
+        if (!processes) {
+            return;
+        }
+
+        // The voiceagent may have been removed meanwhile.
+        lock_guard<mutex> lock(processes->mutex);
+        auto stateIt = processes->states.find(voiceAgentId);
+        if (stateIt != processes->states.end() && stateIt->second == SubscriptionState::PENDING) {
+            stateIt->second = succeeded ? SubscriptionState::COMPLETED : SubscriptionState::FAILED;
+        }
+    };
+
+    string voiceAgentId = voiceAgent->getId();
     if (!mAfbApi) {
         mLogger->log(
-            Level::ERROR, TAG, "Failed to mAfbApi on voicegent: " + voiceAgent->getId() + ", No API.");
+            Level::ERROR, TAG, "Failed to mAfbApi on voicegent: " + voiceAgentId + ", No API.");
+        onCompleted(voiceAgentId, false);
         return;
     }
 
-    // TODO(Naveen): Move to utilities.
-    json_object* object = NULL;
-    std::string error, info;
-    int rc = mAfbApi->callSync(voiceAgent->getApi(), VA_VERB_START_SUBSCRIPTION_PROCESS, NULL, &object, error, info);
-
-    if (object) {
-        free(object);
-    }
-
-    return;
+    auto logger = mLogger;
+    mAfbApi->callAsync(
+        voiceAgent->getApi(),
+        VA_VERB_START_SUBSCRIPTION_PROCESS,
+        vshl::utilities::json::JsonHandle(),
+        [logger, voiceAgentId, onCompleted](int rc, json_object* result, const string& error, const string& info) {
+            if (rc != 0) {
+                logger->log(
+                    Level::WARNING,
+                    TAG,
+                    "Failed to start subscription process on voiceagent: " + voiceAgentId + ", " + error);
+            }
+            onCompleted(voiceAgentId, rc == 0);
+        });
 }
 
 bool VoiceAgentsDataManager::removeVoiceAgent(const string& voiceAgentId) {
-    if (mVoiceAgents.empty()) {
+    lock_guard<mutex> writeLock(mWriteMutex);
+    auto current = getSnapshot();
+    if (current->voiceAgents.empty()) {
         string message = string("Failed to remove voiceagent: ") + voiceAgentId + string(". Voiceagents data empty.");
         mLogger->log(Level::ERROR, TAG, message);
         return false;
     }
 
-    auto voiceAgentIt = mVoiceAgents.find(voiceAgentId);
-    if (voiceAgentIt == mVoiceAgents.end()) {
+    auto voiceAgentIt = current->voiceAgents.find(voiceAgentId);
+    if (voiceAgentIt == current->voiceAgents.end()) {
         string message = string("Failed to remove voiceagent: ") + voiceAgentId + string(". Doesn't exist.");
         mLogger->log(Level::ERROR, TAG, message);
         return false;
@@ -245,38 +579,93 @@ bool VoiceAgentsDataManager::removeVoiceAgent(const string& voiceAgentId) {
 
     auto voiceAgent = voiceAgentIt->second;
     // Remove from the map
-    mVoiceAgents.erase(voiceAgentId);
+    auto next = make_shared<VoiceAgentsSnapshot>(*current);
+    next->voiceAgents.erase(voiceAgentId);
+    for (auto& wakeword : *voiceAgent->getWakeWords()) {
+        next->wakewordIndex.erase(foldWakeword(wakeword));
+    }
+    ++next->generation;
+    publishSnapshot(next);
     // Notify the observers
-    for (auto observer : mVoiceAgentChangeObservers) {
+    for (auto observer : getObservers()) {
         observer->OnVoiceAgentRemoved(voiceAgent);
     }
 
     // Remove all vshl events for the voiceagent.
     mVoiceAgentEventsHandler->removeVshlEventsForVoiceAgent(voiceAgent->getId());
 
+    lock_guard<mutex> lock(mSubscriptionProcesses->mutex);
+    mSubscriptionProcesses->states.erase(voiceAgent->getId());
+
     return true;
 }
 
 std::set<std::shared_ptr<vshl::common::interfaces::IVoiceAgent>> VoiceAgentsDataManager::getAllVoiceAgents() {
     std::set<std::shared_ptr<vshl::common::interfaces::IVoiceAgent>> voiceAgentsSet;
-    for (auto element : mVoiceAgents) {
+    for (auto element : getSnapshot()->voiceAgents) {
         voiceAgentsSet.insert(element.second);
     }
 
     return voiceAgentsSet;
 }
 
+shared_ptr<vshl::common::interfaces::IVoiceAgent> VoiceAgentsDataManager::findVoiceAgentByWakeword(
+    const string& wakeword) const {
+    auto current = getSnapshot();
+    auto ownerIt = current->wakewordIndex.find(foldWakeword(wakeword));
+    if (ownerIt == current->wakewordIndex.end()) {
+        return nullptr;
+    }
+
+    auto voiceAgentIt = current->voiceAgents.find(ownerIt->second);
+    return voiceAgentIt != current->voiceAgents.end() ? voiceAgentIt->second : nullptr;
+}
+
+string VoiceAgentsDataManager::foldWakeword(const string& wakeword) {
+    string folded;
+    folded.reserve(wakeword.size());
+    bool pendingSpace = false;
+    for (char c : wakeword) {
+        if (isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !folded.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            folded += ' ';
+            pendingSpace = false;
+        }
+        folded += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+
+    return folded;
+}
+
+uint64_t VoiceAgentsDataManager::getGeneration() const {
+    return getSnapshot()->generation;
+}
+
 // Returns the event filter that belongs to the core module.
 shared_ptr<vshl::common::interfaces::IEventFilter> VoiceAgentsDataManager::getEventFilter() const {
     return mVoiceAgentEventsHandler;
 }
 
+bool VoiceAgentsDataManager::setEventCoalescingPolicy(
+    const string& eventName,
+    const vshl::utilities::events::CoalescingPolicy& policy) {
+    return mVoiceAgentEventsHandler->setCoalescingPolicy(eventName, policy);
+}
+
+bool VoiceAgentsDataManager::hasVshlEventSubscribers(const string& eventName, const string& voiceAgentId) {
+    return mVoiceAgentEventsHandler->hasSubscribers(eventName, voiceAgentId);
+}
+
 bool VoiceAgentsDataManager::subscribeToVshlEventFromVoiceAgent(
     vshl::common::interfaces::IAFBRequest& request,
     const string eventName,
     const string voiceAgentId) {
-    auto voiceAgentIt = mVoiceAgents.find(voiceAgentId);
-    if (voiceAgentIt == mVoiceAgents.end()) {
+    auto current = getSnapshot();
+    auto voiceAgentIt = current->voiceAgents.find(voiceAgentId);
+    if (voiceAgentIt == current->voiceAgents.end()) {
         mLogger->log(
             Level::ERROR,
             TAG,
@@ -294,6 +683,7 @@ bool VoiceAgentsDataManager::addVoiceAgentsChangeObserver(
         return false;
     }
 
+    lock_guard<mutex> lock(mObserversMutex);
     mVoiceAgentChangeObservers.insert(observer);
     return true;
 }
@@ -304,6 +694,7 @@ bool VoiceAgentsDataManager::removeVoiceAgentsChangeObserver(
         return false;
     }
 
+    lock_guard<mutex> lock(mObserversMutex);
     mVoiceAgentChangeObservers.erase(observer);
     return true;
 }
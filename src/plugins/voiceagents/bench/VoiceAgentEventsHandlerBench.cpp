@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <benchmark/benchmark.h>
+
+#include "voiceagents/VoiceAgentEventNames.h"
+#include "voiceagents/include/VoiceAgentEventsHandler.h"
+
+#include "bench/common/AllocationCounter.h"
+#include "bench/fakes/FakeAFBApi.h"
+#include "bench/fakes/NullLogger.h"
+
+using namespace vshl::bench::common;
+using namespace vshl::bench::fakes;
+using namespace vshl::voiceagents;
+
+namespace {
+
+static const char* DIALOG_STATE_EVENT = "{\"va_id\":\"VA-001\",\"state\":\"THINKING\"}";
+
+void BM_VoiceAgentEventsHandler_OnIncomingEvent(benchmark::State& state) {
+    auto handler = VoiceAgentEventsHandler::create(std::make_shared<NullLogger>(), std::make_shared<FakeAFBApi>());
+    handler->createVshlEventsForVoiceAgent("VA-001");
+    std::shared_ptr<vshl::common::interfaces::IEventFilter> eventFilter = handler;
+    json_object* payload = json_tokener_parse(DIALOG_STATE_EVENT);
+
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(eventFilter->onIncomingEvent(VSHL_EVENT_DIALOG_STATE_EVENT, "VA-001", payload));
+    }
+    reportAllocations(state, allocations);
+
+    json_object_put(payload);
+}
+BENCHMARK(BM_VoiceAgentEventsHandler_OnIncomingEvent);
+
+}  // namespace
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <benchmark/benchmark.h>
+
+#include "voiceagents/VoiceAgentsDataManager.h"
+
+#include "bench/common/AllocationCounter.h"
+#include "bench/fakes/FakeAFBApi.h"
+#include "bench/fakes/NullLogger.h"
+
+using namespace vshl::bench::common;
+using namespace vshl::bench::fakes;
+using namespace vshl::voiceagents;
+
+namespace {
+
+std::string getVoiceAgentId(int64_t idx) {
+    return "VA-" + std::to_string(idx);
+}
+
+std::unique_ptr<VoiceAgentsDataManager> createDataManager() {
+    return VoiceAgentsDataManager::create(std::make_shared<NullLogger>(), std::make_shared<FakeAFBApi>());
+}
+
+// Wakewords belong to a single voiceagent, so they are made unique with the voiceagent id.
+std::string getWakeword(const std::string& voiceAgentId, const std::string& name) {
+    return name + " " + voiceAgentId;
+}
+
+void addVoiceAgent(VoiceAgentsDataManager& dataManager, const std::string& voiceAgentId) {
+    auto wakewords = std::make_shared<std::unordered_set<std::string>>();
+    wakewords->insert(getWakeword(voiceAgentId, "alexa"));
+    wakewords->insert(getWakeword(voiceAgentId, "computer"));
+    dataManager.addNewVoiceAgent(
+        voiceAgentId,
+        "Alexa",
+        "Alexa voice assistant",
+        "alexa-voiceagent",
+        "Amazon.com",
+        getWakeword(voiceAgentId, "alexa"),
+        true,
+        wakewords);
+}
+
+void BM_VoiceAgentsDataManager_AddRemove(benchmark::State& state) {
+    auto dataManager = createDataManager();
+    for (int64_t idx = 0; idx < state.range(0); ++idx) {
+        addVoiceAgent(*dataManager, getVoiceAgentId(idx));
+    }
+
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        addVoiceAgent(*dataManager, "VA-BENCH");
+        dataManager->removeVoiceAgent("VA-BENCH");
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_VoiceAgentsDataManager_AddRemove)->Arg(1)->Arg(16);
+
+void BM_VoiceAgentsDataManager_ActivateDeactivate(benchmark::State& state) {
+    auto dataManager = createDataManager();
+    unordered_set<string> voiceAgentIds;
+    for (int64_t idx = 0; idx < state.range(0); ++idx) {
+        addVoiceAgent(*dataManager, getVoiceAgentId(idx));
+        voiceAgentIds.insert(getVoiceAgentId(idx));
+    }
+
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dataManager->deactivateVoiceAgents(voiceAgentIds));
+        benchmark::DoNotOptimize(dataManager->activateVoiceAgents(voiceAgentIds));
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_VoiceAgentsDataManager_ActivateDeactivate)->Arg(1)->Arg(16);
+
+void BM_VoiceAgentsDataManager_GetAllVoiceAgents(benchmark::State& state) {
+    auto dataManager = createDataManager();
+    for (int64_t idx = 0; idx < state.range(0); ++idx) {
+        addVoiceAgent(*dataManager, getVoiceAgentId(idx));
+    }
+
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dataManager->getAllVoiceAgents());
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_VoiceAgentsDataManager_GetAllVoiceAgents)->Arg(1)->Arg(16);
+
+void BM_VoiceAgentsDataManager_FindVoiceAgentByWakeword(benchmark::State& state) {
+    auto dataManager = createDataManager();
+    for (int64_t idx = 0; idx < state.range(0); ++idx) {
+        addVoiceAgent(*dataManager, getVoiceAgentId(idx));
+    }
+    std::string wakeword = "Computer " + getVoiceAgentId(state.range(0) - 1);
+
+    uint64_t allocations = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dataManager->findVoiceAgentByWakeword(wakeword));
+    }
+    reportAllocations(state, allocations);
+}
+BENCHMARK(BM_VoiceAgentsDataManager_FindVoiceAgentByWakeword)->Arg(1)->Arg(16)->Arg(256);
+
+}  // namespace
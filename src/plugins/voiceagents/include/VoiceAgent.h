@@ -15,7 +15,9 @@
 #ifndef VSHL_VOICEAGENTS_INCLUDE_VOICEAGENT_H_
 #define VSHL_VOICEAGENTS_INCLUDE_VOICEAGENT_H_
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_set>
 
 #include "interfaces/utilities/logging/ILogger.h"
@@ -27,6 +29,8 @@ namespace vshl {
 namespace voiceagents {
 /*
  * Default implementation of IVoiceAgent interface.
+ * The activation state and the active wakeword can be changed while other
+ * threads read them, everything else is fixed at creation.
  */
 class VoiceAgent : public vshl::common::interfaces::IVoiceAgent {
 public:
@@ -79,11 +83,14 @@ private:
   // Vendor
   string mVendor;
 
+  // Guards the active wakeword.
+  mutable mutex mActiveWakewordMutex;
+
   // Active wakeword
   string mActiveWakeword;
 
   // Active ??
-  bool mIsActive;
+  atomic<bool> mIsActive;
 
   // Wakewords
   shared_ptr<unordered_set<string>> mWakewords;
@@ -17,11 +17,14 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "interfaces/afb/IAFBApi.h"
 #include "interfaces/utilities/events/IEventFilter.h"
 #include "interfaces/utilities/logging/ILogger.h"
+#include "utilities/events/EventCoalescer.h"
+#include "utilities/timer/DeadlineTimer.h"
 #include "voiceagents/VoiceAgentEventNames.h"
 #include "voiceagents/include/VoiceAgent.h"
 
@@ -57,13 +60,21 @@ public:
         const string eventName,
         const shared_ptr<VoiceAgent> voiceAgent);
 
+    // False if nobody listens to the vshl event of the voiceagent, so that
+    // its payload need not be built.
+    bool hasSubscribers(const string& eventName, const string& voiceAgentId);
+
+    // Coalesces the payloads of a vshl event, for every voiceagent, according
+    // to the policy. Applies to the payloads received from then on.
+    bool setCoalescingPolicy(const string& eventName, const vshl::utilities::events::CoalescingPolicy& policy);
+
     ~VoiceAgentEventsHandler();
 
 protected:
     string getName() override;
 
     // IEventFilter override
-    bool onIncomingEvent(const string eventName, const string voiceAgentId, const string payload) override;
+    bool onIncomingEvent(const string& eventName, const string& voiceAgentId, json_object* payload) override;
 
 private:
     // Constructor
@@ -82,9 +93,22 @@ private:
     // Binding API reference
     shared_ptr<vshl::common::interfaces::IAFBApi> mAfbApi;
 
+    // Guards the events, the coalescing policies and the coalescers, which
+    // are used from verbs and from incoming events at the same time.
+    mutex mMutex;
+
     // A map of VSHL event ID to its Event object
     unordered_map<string, shared_ptr<common::interfaces::IAFBApi::IAFBEvent>> mEventsMap;
 
+    // Coalescing policies by VSHL event name.
+    unordered_map<string, vshl::utilities::events::CoalescingPolicy> mCoalescingPolicies;
+
+    // A map of VSHL event ID to the coalescer of its payloads, made on first use.
+    unordered_map<string, shared_ptr<vshl::utilities::events::EventCoalescer>> mCoalescers;
+
+    // Timer of the coalescing windows, made with the first policy.
+    shared_ptr<vshl::utilities::timer::DeadlineTimer> mCoalescingTimer;
+
     // Logger
     shared_ptr<vshl::common::interfaces::ILogger> mLogger;
 };
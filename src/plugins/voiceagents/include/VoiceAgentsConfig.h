@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#ifndef VSHL_VOICEAGENTS_INCLUDE_VOICEAGENTSCONFIG_H_
+#define VSHL_VOICEAGENTS_INCLUDE_VOICEAGENTSCONFIG_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <json-c/json.h>
+
+#include "interfaces/utilities/logging/ILogger.h"
+
+using namespace std;
+
+namespace vshl {
+namespace voiceagents {
+
+// Configuration of a voiceagent.
+struct VoiceAgentConfig {
+    string id;
+    string name;
+    string description;
+    string api;
+    string vendor;
+    string activeWakeword;
+    bool isActive = false;
+    vector<string> wakewords;
+};
+
+// Configuration of the voiceagents, as given to loadVoiceAgentsConfig.
+struct VoiceAgentsConfig {
+    vector<VoiceAgentConfig> agents;
+    string defaultVoiceAgentId;
+};
+
+/**
+ * Reads the voiceagents configuration out of @c configJ. Agents with missing
+ * or mistyped members are skipped with a warning. The default voiceagent is
+ * left empty if missing. Returns false if there is no agents array.
+ */
+bool parseVoiceAgentsConfig(
+    json_object* configJ,
+    VoiceAgentsConfig& config,
+    shared_ptr<vshl::common::interfaces::ILogger> logger);
+
+}  // namespace voiceagents
+}  // namespace vshl
+
+#endif  // VSHL_VOICEAGENTS_INCLUDE_VOICEAGENTSCONFIG_H_
@@ -19,6 +19,9 @@ static string VA_VERB_SUBSCRIBE = "subscribe";
 
 using Level = vshl::common::interfaces::ILogger::Level;
 using namespace vshl::common::interfaces;
+using namespace vshl::utilities::events;
+using namespace vshl::utilities::json;
+using namespace vshl::utilities::timer;
 
 namespace vshl {
 namespace voiceagents {
@@ -38,6 +41,7 @@ VoiceAgentEventsHandler::VoiceAgentEventsHandler(
 }
 
 VoiceAgentEventsHandler::~VoiceAgentEventsHandler() {
+    mCoalescers.clear();
     mEventsMap.clear();
 }
 
@@ -46,6 +50,7 @@ string VoiceAgentEventsHandler::getName() {
 }
 
 void VoiceAgentEventsHandler::createVshlEventsForVoiceAgent(const string voiceAgentId) {
+    lock_guard<mutex> lock(mMutex);
     // Update the events map with all the VSHL Events.
     for (auto eventName : VSHL_EVENTS) {
         string eventNameWithVAId = createEventNameWithVAId(eventName, voiceAgentId);
@@ -59,6 +64,7 @@ void VoiceAgentEventsHandler::createVshlEventsForVoiceAgent(const string voiceAg
 }
 
 void VoiceAgentEventsHandler::removeVshlEventsForVoiceAgent(const string voiceAgentId) {
+    lock_guard<mutex> lock(mMutex);
     // Update the events map with all the VSHL Events.
     for (auto eventName : VSHL_EVENTS) {
         string eventNameWithVAId = createEventNameWithVAId(eventName, voiceAgentId);
@@ -66,9 +72,36 @@ void VoiceAgentEventsHandler::removeVshlEventsForVoiceAgent(const string voiceAg
         if (it != mEventsMap.end()) {
             mEventsMap.erase(it);
         }
+        mCoalescers.erase(eventNameWithVAId);
     }
 }
 
+bool VoiceAgentEventsHandler::setCoalescingPolicy(const string& eventName, const CoalescingPolicy& policy) {
+    auto supportedEventsIt = find(VSHL_EVENTS.begin(), VSHL_EVENTS.end(), eventName);
+    if (supportedEventsIt == VSHL_EVENTS.end()) {
+        mLogger->log(Level::ERROR, TAG, "Event: " + eventName + " not a known event.");
+        return false;
+    }
+
+    lock_guard<mutex> lock(mMutex);
+    if (!mCoalescingTimer) {
+        mCoalescingTimer = DeadlineTimer::create();
+    }
+
+    mCoalescingPolicies[eventName] = policy;
+
+    // Coalescers made with the previous policy are remade on next use.
+    for (auto coalescerIt = mCoalescers.begin(); coalescerIt != mCoalescers.end();) {
+        if (coalescerIt->first.compare(0, eventName.size() + 1, eventName + "#") == 0) {
+            coalescerIt = mCoalescers.erase(coalescerIt);
+        } else {
+            ++coalescerIt;
+        }
+    }
+
+    return true;
+}
+
 bool VoiceAgentEventsHandler::subscribeToVshlEventFromVoiceAgent(
     vshl::common::interfaces::IAFBRequest& request,
     const string eventName,
@@ -83,12 +116,19 @@ bool VoiceAgentEventsHandler::subscribeToVshlEventFromVoiceAgent(
     // events map. If not then return false because the responsibility
     // of adding to the map lies in the hands of AddVoiceAgent method.
     string eventNameWithVAId = createEventNameWithVAId(eventName, voiceAgent->getId());
-    auto createdEventsIt = mEventsMap.find(eventNameWithVAId);
-    if (createdEventsIt == mEventsMap.end()) {
+    shared_ptr<IAFBApi::IAFBEvent> event;
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto createdEventsIt = mEventsMap.find(eventNameWithVAId);
+        if (createdEventsIt != mEventsMap.end()) {
+            event = createdEventsIt->second;
+        }
+    }
+    if (!event) {
         mLogger->log(Level::ERROR, TAG, "Not able to subscribe. Event doesn't exist, " + eventNameWithVAId);
         return false;
     }
-    createdEventsIt->second->subscribe(request);
+    event->subscribe(request);
 
     if (!callSubscribeVerb(voiceAgent)) {
         mLogger->log(Level::WARNING, TAG, "Failed to subscribe to voiceagent: " + voiceAgent->getId());
@@ -98,16 +138,69 @@ bool VoiceAgentEventsHandler::subscribeToVshlEventFromVoiceAgent(
 }
 
 // IEventFilter override.
-bool VoiceAgentEventsHandler::onIncomingEvent(const string eventName, const string voiceAgentId, const string payload) {
+bool VoiceAgentEventsHandler::onIncomingEvent(
+    const string& eventName,
+    const string& voiceAgentId,
+    json_object* payload) {
     string eventNameWithVAId = createEventNameWithVAId(eventName, voiceAgentId);
-    auto it = mEventsMap.find(eventNameWithVAId);
-    if (it != mEventsMap.end()) {
-        return it->second->publishEvent(json_object_new_string(payload.c_str()));
+    shared_ptr<IAFBApi::IAFBEvent> event;
+    shared_ptr<EventCoalescer> coalescer;
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto it = mEventsMap.find(eventNameWithVAId);
+        if (it == mEventsMap.end()) {
+            return true;
+        }
+        event = it->second;
+        if (!event->hasSubscribers()) {
+            // Nobody listens, neither a reference nor a coalescing window is taken.
+            return true;
+        }
+
+        auto policyIt = mCoalescingPolicies.find(eventName);
+        if (policyIt != mCoalescingPolicies.end()) {
+            auto coalescerIt = mCoalescers.find(eventNameWithVAId);
+            if (coalescerIt == mCoalescers.end()) {
+                // The windows end on a binder thread, which pushes the coalesced payloads.
+                EventCoalescer::Dispatch dispatch;
+                if (mAfbApi) {
+                    auto afbApi = mAfbApi;
+                    dispatch = [afbApi](function<void()> job) { afbApi->queueJob(std::move(job)); };
+                }
+                auto newCoalescer = EventCoalescer::create(
+                    mCoalescingTimer,
+                    policyIt->second,
+                    [event](JsonHandle payload) { event->publishEvent(std::move(payload)); },
+                    dispatch);
+                coalescerIt = mCoalescers.insert(make_pair(eventNameWithVAId, newCoalescer)).first;
+            }
+            coalescer = coalescerIt->second;
+        }
+    }
+
+    if (!coalescer) {
+        // The binder delivers the event on its own threads, so it gets a copy, see IAFBApi.h.
+        return event->publishEvent(JsonHandle::copy(payload));
     }
+    coalescer->onEvent(payload);
 
     return true;
 }
 
+bool VoiceAgentEventsHandler::hasSubscribers(const string& eventName, const string& voiceAgentId) {
+    shared_ptr<IAFBApi::IAFBEvent> event;
+    {
+        lock_guard<mutex> lock(mMutex);
+        auto it = mEventsMap.find(createEventNameWithVAId(eventName, voiceAgentId));
+        if (it == mEventsMap.end()) {
+            return false;
+        }
+        event = it->second;
+    }
+
+    return event->hasSubscribers();
+}
+
 string VoiceAgentEventsHandler::createEventNameWithVAId(string eventName, string voiceAgentId) {
     return eventName + "#" + voiceAgentId;
 }
@@ -124,14 +217,17 @@ bool VoiceAgentEventsHandler::callSubscribeVerb(const shared_ptr<VoiceAgent> voi
         return false;
     }
 
-    // TODO(Naveen): Move to utilities.
-    json_object* object = NULL;
-    std::string error, info;
-    int rc = mAfbApi->callSync(voiceAgent->getApi(), VA_VERB_SUBSCRIBE, NULL, &object, error, info);
-
-    if (object) {
-        free(object);
-    }
+    auto logger = mLogger;
+    string voiceAgentId = voiceAgent->getId();
+    mAfbApi->callAsync(
+        voiceAgent->getApi(),
+        VA_VERB_SUBSCRIBE,
+        JsonHandle(),
+        [logger, voiceAgentId](int rc, json_object* result, const string& error, const string& info) {
+            if (rc != 0) {
+                logger->log(Level::WARNING, TAG, "Failed to subscribe to voiceagent: " + voiceAgentId + ", " + error);
+            }
+        });
 
     return true;
 }
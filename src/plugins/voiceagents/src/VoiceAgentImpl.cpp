@@ -78,6 +78,7 @@ VoiceAgent::~VoiceAgent() {
 // Set the active wakeword for this voiceagent
 bool VoiceAgent::setActiveWakeWord(const string& wakeword) {
     if (mWakewords->find(wakeword) != mWakewords->end()) {
+        lock_guard<mutex> lock(mActiveWakewordMutex);
         mActiveWakeword = wakeword;
         return true;
     }
@@ -120,6 +121,7 @@ bool VoiceAgent::isActive() const {
 }
 
 string VoiceAgent::getActiveWakeword() const {
+    lock_guard<mutex> lock(mActiveWakewordMutex);
     return mActiveWakeword;
 }
 }  // namespace voiceagents
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include "voiceagents/include/VoiceAgentsConfig.h"
+
+#include <list>
+
+#include "utilities/json/JsonHelpers.h"
+
+static string TAG = "vshl::voiceagents::VoiceAgentsConfig";
+
+static string VA_JSON_ATTR_DEFAULT = "default";
+static string VA_JSON_ATTR_AGENTS = "agents";
+static string VA_JSON_ATTR_ID = "id";
+static string VA_JSON_ATTR_NAME = "name";
+static string VA_JSON_ATTR_API = "api";
+static string VA_JSON_ATTR_ACTIVE = "active";
+static string VA_JSON_ATTR_WWS = "wakewords";
+static string VA_JSON_ATTR_ACTIVE_WW = "activewakeword";
+static string VA_JSON_ATTR_DESCRIPTION = "description";
+static string VA_JSON_ATTR_VENDOR = "vendor";
+
+using Level = vshl::common::interfaces::ILogger::Level;
+using namespace vshl::utilities::json;
+
+namespace vshl {
+namespace voiceagents {
+
+bool parseVoiceAgentsConfig(
+    json_object* configJ,
+    VoiceAgentsConfig& config,
+    shared_ptr<vshl::common::interfaces::ILogger> logger) {
+    json_object* agentsJson = getMember(configJ, VA_JSON_ATTR_AGENTS, json_type_array);
+    if (agentsJson == nullptr) {
+        logger->log(Level::ERROR, TAG, "No agents object found in agents json");
+        return false;
+    }
+
+    VoiceAgentsConfig result;
+    size_t agentsCount = json_object_array_length(agentsJson);
+    for (size_t agentIdx = 0; agentIdx < agentsCount; ++agentIdx) {
+        json_object* agentJson = json_object_array_get_idx(agentsJson, agentIdx);
+
+        VoiceAgentConfig agent;
+        list<string> wakewords;
+        if (!getString(agentJson, VA_JSON_ATTR_ID, agent.id) ||
+            !getBool(agentJson, VA_JSON_ATTR_ACTIVE, agent.isActive) ||
+            !getString(agentJson, VA_JSON_ATTR_NAME, agent.name) ||
+            !getString(agentJson, VA_JSON_ATTR_API, agent.api) ||
+            !getStringList(agentJson, VA_JSON_ATTR_WWS, wakewords) ||
+            !getString(agentJson, VA_JSON_ATTR_ACTIVE_WW, agent.activeWakeword) ||
+            !getString(agentJson, VA_JSON_ATTR_DESCRIPTION, agent.description) ||
+            !getString(agentJson, VA_JSON_ATTR_VENDOR, agent.vendor)) {
+            logger->log(
+                Level::WARNING,
+                TAG,
+                string("One or more missing params in agent config ") + json_object_to_json_string(agentJson));
+            continue;
+        }
+
+        agent.wakewords.assign(wakewords.begin(), wakewords.end());
+        result.agents.push_back(std::move(agent));
+    }
+
+    getString(configJ, VA_JSON_ATTR_DEFAULT, result.defaultVoiceAgentId);
+
+    config = std::move(result);
+    return true;
+}
+
+}  // namespace voiceagents
+}  // namespace vshl
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include "voiceagents/include/VoiceAgentsConfig.h"
+
+#include "test/common/ConsoleLogger.h"
+
+using namespace vshl::voiceagents;
+using namespace vshl::test::common;
+
+namespace vshl {
+namespace test {
+
+static std::string CONFIG_JSON =
+    "{\"default\": \"VA-001\", \"agents\": ["
+    "{\"id\": \"VA-001\", \"active\": true, \"name\": \"Alexa\", \"api\": \"alexa-voiceagent\","
+    " \"wakewords\": [\"alexa\", \"computer\"], \"activewakeword\": \"alexa\","
+    " \"description\": \"Alexa voice assistant by Amazon.\", \"vendor\": \"Amazon.com Services Inc\"},"
+    "{\"id\": \"VA-002\", \"active\": false, \"name\": \"Nuance\", \"api\": \"nuance-voiceagent\","
+    " \"wakewords\": [\"hey nuance\"], \"activewakeword\": \"hey nuance\","
+    " \"description\": \"Nuance voice assistant.\", \"vendor\": \"Nuance\"},"
+    "{\"id\": \"VA-003\", \"name\": \"Incomplete\"}"
+    "]}";
+
+class VoiceAgentsConfigTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mConsoleLogger = std::make_shared<ConsoleLogger>();
+        mConfigJson = json_tokener_parse(CONFIG_JSON.c_str());
+    }
+
+    void TearDown() override {
+        json_object_put(mConfigJson);
+    }
+
+    std::shared_ptr<ConsoleLogger> mConsoleLogger;
+    json_object* mConfigJson;
+};
+
+TEST_F(VoiceAgentsConfigTest, parsesValidVoiceAgentsAndSkipsInvalidOnes) {
+    VoiceAgentsConfig config;
+    ASSERT_TRUE(parseVoiceAgentsConfig(mConfigJson, config, mConsoleLogger));
+
+    ASSERT_EQ(config.defaultVoiceAgentId, "VA-001");
+    ASSERT_EQ(config.agents.size(), 2);
+    ASSERT_EQ(config.agents[0].id, "VA-001");
+    ASSERT_EQ(config.agents[0].name, "Alexa");
+    ASSERT_EQ(config.agents[0].api, "alexa-voiceagent");
+    ASSERT_EQ(config.agents[0].activeWakeword, "alexa");
+    ASSERT_TRUE(config.agents[0].isActive);
+    ASSERT_EQ(config.agents[0].wakewords, std::vector<std::string>({"alexa", "computer"}));
+    ASSERT_EQ(config.agents[1].id, "VA-002");
+    ASSERT_FALSE(config.agents[1].isActive);
+}
+
+TEST_F(VoiceAgentsConfigTest, failsParsingWithoutAgents) {
+    json_object* configJson = json_tokener_parse("{\"default\": \"VA-001\"}");
+    VoiceAgentsConfig config;
+    ASSERT_FALSE(parseVoiceAgentsConfig(configJson, config, mConsoleLogger));
+    json_object_put(configJson);
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2018-2019 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "voiceagents/VoiceAgentsDataManager.h"
+
+#include "bench/fakes/FakeAFBApi.h"
+#include "test/common/ConsoleLogger.h"
+#include "voiceagents/test/VoiceAgentsTestData.h"
+
+using namespace vshl::bench::fakes;
+using namespace vshl::common::interfaces;
+using namespace vshl::voiceagents;
+using namespace vshl::test::common;
+
+namespace vshl {
+namespace test {
+
+static const int READER_COUNT = 4;
+static const int WRITER_ROUNDS = 2000;
+
+// Voiceagent added and removed by the writer while the readers run.
+static std::string TRANSIENT_VA_ID = "VA-003";
+
+/*
+ * Observer that checks that the notifications arrive in the order of the
+ * snapshots they describe.
+ */
+class GenerationObserver : public IVoiceAgentsChangeObserver {
+public:
+    GenerationObserver(VoiceAgentsDataManager& dataManager) :
+            mDataManager(dataManager), mLastGeneration(0), mOutOfOrder(0), mNotifications(0) {
+    }
+
+    void OnDefaultVoiceAgentChanged(shared_ptr<IVoiceAgent> defaultVoiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentAdded(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentRemoved(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentActiveWakeWordChanged(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentActivated(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentDeactivated(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    void OnVoiceAgentUpdated(shared_ptr<IVoiceAgent> voiceAgent) override {
+        onNotification();
+    }
+
+    uint64_t getOutOfOrder() const {
+        return mOutOfOrder;
+    }
+
+    uint64_t getNotifications() const {
+        return mNotifications;
+    }
+
+private:
+    void onNotification() {
+        uint64_t generation = mDataManager.getGeneration();
+        if (generation <= mLastGeneration) {
+            ++mOutOfOrder;
+        }
+        mLastGeneration = generation;
+        ++mNotifications;
+    }
+
+    VoiceAgentsDataManager& mDataManager;
+    uint64_t mLastGeneration;
+    std::atomic<uint64_t> mOutOfOrder;
+    std::atomic<uint64_t> mNotifications;
+};
+
+class VoiceAgentsDataManagerStressTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mDataManager = VoiceAgentsDataManager::create(std::make_shared<ConsoleLogger>(), std::make_shared<FakeAFBApi>());
+        mVoiceAgentsData = getVoiceAgentsTestData();
+    }
+
+    bool addVoiceAgent(const VoiceAgentTestData& data) {
+        return mDataManager->addNewVoiceAgent(
+            data.id, data.name, data.description, data.api, data.vendor, data.activeWakeword, data.isActive,
+            data.wakewords);
+    }
+
+    std::unique_ptr<VoiceAgentsDataManager> mDataManager;
+    std::vector<VoiceAgentTestData> mVoiceAgentsData;
+};
+
+TEST_F(VoiceAgentsDataManagerStressTest, readersSeeConsistentSnapshotsWhileWriterUpdates) {
+    auto observer = std::make_shared<GenerationObserver>(*mDataManager);
+    mDataManager->addVoiceAgentsChangeObserver(observer);
+
+    ASSERT_TRUE(addVoiceAgent(mVoiceAgentsData[0]));
+    ASSERT_TRUE(addVoiceAgent(mVoiceAgentsData[1]));
+    ASSERT_TRUE(mDataManager->setDefaultVoiceAgent(mVoiceAgentsData[0].id));
+
+    VoiceAgentTestData transient = mVoiceAgentsData[1];
+    transient.id = TRANSIENT_VA_ID;
+    transient.activeWakeword = "Marvin";
+    transient.wakewords = std::make_shared<std::unordered_set<std::string>>();
+    transient.wakewords->insert("Marvin");
+
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> inconsistencies(0);
+    std::atomic<uint64_t> failedSubscriptions(0);
+    std::vector<std::thread> readers;
+    for (int idx = 0; idx < READER_COUNT; ++idx) {
+        readers.emplace_back([&]() {
+            FakeAFBRequest request;
+            uint64_t lastGeneration = 0;
+            while (!done) {
+                auto snapshot = mDataManager->getSnapshot();
+                if (snapshot->generation < lastGeneration) {
+                    ++inconsistencies;
+                }
+                lastGeneration = snapshot->generation;
+
+                size_t agentCount = snapshot->voiceAgents.size();
+                if (agentCount < 2 || agentCount > 3 ||
+                    snapshot->voiceAgents.find(snapshot->defaultVoiceAgentId) == snapshot->voiceAgents.end()) {
+                    ++inconsistencies;
+                }
+
+                size_t wakewordCount = 0;
+                for (auto& element : snapshot->voiceAgents) {
+                    auto wakewords = element.second->getWakeWords();
+                    if (wakewords->find(element.second->getActiveWakeword()) == wakewords->end()) {
+                        ++inconsistencies;
+                    }
+                    for (auto& wakeword : *wakewords) {
+                        auto ownerIt = snapshot->wakewordIndex.find(VoiceAgentsDataManager::foldWakeword(wakeword));
+                        if (ownerIt == snapshot->wakewordIndex.end() || ownerIt->second != element.first) {
+                            ++inconsistencies;
+                        }
+                    }
+                    wakewordCount += wakewords->size();
+                }
+                if (snapshot->wakewordIndex.size() != wakewordCount) {
+                    ++inconsistencies;
+                }
+
+                if (!mDataManager->subscribeToVshlEventFromVoiceAgent(
+                        request, VSHL_EVENT_DIALOG_STATE_EVENT, mVoiceAgentsData[0].id)) {
+                    ++failedSubscriptions;
+                }
+            }
+        });
+    }
+
+    std::string firstId = mVoiceAgentsData[0].id;
+    std::string secondId = mVoiceAgentsData[1].id;
+    for (int round = 0; round < WRITER_ROUNDS; ++round) {
+        ASSERT_TRUE(mDataManager->setDefaultVoiceAgent(round % 2 == 0 ? secondId : firstId));
+        ASSERT_EQ(mDataManager->deactivateVoiceAgents({firstId}), 1);
+        ASSERT_EQ(mDataManager->activateVoiceAgents({firstId}), 1);
+        ASSERT_TRUE(mDataManager->setActiveWakeWord(firstId, round % 2 == 0 ? "Cleon I " : "Hari Seldon"));
+        ASSERT_TRUE(addVoiceAgent(transient));
+        ASSERT_TRUE(mDataManager->removeVoiceAgent(TRANSIENT_VA_ID));
+    }
+
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    // Three agents added and one default set up front, six changes per round.
+    uint64_t expectedChanges = 3 + 6 * WRITER_ROUNDS;
+    ASSERT_EQ(mDataManager->getGeneration(), expectedChanges);
+    ASSERT_EQ(observer->getNotifications(), expectedChanges);
+    ASSERT_EQ(observer->getOutOfOrder(), 0);
+    ASSERT_EQ(inconsistencies, 0);
+    ASSERT_EQ(failedSubscriptions, 0);
+
+    mDataManager->removeVoiceAgentsChangeObserver(observer);
+}
+
+TEST_F(VoiceAgentsDataManagerStressTest, concurrentAddsOfTheSameVoiceAgentAddItOnce) {
+    std::atomic<int> added(0);
+    std::vector<std::thread> writers;
+    for (int idx = 0; idx < READER_COUNT; ++idx) {
+        writers.emplace_back([&]() {
+            for (auto& data : mVoiceAgentsData) {
+                if (addVoiceAgent(data)) {
+                    ++added;
+                }
+            }
+        });
+    }
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    ASSERT_EQ(added, mVoiceAgentsData.size());
+    ASSERT_EQ(mDataManager->getAllVoiceAgents().size(), mVoiceAgentsData.size());
+    ASSERT_EQ(mDataManager->getGeneration(), mVoiceAgentsData.size());
+}
+
+}  // namespace test
+}  // namespace vshl
@@ -19,6 +19,7 @@
 
 #include "test/common/ConsoleLogger.h"
 #include "test/mocks/AFBApiMock.h"
+#include "test/mocks/AFBEventMock.h"
 #include "test/mocks/VoiceAgentsChangeObserverMock.h"
 #include "voiceagents/test/VoiceAgentsTestData.h"
 
@@ -64,6 +65,24 @@ protected:
            *lhs.wakewords == *rhs.getWakeWords();
   }
 
+  static VoiceAgentConfig toConfig(const VoiceAgentTestData &data) {
+    VoiceAgentConfig config;
+    config.id = data.id;
+    config.name = data.name;
+    config.description = data.description;
+    config.api = data.api;
+    config.vendor = data.vendor;
+    config.activeWakeword = data.activeWakeword;
+    config.isActive = data.isActive;
+    config.wakewords.assign(data.wakewords->begin(), data.wakewords->end());
+    return config;
+  }
+
+  static ::testing::Matcher<std::shared_ptr<IVoiceAgent>>
+  hasId(const std::string &vaId) {
+    return ::testing::Pointee(::testing::Property(&IVoiceAgent::getId, vaId));
+  }
+
   static std::shared_ptr<IVoiceAgent>
   findVoiceAgent(std::set<std::shared_ptr<IVoiceAgent>> &voiceAgents,
                  std::string &vaId) {
@@ -290,5 +309,355 @@ TEST_F(VoiceAgentDataManagerTest, DefaultAgentCanBeSet) {
   ASSERT_EQ(mVADataManager->getDefaultVoiceAgent(), vaId2);
 }
 
+TEST_F(VoiceAgentDataManagerTest, GenerationIsBumpedOnlyOnChanges) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAgentsChangeObserver, OnDefaultVoiceAgentChanged(::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentDeactivated(::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentActivated(::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentActiveWakeWordChanged(::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentRemoved(::testing::_))
+      .Times(1);
+
+  uint64_t generation = mVADataManager->getGeneration();
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+  ASSERT_EQ(mVADataManager->getGeneration(), generation + 2);
+  generation = mVADataManager->getGeneration();
+
+  // Failed or no-op operations must not change the generation.
+  ASSERT_FALSE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_FALSE(mVADataManager->removeVoiceAgent("non-existent"));
+  ASSERT_FALSE(mVADataManager->setDefaultVoiceAgent("non-existent"));
+  mVADataManager->activateVoiceAgents({mVoiceAgentsData[0].id});
+  ASSERT_EQ(mVADataManager->getGeneration(), generation);
+
+  std::string vaId = mVoiceAgentsData[0].id;
+  ASSERT_TRUE(mVADataManager->setDefaultVoiceAgent(vaId));
+  ASSERT_TRUE(mVADataManager->setDefaultVoiceAgent(vaId));
+  ASSERT_EQ(mVADataManager->getGeneration(), ++generation);
+
+  mVADataManager->deactivateVoiceAgents({vaId});
+  ASSERT_EQ(mVADataManager->getGeneration(), ++generation);
+
+  mVADataManager->activateVoiceAgents({vaId});
+  ASSERT_EQ(mVADataManager->getGeneration(), ++generation);
+
+  ASSERT_TRUE(mVADataManager->setActiveWakeWord(vaId, "Cleon I "));
+  ASSERT_TRUE(mVADataManager->setActiveWakeWord(vaId, "Cleon I "));
+  ASSERT_EQ(mVADataManager->getGeneration(), ++generation);
+
+  ASSERT_TRUE(mVADataManager->removeVoiceAgent(mVoiceAgentsData[1].id));
+  ASSERT_EQ(mVADataManager->getGeneration(), ++generation);
+}
+
+TEST_F(VoiceAgentDataManagerTest, IncomingEventsAreForwardedAsCopies) {
+  std::shared_ptr<AFBEventMock> mockEvent(
+      new ::testing::NiceMock<AFBEventMock>());
+  ON_CALL(*mAfbApi, createEvent(::testing::_))
+      .WillByDefault(::testing::Return(mockEvent));
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(1);
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+
+  json_object *payload = json_tokener_parse(
+      "{\"va_id\":\"VA-001\",\"state\":\"LISTENING\"}");
+
+  // The binder gets a copy it owns, never a reference on the caller's object.
+  EXPECT_CALL(*mockEvent, publishEvent(::testing::_))
+      .WillOnce(::testing::Invoke([payload](json_object *object) {
+        EXPECT_NE(object, payload);
+        EXPECT_STREQ(json_object_to_json_string(object),
+                     json_object_to_json_string(payload));
+        EXPECT_EQ(json_object_put(object), 1);
+        return 1;
+      }));
+
+  ASSERT_TRUE(mVADataManager->getEventFilter()->onIncomingEvent(
+      "voice_dialogstate_event", mVoiceAgentsData[0].id, payload));
+
+  // The caller still holds the only reference on its object.
+  ASSERT_EQ(json_object_put(payload), 1);
+}
+
+TEST_F(VoiceAgentDataManagerTest, IncomingEventsNobodyListensToAreDropped) {
+  std::shared_ptr<AFBEventMock> mockEvent(
+      new ::testing::StrictMock<AFBEventMock>());
+  mockEvent->setHasSubscribers(false);
+  ON_CALL(*mAfbApi, createEvent(::testing::_))
+      .WillByDefault(::testing::Return(mockEvent));
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(1);
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+
+  ASSERT_FALSE(mVADataManager->hasVshlEventSubscribers(
+      "voice_dialogstate_event", mVoiceAgentsData[0].id));
+  ASSERT_FALSE(mVADataManager->hasVshlEventSubscribers(
+      "voice_dialogstate_event", "unknown-voiceagent"));
+
+  json_object *payload = json_tokener_parse(
+      "{\"va_id\":\"VA-001\",\"state\":\"LISTENING\"}");
+
+  // Nothing is published and no reference is taken on the payload.
+  EXPECT_CALL(*mockEvent, publishEvent(::testing::_)).Times(0);
+  ASSERT_TRUE(mVADataManager->getEventFilter()->onIncomingEvent(
+      "voice_dialogstate_event", mVoiceAgentsData[0].id, payload));
+  ASSERT_EQ(json_object_put(payload), 1);
+}
+
+TEST_F(VoiceAgentDataManagerTest,
+       SubscriptionProcessCallsVoiceAgentsAtOnceAndRetriesFailures) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+
+  std::string vaId1 = mVoiceAgentsData[0].id;
+  std::string vaId2 = mVoiceAgentsData[1].id;
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId1),
+            VoiceAgentsDataManager::SubscriptionState::NOT_STARTED);
+
+  // Both voiceagents are called before any of them answered.
+  IAFBApi::CallCompletion completion1, completion2;
+  EXPECT_CALL(*mAfbApi, callAsync(mVoiceAgentsData[0].api,
+                                  "startSubscriptionProcess", ::testing::_,
+                                  ::testing::_, ::testing::_))
+      .WillOnce(::testing::SaveArg<4>(&completion1));
+  EXPECT_CALL(*mAfbApi, callAsync(mVoiceAgentsData[1].api,
+                                  "startSubscriptionProcess", ::testing::_,
+                                  ::testing::_, ::testing::_))
+      .Times(2)
+      .WillRepeatedly(::testing::SaveArg<4>(&completion2));
+
+  mVADataManager->startNewSubscriptionProcess();
+  ASSERT_TRUE(completion1 && completion2);
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId1),
+            VoiceAgentsDataManager::SubscriptionState::PENDING);
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId2),
+            VoiceAgentsDataManager::SubscriptionState::PENDING);
+
+  // Pending processes are not started again.
+  mVADataManager->startNewSubscriptionProcess();
+
+  completion1(0, nullptr, "", "");
+  completion2(-1, nullptr, "unavailable", "");
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId1),
+            VoiceAgentsDataManager::SubscriptionState::COMPLETED);
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId2),
+            VoiceAgentsDataManager::SubscriptionState::FAILED);
+
+  // Only the failed voiceagent is called again.
+  mVADataManager->startNewSubscriptionProcess();
+  ASSERT_EQ(mVADataManager->getSubscriptionState(vaId2),
+            VoiceAgentsDataManager::SubscriptionState::PENDING);
+}
+
+TEST_F(VoiceAgentDataManagerTest,
+       VoiceAgentsAddedLaterStartTheirSubscriptionProcessRightAway) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAfbApi, callAsync(::testing::_, "startSubscriptionProcess",
+                                  ::testing::_, ::testing::_, ::testing::_))
+      .Times(2);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  mVADataManager->startNewSubscriptionProcess();
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+
+  ASSERT_EQ(mVADataManager->getSubscriptionState(mVoiceAgentsData[1].id),
+            VoiceAgentsDataManager::SubscriptionState::PENDING);
+}
+
+TEST_F(VoiceAgentDataManagerTest, FindsVoiceAgentByCaseFoldedWakeword) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentRemoved(::testing::_))
+      .Times(1);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+
+  auto voiceAgent = mVADataManager->findVoiceAgentByWakeword("  hari   SELDON ");
+  ASSERT_NE(voiceAgent, nullptr);
+  ASSERT_EQ(voiceAgent->getId(), mVoiceAgentsData[0].id);
+
+  voiceAgent = mVADataManager->findVoiceAgentByWakeword("ford prefect");
+  ASSERT_NE(voiceAgent, nullptr);
+  ASSERT_EQ(voiceAgent->getId(), mVoiceAgentsData[1].id);
+
+  ASSERT_EQ(mVADataManager->findVoiceAgentByWakeword("Marvin"), nullptr);
+
+  ASSERT_TRUE(mVADataManager->removeVoiceAgent(mVoiceAgentsData[1].id));
+  ASSERT_EQ(mVADataManager->findVoiceAgentByWakeword("Ford Prefect"), nullptr);
+  ASSERT_NE(mVADataManager->findVoiceAgentByWakeword("Eto Demerzel"), nullptr);
+}
+
+TEST_F(VoiceAgentDataManagerTest, RejectsVoiceAgentWithWakewordOfAnotherOne) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(1);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  uint64_t generation = mVADataManager->getGeneration();
+
+  VoiceAgentTestData colliding = mVoiceAgentsData[1];
+  colliding.wakewords = std::make_shared<std::unordered_set<std::string>>(
+      std::unordered_set<std::string>{"Ford Prefect", "HARI SELDON"});
+  ASSERT_FALSE(addVoiceAgent(*mVADataManager, colliding));
+
+  ASSERT_EQ(mVADataManager->getAllVoiceAgents().size(), 1);
+  ASSERT_EQ(mVADataManager->getGeneration(), generation);
+  ASSERT_EQ(mVADataManager->findVoiceAgentByWakeword("Ford Prefect"), nullptr);
+}
+
+TEST_F(VoiceAgentDataManagerTest, ActiveWakewordMustBelongToTheVoiceAgent) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentActiveWakeWordChanged(::testing::_))
+      .Times(1);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+
+  std::string vaId = mVoiceAgentsData[0].id;
+  auto allVA = mVADataManager->getAllVoiceAgents();
+  auto voiceAgent = findVoiceAgent(allVA, vaId);
+
+  // The voiceagent keeps the spelling of its configuration.
+  ASSERT_TRUE(mVADataManager->setActiveWakeWord(vaId, "cleon i"));
+  ASSERT_EQ(voiceAgent->getActiveWakeword(), "Cleon I ");
+
+  ASSERT_FALSE(mVADataManager->setActiveWakeWord(vaId, "Ford Prefect"));
+  ASSERT_FALSE(mVADataManager->setActiveWakeWord(vaId, "Marvin"));
+  ASSERT_EQ(voiceAgent->getActiveWakeword(), "Cleon I ");
+}
+
+TEST_F(VoiceAgentDataManagerTest, ReloadAppliesOnlyTheChanges) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAgentsChangeObserver, OnDefaultVoiceAgentChanged(::testing::_))
+      .Times(1);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+  ASSERT_TRUE(mVADataManager->setDefaultVoiceAgent(mVoiceAgentsData[0].id));
+  uint64_t generation = mVADataManager->getGeneration();
+  auto kept =
+      mVADataManager->getSnapshot()->voiceAgents.at(mVoiceAgentsData[0].id);
+
+  VoiceAgentTestData added = mVoiceAgentsData[1];
+  added.id = "VA-003";
+  added.activeWakeword = "Marvin";
+  added.wakewords = std::make_shared<std::unordered_set<std::string>>(
+      std::unordered_set<std::string>{"Marvin", "Ford Prefect"});
+
+  VoiceAgentsConfig config;
+  config.agents.push_back(toConfig(mVoiceAgentsData[0]));
+  config.agents[0].activeWakeword = "Eto Demerzel";
+  config.agents[0].isActive = false;
+  config.agents.push_back(toConfig(added));
+  config.defaultVoiceAgentId = added.id;
+
+  // The events of the kept voiceagent are not created again.
+  EXPECT_CALL(*mAfbApi, createEvent(::testing::EndsWith("#" + kept->getId())))
+      .Times(0);
+  EXPECT_CALL(*mAfbApi, createEvent(::testing::EndsWith("#" + added.id)))
+      .Times(::testing::AtLeast(1));
+
+  ::testing::InSequence sequence;
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentRemoved(hasId(mVoiceAgentsData[1].id)));
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(hasId(added.id)));
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentActiveWakeWordChanged(::testing::Eq(kept)));
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentDeactivated(::testing::Eq(kept)));
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnDefaultVoiceAgentChanged(hasId(added.id)));
+
+  ASSERT_TRUE(mVADataManager->reloadVoiceAgents(config));
+
+  auto snapshot = mVADataManager->getSnapshot();
+  ASSERT_EQ(snapshot->generation, generation + 1);
+  ASSERT_EQ(snapshot->voiceAgents.size(), 2);
+  ASSERT_EQ(snapshot->voiceAgents.at(kept->getId()), kept);
+  ASSERT_EQ(kept->getActiveWakeword(), "Eto Demerzel");
+  ASSERT_FALSE(kept->isActive());
+  ASSERT_EQ(snapshot->defaultVoiceAgentId, added.id);
+  ASSERT_EQ(mVADataManager->findVoiceAgentByWakeword("Ford Prefect")->getId(),
+            added.id);
+
+  // Reloading the same configuration changes nothing.
+  ASSERT_TRUE(mVADataManager->reloadVoiceAgents(config));
+  ASSERT_EQ(mVADataManager->getGeneration(), generation + 1);
+}
+
+TEST_F(VoiceAgentDataManagerTest, ReloadReplacesVoiceAgentsWithNewFields) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+  EXPECT_CALL(*mAgentsChangeObserver, OnDefaultVoiceAgentChanged(::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAfbApi, callAsync(::testing::_, "startSubscriptionProcess",
+                                  ::testing::_, ::testing::_, ::testing::_))
+      .Times(2);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+  ASSERT_TRUE(mVADataManager->setDefaultVoiceAgent(mVoiceAgentsData[0].id));
+  mVADataManager->startNewSubscriptionProcess();
+  auto unchanged =
+      mVADataManager->getSnapshot()->voiceAgents.at(mVoiceAgentsData[1].id);
+
+  VoiceAgentsConfig config;
+  config.agents.push_back(toConfig(mVoiceAgentsData[0]));
+  config.agents[0].api = "api-1-v2";
+  config.agents.push_back(toConfig(mVoiceAgentsData[1]));
+  config.defaultVoiceAgentId = mVoiceAgentsData[0].id;
+
+  // The replaced voiceagent goes through the subscription process again.
+  EXPECT_CALL(*mAfbApi, callAsync("api-1-v2", "startSubscriptionProcess",
+                                  ::testing::_, ::testing::_, ::testing::_))
+      .Times(1);
+  EXPECT_CALL(*mAfbApi, createEvent(::testing::_)).Times(0);
+  EXPECT_CALL(*mAgentsChangeObserver,
+              OnVoiceAgentUpdated(::testing::Pointee(
+                  ::testing::Property(&IVoiceAgent::getApi, "api-1-v2"))))
+      .Times(1);
+
+  ASSERT_TRUE(mVADataManager->reloadVoiceAgents(config));
+
+  auto snapshot = mVADataManager->getSnapshot();
+  ASSERT_EQ(snapshot->voiceAgents.at(mVoiceAgentsData[0].id)->getApi(),
+            "api-1-v2");
+  ASSERT_EQ(snapshot->voiceAgents.at(mVoiceAgentsData[1].id), unchanged);
+  ASSERT_EQ(snapshot->defaultVoiceAgentId, mVoiceAgentsData[0].id);
+  ASSERT_EQ(mVADataManager->getSubscriptionState(mVoiceAgentsData[0].id),
+            VoiceAgentsDataManager::SubscriptionState::PENDING);
+}
+
+TEST_F(VoiceAgentDataManagerTest, InvalidReloadChangesNothing) {
+  EXPECT_CALL(*mAgentsChangeObserver, OnVoiceAgentAdded(::testing::_)).Times(2);
+
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[0]));
+  ASSERT_TRUE(addVoiceAgent(*mVADataManager, mVoiceAgentsData[1]));
+  uint64_t generation = mVADataManager->getGeneration();
+
+  // The default voiceagent must be one of the configuration.
+  VoiceAgentsConfig config;
+  config.agents.push_back(toConfig(mVoiceAgentsData[0]));
+  config.defaultVoiceAgentId = mVoiceAgentsData[1].id;
+  ASSERT_FALSE(mVADataManager->reloadVoiceAgents(config));
+
+  // A wakeword must lead to a single voiceagent.
+  config.agents.push_back(toConfig(mVoiceAgentsData[1]));
+  config.agents[1].wakewords.push_back("cleon i");
+  ASSERT_FALSE(mVADataManager->reloadVoiceAgents(config));
+
+  // Ids must be unique.
+  config.agents[1] = toConfig(mVoiceAgentsData[0]);
+  config.defaultVoiceAgentId = mVoiceAgentsData[0].id;
+  ASSERT_FALSE(mVADataManager->reloadVoiceAgents(config));
+
+  ASSERT_EQ(mVADataManager->getGeneration(), generation);
+  ASSERT_EQ(mVADataManager->getAllVoiceAgents().size(), 2);
+}
+
 } // namespace test
 } // namespace vshl
\ No newline at end of file
@@ -121,8 +121,8 @@ int afbBindingEntry(afb_dynapi* apiHandle) {
 
     AFB_ApiNotice(apiHandle, "Controller API='%s' info='%s'", ctrlConfig->api, ctrlConfig->info);
 
-    // create one API per config file (Pre-V3 return code ToBeChanged)
-    int status = afb_dynapi_new_api(apiHandle, ctrlConfig->api, ctrlConfig->info, 1, ctrlLoadOneApi, ctrlConfig);
+    // create one API per config file (Pre-V3 return code ToBeChanged), its verbs may run concurrently
+    int status = afb_dynapi_new_api(apiHandle, ctrlConfig->api, ctrlConfig->info, 0, ctrlLoadOneApi, ctrlConfig);
 
     return status;
 }